@@ -0,0 +1,465 @@
+#include "AdjacencySet.h"
+#include <algorithm>
+#include <cstring>
+#include "SetIntersection.h"
+
+const int AdjacencySet::kInlineCapacity;
+const int AdjacencySet::kBitmapSize;
+const int AdjacencySet::kSortedSize;
+const int AdjacencySet::kContainerWords;
+const int AdjacencySet::kContainerArraySize;
+const int AdjacencySet::kContainerBitmapSize;
+
+
+/**
+ * @brief Release the storage of the set.
+ */
+AdjacencySet::~AdjacencySet() {
+    release();
+}
+
+
+/**
+ * @brief Take over the storage of another set, leaving it empty.
+ * @param other The set to move from.
+ */
+AdjacencySet::AdjacencySet(AdjacencySet&& other) noexcept : count(other.count), kind(other.kind) {
+    // The inline values span the whole union, so copying them copies any representation
+    std::memcpy(inline_values, other.inline_values, sizeof(inline_values));
+    other.count = 0;
+    other.kind = Representation::Inline;
+}
+
+
+/**
+ * @brief Take over the storage of another set, leaving it empty.
+ * @param other The set to move from.
+ * @return This set.
+ */
+AdjacencySet& AdjacencySet::operator=(AdjacencySet&& other) noexcept {
+    if (this != &other) {
+        release();
+        count = other.count;
+        kind = other.kind;
+        std::memcpy(inline_values, other.inline_values, sizeof(inline_values));
+        other.count = 0;
+        other.kind = Representation::Inline;
+    }
+    return *this;
+}
+
+
+/**
+ * @brief Check whether the set contains a value.
+ * @param value The value to look for.
+ * @return true if the value is in the set, false otherwise.
+ */
+bool AdjacencySet::contains(int value) const {
+    if (kind == Representation::Inline) {
+        for (int position = 0; position < count; position++) {
+            if (inline_values[position] == value) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if (kind == Representation::Sorted) {
+        return std::binary_search(heap.values, heap.values + count, value);
+    }
+    const Container* container = findContainer(value >> 16);
+    return container != nullptr && containerContains(*container, value & 0xFFFF);
+}
+
+
+/**
+ * @brief Add a value to the set.
+ * @param value The value to add.
+ * @return true if the value was added, false if it was already in the set.
+ */
+bool AdjacencySet::insert(int value) {
+    if (kind == Representation::Bitmap) {
+        const int key = value >> 16;
+        const std::uint16_t low = static_cast<std::uint16_t>(value & 0xFFFF);
+        std::vector<Container>& containers = hub->containers;
+        std::vector<Container>::iterator container = std::lower_bound(containers.begin(), containers.end(), key,
+            [](const Container& candidate, int target) { return candidate.key < target; });
+        if (container == containers.end() || container->key != key) {
+            container = containers.insert(container, Container());
+            container->key = key;
+            container->cardinality = 0;
+        }
+        if (!container->words.empty()) {
+            std::uint64_t& word = container->words[low >> 6];
+            const std::uint64_t bit = std::uint64_t(1) << (low & 63);
+            if (word & bit) {
+                return false;
+            }
+            word |= bit;
+        }
+        else {
+            std::vector<std::uint16_t>::iterator position = std::lower_bound(container->values.begin(), container->values.end(), low);
+            if (position != container->values.end() && *position == low) {
+                return false;
+            }
+            container->values.insert(position, low);
+            // A full array container takes more room than a bitmap
+            if (static_cast<int>(container->values.size()) > kContainerArraySize) {
+                container->words.assign(kContainerWords, 0);
+                for (std::uint16_t member : container->values) {
+                    container->words[member >> 6] |= std::uint64_t(1) << (member & 63);
+                }
+                std::vector<std::uint16_t>().swap(container->values);
+            }
+        }
+        container->cardinality++;
+        count++;
+        return true;
+    }
+
+    int* values = kind == Representation::Inline ? inline_values : heap.values;
+    const int position = static_cast<int>(std::lower_bound(values, values + count, value) - values);
+    if (position < count && values[position] == value) {
+        return false;
+    }
+
+    if (kind == Representation::Sorted && count + 1 >= kBitmapSize) {
+        // The set has become a hub
+        std::vector<int> merged(values, values + count);
+        merged.insert(merged.begin() + position, value);
+        assign(merged.data(), merged.size());
+        return true;
+    }
+
+    const int capacity = kind == Representation::Inline ? kInlineCapacity : heap.capacity;
+    if (count == capacity) {
+        // Grow into a larger array, leaving the inline storage if needed
+        const int grown = std::max(capacity * 2, 2 * kInlineCapacity);
+        int* larger = new int[grown];
+        std::copy(values, values + position, larger);
+        larger[position] = value;
+        std::copy(values + position, values + count, larger + position + 1);
+        if (kind == Representation::Sorted) {
+            delete[] heap.values;
+        }
+        kind = Representation::Sorted;
+        heap.values = larger;
+        heap.capacity = grown;
+    }
+    else {
+        std::copy_backward(values + position, values + count, values + count + 1);
+        values[position] = value;
+    }
+    count++;
+    return true;
+}
+
+
+/**
+ * @brief Remove a value from the set.
+ * @param value The value to remove.
+ * @return true if the value was removed, false if it was not in the set.
+ */
+bool AdjacencySet::erase(int value) {
+    if (kind == Representation::Bitmap) {
+        const int key = value >> 16;
+        const std::uint16_t low = static_cast<std::uint16_t>(value & 0xFFFF);
+        std::vector<Container>& containers = hub->containers;
+        std::vector<Container>::iterator container = std::lower_bound(containers.begin(), containers.end(), key,
+            [](const Container& candidate, int target) { return candidate.key < target; });
+        if (container == containers.end() || container->key != key) {
+            return false;
+        }
+        if (!container->words.empty()) {
+            std::uint64_t& word = container->words[low >> 6];
+            const std::uint64_t bit = std::uint64_t(1) << (low & 63);
+            if (!(word & bit)) {
+                return false;
+            }
+            word &= ~bit;
+            // A sparse bitmap container takes more room than an array
+            if (container->cardinality - 1 < kContainerBitmapSize) {
+                container->values.reserve(container->cardinality - 1);
+                for (int index = 0; index < kContainerWords; index++) {
+                    for (std::uint64_t bits = container->words[index]; bits != 0; bits &= bits - 1) {
+                        container->values.push_back(static_cast<std::uint16_t>((index << 6) | lowestBit(bits)));
+                    }
+                }
+                std::vector<std::uint64_t>().swap(container->words);
+            }
+        }
+        else {
+            std::vector<std::uint16_t>::iterator position = std::lower_bound(container->values.begin(), container->values.end(), low);
+            if (position == container->values.end() || *position != low) {
+                return false;
+            }
+            container->values.erase(position);
+        }
+        if (--container->cardinality == 0) {
+            containers.erase(container);
+        }
+        count--;
+
+        // The set is no longer a hub
+        if (count < kSortedSize) {
+            std::vector<int> remaining;
+            remaining.reserve(count);
+            forEach([&remaining](int member) { remaining.push_back(member); });
+            assign(remaining.data(), remaining.size());
+        }
+        return true;
+    }
+
+    int* values = kind == Representation::Inline ? inline_values : heap.values;
+    int* position = std::lower_bound(values, values + count, value);
+    if (position == values + count || *position != value) {
+        return false;
+    }
+    std::copy(position + 1, values + count, position);
+    count--;
+
+    // Move back inline, or into a smaller array, once most of the array is unused
+    if (kind == Representation::Sorted && count <= kInlineCapacity / 2) {
+        int* old = heap.values;
+        std::copy(old, old + count, inline_values);
+        delete[] old;
+        kind = Representation::Inline;
+    }
+    else if (kind == Representation::Sorted && heap.capacity > 4 * kInlineCapacity && count * 4 <= heap.capacity) {
+        const int shrunk = heap.capacity / 2;
+        int* smaller = new int[shrunk];
+        std::copy(heap.values, heap.values + count, smaller);
+        delete[] heap.values;
+        heap.values = smaller;
+        heap.capacity = shrunk;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Remove all values and release the heap storage of the set.
+ */
+void AdjacencySet::clear() {
+    release();
+}
+
+
+/**
+ * @brief Replace the contents of the set, in the representation that suits their number.
+ * @param values The new values, sorted and distinct.
+ * @param size The number of values.
+ */
+void AdjacencySet::assign(const int* values, std::size_t size) {
+    release();
+    if (size <= static_cast<std::size_t>(kInlineCapacity)) {
+        std::copy(values, values + size, inline_values);
+    }
+    else if (size < static_cast<std::size_t>(kBitmapSize)) {
+        kind = Representation::Sorted;
+        heap.values = new int[size];
+        heap.capacity = static_cast<int>(size);
+        std::copy(values, values + size, heap.values);
+    }
+    else {
+        // One container per run of values with the same high 16 bits
+        Hub* containers = new Hub();
+        for (std::size_t begin = 0; begin < size; ) {
+            const int key = values[begin] >> 16;
+            std::size_t end = begin;
+            while (end < size && (values[end] >> 16) == key) {
+                end++;
+            }
+            containers->containers.push_back(Container());
+            Container& container = containers->containers.back();
+            container.key = key;
+            container.cardinality = static_cast<int>(end - begin);
+            if (container.cardinality > kContainerArraySize) {
+                container.words.assign(kContainerWords, 0);
+                for (std::size_t position = begin; position < end; position++) {
+                    const int low = values[position] & 0xFFFF;
+                    container.words[low >> 6] |= std::uint64_t(1) << (low & 63);
+                }
+            }
+            else {
+                container.values.reserve(end - begin);
+                for (std::size_t position = begin; position < end; position++) {
+                    container.values.push_back(static_cast<std::uint16_t>(values[position] & 0xFFFF));
+                }
+            }
+            begin = end;
+        }
+        kind = Representation::Bitmap;
+        hub = containers;
+    }
+    count = static_cast<int>(size);
+}
+
+
+/**
+ * @brief Find the values two sets have in common.
+ * @param other The other set.
+ * @param out Receives the common values in ascending order, room for min(size(), other.size()) values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t AdjacencySet::intersect(const AdjacencySet& other, int* out) const {
+    if (kind != Representation::Bitmap && other.kind != Representation::Bitmap) {
+        return intersectSorted(arrayValues(), count, other.arrayValues(), other.count, out);
+    }
+
+    std::size_t found = 0;
+    if (kind != Representation::Bitmap || other.kind != Representation::Bitmap) {
+        // Look the values of the array up in the bitmap, walking its containers once
+        const AdjacencySet& array = kind == Representation::Bitmap ? other : *this;
+        const std::vector<Container>& containers = (kind == Representation::Bitmap ? *this : other).hub->containers;
+        const int* values = array.arrayValues();
+        std::size_t next = 0;
+        for (int position = 0; position < array.count && next < containers.size(); position++) {
+            const int key = values[position] >> 16;
+            while (next < containers.size() && containers[next].key < key) {
+                next++;
+            }
+            if (next < containers.size() && containers[next].key == key
+                && containerContains(containers[next], values[position] & 0xFFFF)) {
+                if (out != nullptr) {
+                    out[found] = values[position];
+                }
+                found++;
+            }
+        }
+        return found;
+    }
+
+    // Two bitmaps meet container by container
+    const std::vector<Container>& a = hub->containers;
+    const std::vector<Container>& b = other.hub->containers;
+    std::size_t first = 0;
+    std::size_t second = 0;
+    while (first < a.size() && second < b.size()) {
+        if (a[first].key < b[second].key) {
+            first++;
+        }
+        else if (b[second].key < a[first].key) {
+            second++;
+        }
+        else {
+            found += intersectContainers(a[first++], b[second++], out == nullptr ? nullptr : out + found);
+        }
+    }
+    return found;
+}
+
+
+/**
+ * @brief Get the number of heap bytes the set uses.
+ * @return The heap bytes of the set, 0 for inline sets.
+ */
+std::size_t AdjacencySet::heapBytes() const {
+    if (kind == Representation::Inline) {
+        return 0;
+    }
+    if (kind == Representation::Sorted) {
+        return heap.capacity * sizeof(int);
+    }
+    std::size_t bytes = sizeof(Hub) + hub->containers.capacity() * sizeof(Container);
+    for (const Container& container : hub->containers) {
+        bytes += container.values.capacity() * sizeof(std::uint16_t) + container.words.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
+
+
+/**
+ * @brief Release the heap storage of the set and make it an empty inline set.
+ */
+void AdjacencySet::release() {
+    if (kind == Representation::Sorted) {
+        delete[] heap.values;
+    }
+    else if (kind == Representation::Bitmap) {
+        delete hub;
+    }
+    kind = Representation::Inline;
+    count = 0;
+}
+
+
+/**
+ * @brief Find the container of a bitmap set that holds a key.
+ * @param key The high 16 bits of a value.
+ * @return The container, or nullptr if there is none.
+ */
+const AdjacencySet::Container* AdjacencySet::findContainer(int key) const {
+    const std::vector<Container>& containers = hub->containers;
+    std::vector<Container>::const_iterator container = std::lower_bound(containers.begin(), containers.end(), key,
+        [](const Container& candidate, int target) { return candidate.key < target; });
+    return container == containers.end() || container->key != key ? nullptr : &*container;
+}
+
+
+/**
+ * @brief Check whether a container holds the low 16 bits of a value.
+ * @param container The container.
+ * @param low The low 16 bits of the value.
+ * @return true if the container holds them, false otherwise.
+ */
+bool AdjacencySet::containerContains(const Container& container, int low) {
+    if (!container.words.empty()) {
+        return (container.words[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(container.values.begin(), container.values.end(), static_cast<std::uint16_t>(low));
+}
+
+
+/**
+ * @brief Find the values two containers with the same key have in common.
+ * @param a The first container.
+ * @param b The second container.
+ * @param out Receives the common values in ascending order, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t AdjacencySet::intersectContainers(const Container& a, const Container& b, int* out) {
+    const int base = a.key << 16;
+    std::size_t found = 0;
+    auto emit = [&found, out, base](int low) {
+        if (out != nullptr) {
+            out[found] = base | low;
+        }
+        found++;
+    };
+
+    if (!a.words.empty() && !b.words.empty()) {
+        // AND the bitmaps a word at a time
+        for (int index = 0; index < kContainerWords; index++) {
+            for (std::uint64_t bits = a.words[index] & b.words[index]; bits != 0; bits &= bits - 1) {
+                emit((index << 6) | lowestBit(bits));
+            }
+        }
+    }
+    else if (!a.words.empty() || !b.words.empty()) {
+        const Container& array = a.words.empty() ? a : b;
+        const Container& bitmap = a.words.empty() ? b : a;
+        for (std::uint16_t low : array.values) {
+            if ((bitmap.words[low >> 6] >> (low & 63)) & 1) {
+                emit(low);
+            }
+        }
+    }
+    else {
+        std::size_t first = 0;
+        std::size_t second = 0;
+        while (first < a.values.size() && second < b.values.size()) {
+            if (a.values[first] < b.values[second]) {
+                first++;
+            }
+            else if (b.values[second] < a.values[first]) {
+                second++;
+            }
+            else {
+                emit(a.values[first]);
+                first++;
+                second++;
+            }
+        }
+    }
+    return found;
+}
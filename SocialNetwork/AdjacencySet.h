@@ -0,0 +1,262 @@
+#ifndef ADJACENCYSET_H
+#define ADJACENCYSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @class AdjacencySet
+ * @brief The connections of one user, stored as a set of non-negative slots in a representation chosen by its size.
+ *
+ * Small sets live inline in the object, so most users need no allocation at all. Medium sets are sorted arrays,
+ * searched by bisection. Large sets, the connections of hubs, are Roaring-style compressed bitmaps: the values are
+ * split by their high 16 bits into containers that hold the low 16 bits either as a sorted array of 16-bit values
+ * or, once a container holds more than 4096 values, as a bitmap of 65536 bits. A hub costs at most 2 bytes per
+ * connection, and testing a connection is a search over a few container keys and one bit or array lookup.
+ *
+ * The thresholds between representations leave a gap, so a set that grows and shrinks around one of them does not
+ * convert back and forth on every change. Every operation works on every representation, and forEach() always
+ * visits the values in ascending order.
+ */
+class AdjacencySet {
+public:
+    /**
+     * @enum Representation
+     * @brief How an adjacency set stores its values.
+     */
+    enum class Representation {
+        Inline,  // Up to kInlineCapacity values inside the object.
+        Sorted,  // A sorted array on the heap.
+        Bitmap   // Roaring-style containers on the heap.
+    };
+
+    static const int kInlineCapacity = 4;  // The most values stored inside the object.
+    static const int kBitmapSize = 1024;  // Sorted arrays that reach this size become bitmaps.
+    static const int kSortedSize = 512;  // Bitmaps that fall below this size become sorted arrays.
+
+    /**
+     * @brief Construct an empty Adjacency Set object.
+     */
+    AdjacencySet() noexcept : count(0), kind(Representation::Inline) {}
+
+    /**
+     * @brief Release the storage of the set.
+     */
+    ~AdjacencySet();
+
+    /**
+     * @brief Take over the storage of another set, leaving it empty.
+     * @param other The set to move from.
+     */
+    AdjacencySet(AdjacencySet&& other) noexcept;
+
+    /**
+     * @brief Take over the storage of another set, leaving it empty.
+     * @param other The set to move from.
+     * @return This set.
+     */
+    AdjacencySet& operator=(AdjacencySet&& other) noexcept;
+
+    AdjacencySet(const AdjacencySet&) = delete;
+    AdjacencySet& operator=(const AdjacencySet&) = delete;
+
+    /**
+     * @brief Get the number of values in the set.
+     * @return The number of values.
+     */
+    int size() const {
+        return count;
+    }
+
+    /**
+     * @brief Get how the set stores its values.
+     * @return The representation of the set.
+     */
+    Representation representation() const {
+        return kind;
+    }
+
+    /**
+     * @brief Check whether the set contains a value.
+     * @param value The value to look for.
+     * @return true if the value is in the set, false otherwise.
+     */
+    bool contains(int value) const;
+
+    /**
+     * @brief Add a value to the set.
+     * @param value The value to add.
+     * @return true if the value was added, false if it was already in the set.
+     */
+    bool insert(int value);
+
+    /**
+     * @brief Remove a value from the set.
+     * @param value The value to remove.
+     * @return true if the value was removed, false if it was not in the set.
+     */
+    bool erase(int value);
+
+    /**
+     * @brief Remove all values and release the heap storage of the set.
+     */
+    void clear();
+
+    /**
+     * @brief Replace the contents of the set, in the representation that suits their number.
+     * @param values The new values, sorted and distinct.
+     * @param size The number of values.
+     */
+    void assign(const int* values, std::size_t size);
+
+    /**
+     * @brief Find the values two sets have in common.
+     *
+     * Two arrays are intersected with intersectSorted(), an array and a bitmap by looking every value of the array
+     * up in the bitmap, and two bitmaps container by container, with word-wise ANDs for pairs of bitmap containers.
+     * @param other The other set.
+     * @param out Receives the common values in ascending order, room for min(size(), other.size()) values, or
+     *            nullptr to only count them.
+     * @return The number of common values.
+     */
+    std::size_t intersect(const AdjacencySet& other, int* out) const;
+
+    /**
+     * @brief Get the number of heap bytes the set uses.
+     * @return The heap bytes of the set, 0 for inline sets.
+     */
+    std::size_t heapBytes() const;
+
+    /**
+     * @brief Call a function with every value of the set, in ascending order.
+     * @param visit The function to call with each value.
+     */
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        if (kind != Representation::Bitmap) {
+            const int* values = arrayValues();
+            for (int position = 0; position < count; position++) {
+                visit(values[position]);
+            }
+            return;
+        }
+        for (const Container& container : hub->containers) {
+            const int base = container.key << 16;
+            if (container.words.empty()) {
+                for (std::uint16_t low : container.values) {
+                    visit(base | low);
+                }
+                continue;
+            }
+            for (int word = 0; word < kContainerWords; word++) {
+                std::uint64_t bits = container.words[word];
+                while (bits != 0) {
+                    visit(base | (word << 6) | lowestBit(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+
+private:
+    static const int kContainerWords = 1024;  // The words of a bitmap container, one bit for each low 16-bit value.
+    static const int kContainerArraySize = 4096;  // Array containers that grow beyond this become bitmap containers.
+    static const int kContainerBitmapSize = 2048;  // Bitmap containers that fall below this become array containers.
+
+    /**
+     * @struct Container
+     * @brief The values of a bitmap set that share their high 16 bits.
+     */
+    struct Container {
+        int key;  // The high 16 bits of the values.
+        int cardinality;  // The number of values in the container.
+        std::vector<std::uint16_t> values;  // The sorted low 16 bits, if the container is an array.
+        std::vector<std::uint64_t> words;  // kContainerWords words of bits, if the container is a bitmap.
+    };
+
+    /**
+     * @struct Hub
+     * @brief The containers of a bitmap set, in ascending key order.
+     */
+    struct Hub {
+        std::vector<Container> containers;  // The non-empty containers.
+    };
+
+    /**
+     * @struct HeapArray
+     * @brief The storage of a sorted set.
+     */
+    struct HeapArray {
+        int* values;  // The sorted values.
+        int capacity;  // The number of values there is room for.
+    };
+
+    int count;  // The number of values in the set.
+    Representation kind;  // Which member of the union holds the values.
+    union {
+        int inline_values[kInlineCapacity];  // The sorted values of an inline set.
+        HeapArray heap;  // The values of a sorted set.
+        Hub* hub;  // The containers of a bitmap set.
+    };
+
+    /**
+     * @brief Get the position of the lowest set bit of a word.
+     * @param word The word, not 0.
+     * @return The number of trailing zero bits.
+     */
+    static int lowestBit(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+#else
+        // Isolate the lowest bit and look it up with a de Bruijn multiplication
+        static const unsigned char positions[64] = {
+            0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+            62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+            63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+            46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+        };
+        return positions[((word & (0 - word)) * 0x03F79D71B4CB0A89ull) >> 58];
+#endif
+    }
+
+    /**
+     * @brief Get the sorted values of an inline or sorted set.
+     * @return The values.
+     */
+    const int* arrayValues() const {
+        return kind == Representation::Inline ? inline_values : heap.values;
+    }
+
+    /**
+     * @brief Release the heap storage of the set and make it an empty inline set.
+     */
+    void release();
+
+    /**
+     * @brief Find the container of a bitmap set that holds a key.
+     * @param key The high 16 bits of a value.
+     * @return The container, or nullptr if there is none.
+     */
+    const Container* findContainer(int key) const;
+
+    /**
+     * @brief Check whether a container holds the low 16 bits of a value.
+     * @param container The container.
+     * @param low The low 16 bits of the value.
+     * @return true if the container holds them, false otherwise.
+     */
+    static bool containerContains(const Container& container, int low);
+
+    /**
+     * @brief Find the values two containers with the same key have in common.
+     * @param a The first container.
+     * @param b The second container.
+     * @param out Receives the common values in ascending order, or nullptr.
+     * @return The number of common values.
+     */
+    static std::size_t intersectContainers(const Container& a, const Container& b, int* out);
+};
+
+#endif // ADJACENCYSET_H
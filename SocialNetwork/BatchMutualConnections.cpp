@@ -0,0 +1,94 @@
+#include "BatchMutualConnections.h"
+#include <algorithm>
+#include "SetIntersection.h"
+
+namespace {
+    // A group is answered through a bitmap when it has this many queries
+    const std::size_t kMinBitmapQueries = 2;
+    // and its key has at least this many connections
+    const int kMinBitmapDegree = 64;
+}
+
+/**
+ * @brief Default constructor for BatchMutualConnections class.
+ * Scratch state is created on the first batch.
+ */
+BatchMutualConnections::BatchMutualConnections() {}
+
+
+/**
+ * @brief Count the mutual connections of a batch of pairs in parallel.
+ * @param graph The snapshot to query.
+ * @param pool The thread pool to run the queries on.
+ * @param queries Pairs of dense indices. A pair with a negative index has no answer.
+ * @param counts Receives the number of mutual connections of every query, in query order, -1 if it has no answer.
+ */
+void BatchMutualConnections::run(const NetworkSnapshot& graph, ThreadPool& pool, const std::vector<std::pair<int, int>>& queries,
+                                 std::vector<int>& counts) {
+    counts.assign(queries.size(), -1);
+    if (scratch.size() < pool.size()) {
+        scratch.resize(pool.size());
+    }
+
+    // Key every valid query by its endpoint with more connections
+    std::vector<std::pair<int, int>> keyed;
+    keyed.reserve(queries.size());
+    for (int position = 0; position < static_cast<int>(queries.size()); position++) {
+        int a = queries[position].first;
+        int b = queries[position].second;
+        if (a < 0 || b < 0) {
+            continue;
+        }
+        keyed.push_back(std::make_pair(graph.degree(a) >= graph.degree(b) ? a : b, position));
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<std::size_t> groups;
+    for (std::size_t position = 0; position < keyed.size(); position++) {
+        if (position == 0 || keyed[position].first != keyed[position - 1].first) {
+            groups.push_back(position);
+        }
+    }
+    groups.push_back(keyed.size());
+
+    const std::size_t words = (static_cast<std::size_t>(graph.numberOfUsers()) + 63) / 64;
+    pool.parallelFor(groups.size() - 1, 1, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        Scratch& state = scratch[worker];
+        for (std::size_t group = begin; group < end; group++) {
+            const int key = keyed[groups[group]].first;
+            const int* keyBegin = graph.neighborsBegin(key);
+            const int* keyEnd = graph.neighborsEnd(key);
+            const bool useBitmap = groups[group + 1] - groups[group] >= kMinBitmapQueries
+                && graph.degree(key) >= kMinBitmapDegree;
+
+            if (useBitmap) {
+                if (state.bitmap.size() != words) {
+                    state.bitmap.assign(words, 0);
+                }
+                for (const int* neighbor = keyBegin; neighbor != keyEnd; ++neighbor) {
+                    state.bitmap[*neighbor >> 6] |= std::uint64_t(1) << (*neighbor & 63);
+                }
+            }
+
+            for (std::size_t position = groups[group]; position < groups[group + 1]; position++) {
+                int query = keyed[position].second;
+                int other = queries[query].first == key ? queries[query].second : queries[query].first;
+                if (useBitmap) {
+                    counts[query] = static_cast<int>(intersectBitmap(state.bitmap.data(), graph.neighborsBegin(other),
+                                                                     graph.degree(other), nullptr));
+                }
+                else {
+                    counts[query] = static_cast<int>(intersectSorted(keyBegin, graph.degree(key), graph.neighborsBegin(other),
+                                                                     graph.degree(other), nullptr));
+                }
+            }
+
+            // Leave the bitmap clear for the next group
+            if (useBitmap) {
+                for (const int* neighbor = keyBegin; neighbor != keyEnd; ++neighbor) {
+                    state.bitmap[*neighbor >> 6] = 0;
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,49 @@
+#ifndef BATCHMUTUALCONNECTIONS_H
+#define BATCHMUTUALCONNECTIONS_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+
+
+/**
+ * @class BatchMutualConnections
+ * @brief Counts the mutual connections of many pairs of users over a snapshot in parallel.
+ *
+ * Every query is keyed by its endpoint with more connections, and queries with the same key form a group. A
+ * group whose key is a hub loads the hub's neighbors into a per-worker bitmap once, so each of its queries costs
+ * one bit probe per neighbor of the other user. Other queries intersect the two sorted rows directly.
+ */
+class BatchMutualConnections {
+public:
+    /**
+     * @brief Construct a new Batch Mutual Connections object.
+     */
+    BatchMutualConnections();
+
+    /**
+     * @brief Answer a batch of queries.
+     * @param graph The snapshot to query.
+     * @param pool The thread pool to run the queries on.
+     * @param queries Pairs of dense indices. A pair with a negative index has no answer.
+     * @param counts Receives the number of mutual connections of every query, in query order, -1 if it has no
+     *               answer.
+     */
+    void run(const NetworkSnapshot& graph, ThreadPool& pool, const std::vector<std::pair<int, int>>& queries,
+             std::vector<int>& counts);
+
+private:
+    /**
+     * @struct Scratch
+     * @brief Per-worker state, reused between groups and batches.
+     */
+    struct Scratch {
+        std::vector<std::uint64_t> bitmap;  // Neighbors of the current hub, all clear between groups.
+    };
+
+    std::vector<Scratch> scratch;  // One scratch state per worker.
+};
+
+#endif // BATCHMUTUALCONNECTIONS_H
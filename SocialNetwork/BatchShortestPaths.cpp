@@ -0,0 +1,148 @@
+#include "BatchShortestPaths.h"
+#include <algorithm>
+
+/**
+ * @brief Default constructor for BatchShortestPaths class.
+ * Scratch state is created on the first batch.
+ */
+BatchShortestPaths::BatchShortestPaths() {}
+
+
+/**
+ * @brief Answer a batch of shortest-path queries in parallel.
+ * @param graph The snapshot to search.
+ * @param pool The thread pool to run the queries on.
+ * @param queries Pairs of (source, target) dense indices. A pair with a negative index has no path.
+ * @param include_paths If false, only the path lengths are computed.
+ * @param results Receives one result per query, in query order, with paths as dense indices.
+ */
+void BatchShortestPaths::run(const NetworkSnapshot& graph, ThreadPool& pool, const std::vector<std::pair<int, int>>& queries,
+                             bool include_paths, std::vector<PathResult>& results) {
+    results.assign(queries.size(), PathResult{ -1, std::vector<UserId>() });
+    if (scratch.size() < pool.size()) {
+        scratch.resize(pool.size());
+    }
+
+    // Group the valid queries by source
+    std::vector<int> positions;
+    positions.reserve(queries.size());
+    for (int position = 0; position < static_cast<int>(queries.size()); position++) {
+        if (queries[position].first >= 0 && queries[position].second >= 0) {
+            positions.push_back(position);
+        }
+    }
+    std::sort(positions.begin(), positions.end(), [&queries](int a, int b) {
+        return queries[a].first < queries[b].first;
+    });
+
+    std::vector<std::size_t> groups;
+    for (std::size_t position = 0; position < positions.size(); position++) {
+        if (position == 0 || queries[positions[position]].first != queries[positions[position - 1]].first) {
+            groups.push_back(position);
+        }
+    }
+    groups.push_back(positions.size());
+
+    const int* base = positions.data();
+    pool.parallelFor(groups.size() - 1, 1, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        Scratch& state = scratch[worker];
+        for (std::size_t group = begin; group < end; group++) {
+            const int* groupBegin = base + groups[group];
+            const int* groupEnd = base + groups[group + 1];
+
+            if (groupEnd - groupBegin == 1) {
+                // A lone query is cheaper to answer from both ends
+                const std::pair<int, int>& query = queries[*groupBegin];
+                PathResult& result = results[*groupBegin];
+                result.length = state.pair_search.run(graph, query.first, query.second,
+                                                      include_paths ? &state.path : nullptr);
+                if (include_paths) {
+                    result.path.assign(state.path.begin(), state.path.end());
+                }
+            }
+            else {
+                runGroup(graph, state, queries, groupBegin, groupEnd, include_paths, results);
+            }
+        }
+    });
+}
+
+
+/**
+ * @brief Answer all queries of one source with a single breadth-first search.
+ * @param graph The snapshot to search.
+ * @param state The scratch state of the worker.
+ * @param queries All queries of the batch.
+ * @param group_begin The first position in queries of the group, all with the same source.
+ * @param group_end The end of the positions of the group.
+ * @param include_paths If false, only the path lengths are computed.
+ * @param results The results of the batch.
+ */
+void BatchShortestPaths::runGroup(const NetworkSnapshot& graph, Scratch& state, const std::vector<std::pair<int, int>>& queries,
+                                  const int* group_begin, const int* group_end, bool include_paths, std::vector<PathResult>& results) {
+    const std::size_t users = static_cast<std::size_t>(graph.numberOfUsers());
+    if (state.distance.size() != users) {
+        state.distance.assign(users, -1);
+        state.parent.assign(users, -1);
+        state.wanted.assign(users, 0);
+        state.touched.clear();
+    }
+
+    // Mark the distinct targets of the group
+    int remaining = 0;
+    for (const int* position = group_begin; position != group_end; ++position) {
+        int target = queries[*position].second;
+        if (!state.wanted[target]) {
+            state.wanted[target] = 1;
+            remaining++;
+        }
+    }
+
+    // The touched list doubles as the BFS queue
+    int source = queries[*group_begin].first;
+    state.distance[source] = 0;
+    state.touched.push_back(source);
+    if (state.wanted[source]) {
+        state.wanted[source] = 0;
+        remaining--;
+    }
+
+    for (std::size_t head = 0; head < state.touched.size() && remaining > 0; head++) {
+        int current = state.touched[head];
+        for (const int* neighbor = graph.neighborsBegin(current); neighbor != graph.neighborsEnd(current); ++neighbor) {
+            if (state.distance[*neighbor] != -1) {
+                continue;
+            }
+            state.distance[*neighbor] = state.distance[current] + 1;
+            state.parent[*neighbor] = current;
+            state.touched.push_back(*neighbor);
+            if (state.wanted[*neighbor]) {
+                state.wanted[*neighbor] = 0;
+                remaining--;
+            }
+        }
+    }
+
+    for (const int* position = group_begin; position != group_end; ++position) {
+        int target = queries[*position].second;
+        PathResult& result = results[*position];
+        result.length = state.distance[target];
+        if (include_paths && result.length != -1) {
+            result.path.resize(result.length + 1);
+            int current = target;
+            for (int step = result.length; step >= 0; step--) {
+                result.path[step] = current;
+                current = state.parent[current];
+            }
+        }
+        // Targets that were never reached are still marked
+        state.wanted[target] = 0;
+    }
+
+    // Undo the labels of this search
+    for (int user : state.touched) {
+        state.distance[user] = -1;
+        state.parent[user] = -1;
+    }
+    state.touched.clear();
+}
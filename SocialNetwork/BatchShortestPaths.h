@@ -0,0 +1,78 @@
+#ifndef BATCHSHORTESTPATHS_H
+#define BATCHSHORTESTPATHS_H
+
+#include <utility>
+#include <vector>
+#include "BidirectionalSearch.h"
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+#include "UserId.h"
+
+
+/**
+ * @struct PathResult
+ * @brief The answer to one shortest-path query.
+ */
+struct PathResult {
+    int length;  // The length of the shortest path, -1 if there is none.
+    std::vector<UserId> path;  // The users on the path from source to target, empty if there is none.
+};
+
+
+/**
+ * @class BatchShortestPaths
+ * @brief Answers many shortest-path queries over a snapshot in parallel.
+ *
+ * Queries are grouped by source. A source with a single target uses a bidirectional search, and a source with
+ * several targets runs one breadth-first search that stops once all of its targets are reached. Groups are
+ * spread over the workers of a thread pool, and every worker keeps its own scratch arrays between batches.
+ */
+class BatchShortestPaths {
+public:
+    /**
+     * @brief Construct a new Batch Shortest Paths object.
+     */
+    BatchShortestPaths();
+
+    /**
+     * @brief Answer a batch of queries.
+     * @param graph The snapshot to search.
+     * @param pool The thread pool to run the queries on.
+     * @param queries Pairs of (source, target) dense indices. A pair with a negative index has no path.
+     * @param include_paths If false, only the path lengths are computed.
+     * @param results Receives one result per query, in query order, with paths as dense indices.
+     */
+    void run(const NetworkSnapshot& graph, ThreadPool& pool, const std::vector<std::pair<int, int>>& queries,
+             bool include_paths, std::vector<PathResult>& results);
+
+private:
+    /**
+     * @struct Scratch
+     * @brief Per-worker search state, reused between groups and batches.
+     */
+    struct Scratch {
+        BidirectionalSearch pair_search;  // Search for single-target groups.
+        std::vector<int> distance;  // Distance from the group's source, -1 if not reached.
+        std::vector<int> parent;  // Predecessor towards the group's source.
+        std::vector<char> wanted;  // 1 for targets of the group not reached yet.
+        std::vector<int> touched;  // Users whose distance must be reset.
+        std::vector<int> path;  // Path of a single-target group.
+    };
+
+    std::vector<Scratch> scratch;  // One scratch state per worker.
+
+    /**
+     * @brief Answer all queries of one source with a single breadth-first search.
+     * @param graph The snapshot to search.
+     * @param state The scratch state of the worker.
+     * @param queries All queries of the batch.
+     * @param group_begin The first position in queries of the group, all with the same source.
+     * @param group_end The end of the positions of the group.
+     * @param include_paths If false, only the path lengths are computed.
+     * @param results The results of the batch.
+     */
+    static void runGroup(const NetworkSnapshot& graph, Scratch& state, const std::vector<std::pair<int, int>>& queries,
+                         const int* group_begin, const int* group_end, bool include_paths, std::vector<PathResult>& results);
+};
+
+#endif // BATCHSHORTESTPATHS_H
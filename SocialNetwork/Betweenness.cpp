@@ -0,0 +1,327 @@
+#include "Betweenness.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+    /**
+     * @struct SourceScratch
+     * @brief Per-worker state of the exact computation, reused between sources.
+     */
+    struct SourceScratch {
+        std::vector<int> distance;  // Level of every user from the source, -1 if not reached.
+        std::vector<double> paths;  // The number of shortest paths from the source to every user.
+        std::vector<double> dependency;  // The dependency of the source on every user.
+        std::vector<int> order;  // Reached users in visiting order.
+        std::vector<double> centrality;  // This worker's share of the centrality of every user.
+    };
+
+    /**
+     * @struct PathScratch
+     * @brief Per-worker state of the sampled estimate, reused between samples.
+     */
+    struct PathScratch {
+        std::vector<unsigned> visited[2];  // The sample that last reached every user, from each side.
+        std::vector<int> distance[2];  // Level of every reached user, from each side.
+        std::vector<double> paths[2];  // The number of shortest paths to every reached user, from each side.
+        std::vector<int> frontier[2];  // The users of the current level of each side.
+        std::vector<int> next;  // The users of the next level of the side being expanded.
+        std::vector<int> hits;  // This worker's count of sampled paths through every user.
+        unsigned stamp;  // Stamp of the current sample.
+    };
+
+    /**
+     * @brief Bound the number of users on any shortest path of a snapshot.
+     *
+     * A breadth-first search from one user of every connected component reaches the component in ecc levels,
+     * so no shortest path inside it holds more than 2 * ecc + 1 users.
+     * @param graph The snapshot to bound.
+     * @return The bound, at least 1 for a non-empty snapshot.
+     */
+    int vertexDiameterBound(const NetworkSnapshot& graph) {
+        const int users = graph.numberOfUsers();
+        std::vector<int> distance(users, -1);
+        std::vector<int> queue;
+        queue.reserve(users);
+        int bound = users > 0 ? 1 : 0;
+        for (int start = 0; start < users; start++) {
+            if (distance[start] != -1) {
+                continue;
+            }
+            queue.clear();
+            queue.push_back(start);
+            distance[start] = 0;
+            int eccentricity = 0;
+            for (std::size_t head = 0; head < queue.size(); head++) {
+                int user = queue[head];
+                eccentricity = distance[user];
+                for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                    if (distance[*neighbor] == -1) {
+                        distance[*neighbor] = distance[user] + 1;
+                        queue.push_back(*neighbor);
+                    }
+                }
+            }
+            bound = std::max(bound, static_cast<int>(std::min<std::int64_t>(2 * static_cast<std::int64_t>(eccentricity) + 1,
+                                                                             static_cast<std::int64_t>(queue.size()))));
+        }
+        return bound;
+    }
+
+    /**
+     * @brief Walk from a user back to the start of one side along a shortest path drawn uniformly at random.
+     *
+     * Every step moves to a neighbor one level closer, chosen in proportion to its number of shortest paths.
+     * @param graph The snapshot being measured.
+     * @param state The scratch state of the calling worker.
+     * @param side The side whose levels are followed.
+     * @param user The user to start from.
+     * @param end The user where the side started, which is not credited.
+     * @param skipped A user that is not credited either: the end of the path, or a user credited already.
+     * @param random The random generator of the sample.
+     */
+    void creditPath(const NetworkSnapshot& graph, PathScratch& state, int side, int user, int end, int skipped,
+                    std::mt19937_64& random) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        const std::vector<unsigned>& visited = state.visited[side];
+        const std::vector<int>& distance = state.distance[side];
+        const std::vector<double>& paths = state.paths[side];
+        while (user != end) {
+            if (user != skipped) {
+                state.hits[user]++;
+            }
+            double threshold = uniform(random) * paths[user];
+            int chosen = -1;
+            for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                if (visited[*neighbor] == state.stamp && distance[*neighbor] == distance[user] - 1) {
+                    chosen = *neighbor;
+                    threshold -= paths[*neighbor];
+                    if (threshold < 0) {
+                        break;
+                    }
+                }
+            }
+            user = chosen;
+        }
+    }
+
+    /**
+     * @brief Draw a pair of users and one of their shortest paths uniformly at random, and credit its inner users.
+     * @param graph The snapshot being measured.
+     * @param state The scratch state of the calling worker.
+     * @param random The random generator of the sample.
+     */
+    void samplePath(const NetworkSnapshot& graph, PathScratch& state, std::mt19937_64& random) {
+        const int users = graph.numberOfUsers();
+        int ends[2];
+        ends[0] = static_cast<int>(random() % static_cast<std::uint64_t>(users));
+        ends[1] = static_cast<int>(random() % static_cast<std::uint64_t>(users - 1));
+        ends[1] += ends[1] >= ends[0];
+
+        if (++state.stamp == 0) {
+            for (int side = 0; side < 2; side++) {
+                std::fill(state.visited[side].begin(), state.visited[side].end(), 0u);
+            }
+            state.stamp = 1;
+        }
+        std::int64_t work[2];
+        for (int side = 0; side < 2; side++) {
+            state.visited[side][ends[side]] = state.stamp;
+            state.distance[side][ends[side]] = 0;
+            state.paths[side][ends[side]] = 1;
+            state.frontier[side].assign(1, ends[side]);
+            work[side] = graph.degree(ends[side]);
+        }
+
+        // Expand the side with less work until a level of one side reaches the other
+        while (!state.frontier[0].empty() && !state.frontier[1].empty()) {
+            const int side = work[0] <= work[1] ? 0 : 1;
+            const int other = 1 - side;
+            const int level = state.distance[side][state.frontier[side].front()] + 1;
+            std::vector<unsigned>& visited = state.visited[side];
+            std::vector<int>& distance = state.distance[side];
+            std::vector<double>& paths = state.paths[side];
+
+            state.next.clear();
+            work[side] = 0;
+            for (int user : state.frontier[side]) {
+                for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                    if (visited[*neighbor] != state.stamp) {
+                        visited[*neighbor] = state.stamp;
+                        distance[*neighbor] = level;
+                        paths[*neighbor] = 0;
+                        state.next.push_back(*neighbor);
+                        work[side] += graph.degree(*neighbor);
+                    }
+                    if (distance[*neighbor] == level) {
+                        paths[*neighbor] += paths[user];
+                    }
+                }
+            }
+
+            // The first meeting is at the current level of the other side, so every shortest path crosses the new
+            // level at a user the other side has reached
+            double total = 0;
+            for (int user : state.next) {
+                if (state.visited[other][user] == state.stamp) {
+                    total += paths[user] * state.paths[other][user];
+                }
+            }
+            if (total > 0) {
+                double threshold = std::uniform_real_distribution<double>(0.0, total)(random);
+                int meeting = -1;
+                for (int user : state.next) {
+                    if (state.visited[other][user] == state.stamp) {
+                        meeting = user;
+                        threshold -= paths[user] * state.paths[other][user];
+                        if (threshold < 0) {
+                            break;
+                        }
+                    }
+                }
+                // The meeting user is credited once, on the way back to this side's start
+                creditPath(graph, state, side, meeting, ends[side], ends[other], random);
+                if (meeting != ends[other]) {
+                    creditPath(graph, state, other, meeting, ends[other], meeting, random);
+                }
+                return;
+            }
+            state.frontier[side].swap(state.next);
+        }
+    }
+}
+
+/**
+ * @brief Compute the exact betweenness centrality of a snapshot in parallel with Brandes' algorithm.
+ * @param graph The snapshot to measure.
+ * @param pool The thread pool to search on.
+ * @param result Receives the centrality.
+ */
+void computeBetweenness(const NetworkSnapshot& graph, ThreadPool& pool, BetweennessResult& result) {
+    const int users = graph.numberOfUsers();
+    std::vector<SourceScratch> scratch(pool.size());
+
+    pool.parallelFor(users, 4, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        SourceScratch& state = scratch[worker];
+        if (state.centrality.empty()) {
+            state.distance.assign(users, -1);
+            state.paths.assign(users, 0.0);
+            state.dependency.assign(users, 0.0);
+            state.centrality.assign(users, 0.0);
+            state.order.reserve(users);
+        }
+        for (std::size_t index = begin; index < end; index++) {
+            const int source = static_cast<int>(index);
+
+            // Count the shortest paths level by level
+            state.order.assign(1, source);
+            state.distance[source] = 0;
+            state.paths[source] = 1;
+            for (std::size_t head = 0; head < state.order.size(); head++) {
+                int user = state.order[head];
+                for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                    if (state.distance[*neighbor] == -1) {
+                        state.distance[*neighbor] = state.distance[user] + 1;
+                        state.order.push_back(*neighbor);
+                    }
+                    if (state.distance[*neighbor] == state.distance[user] + 1) {
+                        state.paths[*neighbor] += state.paths[user];
+                    }
+                }
+            }
+
+            // Accumulate the dependencies farthest first, then reset what this source touched
+            for (std::size_t position = state.order.size(); position-- > 1;) {
+                int user = state.order[position];
+                double share = (1 + state.dependency[user]) / state.paths[user];
+                for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                    if (state.distance[*neighbor] == state.distance[user] - 1) {
+                        state.dependency[*neighbor] += state.paths[*neighbor] * share;
+                    }
+                }
+                state.centrality[user] += state.dependency[user];
+            }
+            for (int user : state.order) {
+                state.distance[user] = -1;
+                state.paths[user] = 0;
+                state.dependency[user] = 0;
+            }
+        }
+    });
+
+    // Every unordered pair was counted from both of its users
+    result.centrality.assign(users, 0.0);
+    for (const SourceScratch& state : scratch) {
+        if (!state.centrality.empty()) {
+            for (int user = 0; user < users; user++) {
+                result.centrality[user] += state.centrality[user];
+            }
+        }
+    }
+    for (double& centrality : result.centrality) {
+        centrality /= 2;
+    }
+    result.samples = users;
+    result.error_bound = 0;
+}
+
+
+/**
+ * @brief Estimate the betweenness centrality of a snapshot from sampled shortest paths, in parallel.
+ * @param graph The snapshot to measure.
+ * @param pool The thread pool to sample on.
+ * @param options The error bound, its probability and the seed.
+ * @param result Receives the estimates, scaled to the units of computeBetweenness().
+ */
+void estimateBetweenness(const NetworkSnapshot& graph, ThreadPool& pool, const BetweennessOptions& options,
+                         BetweennessResult& result) {
+    const int users = graph.numberOfUsers();
+    result.centrality.assign(users, 0.0);
+    result.samples = 0;
+    result.error_bound = 0;
+
+    // Without paths of three users or more, no user is ever inside a shortest path
+    const int diameter = vertexDiameterBound(graph);
+    if (diameter < 3) {
+        return;
+    }
+    const double pairs = static_cast<double>(users) * (users - 1) / 2;
+    const double epsilon = options.epsilon;
+    const double delta = std::min(std::max(options.delta, 1e-12), 1.0);
+    const std::int64_t samples = static_cast<std::int64_t>(std::ceil(
+        0.5 / (epsilon * epsilon) * (std::floor(std::log2(diameter - 2.0)) + 1 + std::log(1 / delta))));
+
+    // Every sample draws from its own generator, so the estimate does not depend on the number of threads
+    std::vector<PathScratch> scratch(pool.size());
+    pool.parallelFor(static_cast<std::size_t>(samples), 64, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        PathScratch& state = scratch[worker];
+        if (state.hits.empty()) {
+            for (int side = 0; side < 2; side++) {
+                state.visited[side].assign(users, 0);
+                state.distance[side].assign(users, 0);
+                state.paths[side].assign(users, 0.0);
+            }
+            state.hits.assign(users, 0);
+            state.stamp = 0;
+        }
+        for (std::size_t sample = begin; sample < end; sample++) {
+            std::mt19937_64 random(options.seed + sample * 0x9E3779B97F4A7C15ull);
+            samplePath(graph, state, random);
+        }
+    });
+
+    // Every hit stands for a fraction 1 / samples of all pairs
+    std::vector<std::int64_t> hits(users, 0);
+    for (const PathScratch& state : scratch) {
+        if (!state.hits.empty()) {
+            for (int user = 0; user < users; user++) {
+                hits[user] += state.hits[user];
+            }
+        }
+    }
+    for (int user = 0; user < users; user++) {
+        result.centrality[user] = hits[user] * pairs / samples;
+    }
+    result.samples = samples;
+    result.error_bound = epsilon * pairs;
+}
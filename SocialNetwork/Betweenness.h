@@ -0,0 +1,68 @@
+#ifndef BETWEENNESS_H
+#define BETWEENNESS_H
+
+#include <cstdint>
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+
+
+/**
+ * @struct BetweennessOptions
+ * @brief Whether betweenness is computed exactly or estimated from sampled paths, and how precisely.
+ */
+struct BetweennessOptions {
+    double epsilon = 0;  // The largest error allowed, as a fraction of all pairs of users, or 0 for exact results.
+    double delta = 0.1;  // The probability that some estimate misses the error bound.
+    std::uint64_t seed = 1;  // The seed of the sampled pairs.
+};
+
+
+/**
+ * @struct BetweennessResult
+ * @brief The betweenness centrality of the users of a snapshot.
+ *
+ * Per-user arrays use the dense indices of the snapshot that was measured.
+ */
+struct BetweennessResult {
+    std::vector<double> centrality;  // For every user, the sum over pairs of other users of the fraction of their
+                                     // shortest paths through the user, each unordered pair counted once.
+    std::int64_t samples;  // The number of sampled pairs, or of source users for exact results.
+    double error_bound;  // With probability 1 - delta, no estimate in centrality is off by more than this. 0 if exact.
+};
+
+
+/**
+ * @brief Compute the exact betweenness centrality of a snapshot in parallel with Brandes' algorithm.
+ *
+ * Every user is the source of one breadth-first search that counts its shortest paths, and the dependencies are
+ * then accumulated in reverse visiting order. The sources are spread over the pool, and every worker accumulates
+ * into its own centrality array, so the searches share nothing. This costs O(users * connections).
+ * @param graph The snapshot to measure.
+ * @param pool The thread pool to search on.
+ * @param result Receives the centrality.
+ */
+void computeBetweenness(const NetworkSnapshot& graph, ThreadPool& pool, BetweennessResult& result);
+
+/**
+ * @brief Estimate the betweenness centrality of a snapshot from sampled shortest paths, in parallel.
+ *
+ * Following Riondato and Kornaropoulos, every sample draws a pair of users and one of their shortest paths
+ * uniformly at random, and credits the users inside the path. With
+ *
+ *   r = (0.5 / epsilon^2) * (floor(log2(VD - 2)) + 1 + ln(1 / delta))
+ *
+ * samples, where VD bounds the number of users on any shortest path, every estimate is within epsilon of the
+ * true centrality as a fraction of all pairs, with probability 1 - delta. The number of samples does not depend on
+ * the size of the network. VD is bounded by one breadth-first search per connected component, and the paths are
+ * found with a bidirectional search that always expands the smaller side, so a sample usually touches a small
+ * part of the network.
+ * @param graph The snapshot to measure.
+ * @param pool The thread pool to sample on.
+ * @param options The error bound, its probability and the seed. options.epsilon must be positive.
+ * @param result Receives the estimates, scaled to the units of computeBetweenness().
+ */
+void estimateBetweenness(const NetworkSnapshot& graph, ThreadPool& pool, const BetweennessOptions& options,
+                         BetweennessResult& result);
+
+#endif // BETWEENNESS_H
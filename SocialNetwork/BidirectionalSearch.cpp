@@ -0,0 +1,143 @@
+#include "BidirectionalSearch.h"
+#include <algorithm>
+
+/**
+ * @brief Default constructor for BidirectionalSearch class.
+ * The scratch arrays are sized on the first search.
+ */
+BidirectionalSearch::BidirectionalSearch() {
+    forward.frontier_edges = 0;
+    backward.frontier_edges = 0;
+}
+
+
+/**
+ * @brief Find a shortest path between two users of a snapshot.
+ * @param graph The snapshot to search.
+ * @param source The dense index of the first user.
+ * @param target The dense index of the second user.
+ * @param path If not nullptr, receives the dense indices on the path from source to target.
+ * @return The length of the shortest path, or -1 if no path exists.
+ */
+int BidirectionalSearch::run(const NetworkSnapshot& graph, int source, int target, std::vector<int>* path) {
+    reset(forward, graph, source);
+    reset(backward, graph, target);
+
+    if (path != nullptr) {
+        path->clear();
+    }
+    if (source == target) {
+        if (path != nullptr) {
+            path->push_back(source);
+        }
+        return 0;
+    }
+
+    int length = -1;
+    int meeting = -1;
+    while (!forward.frontier.empty() && !backward.frontier.empty()) {
+        // Always expand the side with less work pending
+        if (forward.frontier_edges <= backward.frontier_edges) {
+            length = expand(forward, backward, graph, meeting);
+        }
+        else {
+            length = expand(backward, forward, graph, meeting);
+        }
+        if (length != -1) {
+            break;
+        }
+    }
+
+    if (length == -1 || path == nullptr) {
+        return length;
+    }
+
+    // Walk from the meeting user back to the source, then on to the target
+    for (int current = meeting; current != -1; current = forward.parent[current]) {
+        path->push_back(current);
+    }
+    std::reverse(path->begin(), path->end());
+    for (int current = backward.parent[meeting]; current != -1; current = backward.parent[current]) {
+        path->push_back(current);
+    }
+    return length;
+}
+
+
+/**
+ * @brief Get the number of users labeled by the last search.
+ * @return The number of users visited from either side.
+ */
+int BidirectionalSearch::visitedCount() const {
+    return static_cast<int>(forward.touched.size() + backward.touched.size());
+}
+
+
+/**
+ * @brief Prepare a side for a new search on a snapshot.
+ * @param side The side to prepare.
+ * @param graph The snapshot to search.
+ * @param endpoint The dense index the side starts from.
+ */
+void BidirectionalSearch::reset(Side& side, const NetworkSnapshot& graph, int endpoint) {
+    std::size_t users = static_cast<std::size_t>(graph.numberOfUsers());
+    if (side.distance.size() != users) {
+        side.distance.assign(users, -1);
+        side.parent.assign(users, -1);
+    }
+    else {
+        // Only undo the labels of the previous search
+        for (int user : side.touched) {
+            side.distance[user] = -1;
+            side.parent[user] = -1;
+        }
+    }
+    side.touched.clear();
+    side.frontier.clear();
+    side.next.clear();
+
+    side.distance[endpoint] = 0;
+    side.touched.push_back(endpoint);
+    side.frontier.push_back(endpoint);
+    side.frontier_edges = graph.degree(endpoint);
+}
+
+
+/**
+ * @brief Expand one full level of a side.
+ * @param side The side to expand.
+ * @param other The opposite side.
+ * @param graph The snapshot to search.
+ * @param meeting Receives the user joining the shortest connection found, if any.
+ * @return The length of the shortest connection found at this level, or -1 if the sides did not meet.
+ */
+int BidirectionalSearch::expand(Side& side, const Side& other, const NetworkSnapshot& graph, int& meeting) {
+    int best = -1;
+    side.next.clear();
+    side.frontier_edges = 0;
+
+    for (int current : side.frontier) {
+        int nextDistance = side.distance[current] + 1;
+        for (const int* neighbor = graph.neighborsBegin(current); neighbor != graph.neighborsEnd(current); ++neighbor) {
+            if (side.distance[*neighbor] != -1) {
+                continue;
+            }
+            side.distance[*neighbor] = nextDistance;
+            side.parent[*neighbor] = current;
+            side.touched.push_back(*neighbor);
+            side.next.push_back(*neighbor);
+            side.frontier_edges += graph.degree(*neighbor);
+
+            // The whole level is finished so the shortest of the connections it finds is kept
+            if (other.distance[*neighbor] != -1) {
+                int length = nextDistance + other.distance[*neighbor];
+                if (best == -1 || length < best) {
+                    best = length;
+                    meeting = *neighbor;
+                }
+            }
+        }
+    }
+    side.frontier.swap(side.next);
+    return best;
+}
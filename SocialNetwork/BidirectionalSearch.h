@@ -0,0 +1,75 @@
+#ifndef BIDIRECTIONALSEARCH_H
+#define BIDIRECTIONALSEARCH_H
+
+#include <vector>
+#include "NetworkSnapshot.h"
+
+
+/**
+ * @class BidirectionalSearch
+ * @brief Exact shortest-path search that grows breadth-first frontiers from both endpoints.
+ *
+ * Each step expands one full level of the side whose frontier has fewer pending edges, and the search stops
+ * as soon as a level connects the two sides. The scratch arrays are kept between calls and only the entries
+ * touched by the previous search are reset, so repeated searches on the same snapshot do not allocate.
+ */
+class BidirectionalSearch {
+public:
+    /**
+     * @brief Construct a new Bidirectional Search object.
+     */
+    BidirectionalSearch();
+
+    /**
+     * @brief Find a shortest path between two users of a snapshot.
+     * @param graph The snapshot to search.
+     * @param source The dense index of the first user.
+     * @param target The dense index of the second user.
+     * @param path If not nullptr, receives the dense indices on the path from source to target.
+     * @return The length of the shortest path, or -1 if no path exists.
+     */
+    int run(const NetworkSnapshot& graph, int source, int target, std::vector<int>* path = nullptr);
+
+    /**
+     * @brief Get the number of users labeled by the last search.
+     * @return The number of users visited from either side.
+     */
+    int visitedCount() const;
+
+private:
+    /**
+     * @struct Side
+     * @brief The search state grown from one endpoint.
+     */
+    struct Side {
+        std::vector<int> distance;  // Distance from the endpoint, -1 if not reached.
+        std::vector<int> parent;  // Predecessor towards the endpoint, -1 for the endpoint itself.
+        std::vector<int> frontier;  // Users at the deepest level reached so far.
+        std::vector<int> next;  // Users discovered by the level being expanded.
+        std::vector<int> touched;  // Users whose distance must be reset before the next search.
+        long long frontier_edges;  // Sum of the degrees of the frontier.
+    };
+
+    Side forward;  // Side grown from the source.
+    Side backward;  // Side grown from the target.
+
+    /**
+     * @brief Prepare a side for a new search on a snapshot.
+     * @param side The side to prepare.
+     * @param graph The snapshot to search.
+     * @param endpoint The dense index the side starts from.
+     */
+    static void reset(Side& side, const NetworkSnapshot& graph, int endpoint);
+
+    /**
+     * @brief Expand one full level of a side.
+     * @param side The side to expand.
+     * @param other The opposite side.
+     * @param graph The snapshot to search.
+     * @param meeting Receives the user joining the shortest connection found, if any.
+     * @return The length of the shortest connection found at this level, or -1 if the sides did not meet.
+     */
+    static int expand(Side& side, const Side& other, const NetworkSnapshot& graph, int& meeting);
+};
+
+#endif // BIDIRECTIONALSEARCH_H
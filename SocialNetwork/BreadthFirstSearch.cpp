@@ -0,0 +1,205 @@
+#include "BreadthFirstSearch.h"
+
+namespace {
+    /**
+     * @brief Check whether a bit is set in a bitmap.
+     * @param bits The bitmap.
+     * @param index The bit to check.
+     * @return true if the bit is set, false otherwise.
+     */
+    inline bool testBit(const std::vector<std::uint64_t>& bits, int index) {
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    /**
+     * @brief Set a bit in a bitmap.
+     * @param bits The bitmap.
+     * @param index The bit to set.
+     */
+    inline void setBit(std::vector<std::uint64_t>& bits, int index) {
+        bits[index >> 6] |= std::uint64_t(1) << (index & 63);
+    }
+
+    /**
+     * @brief Get the position of the lowest set bit of a non-zero word.
+     * @param word The word to scan.
+     * @return The position of the lowest set bit.
+     */
+    inline int lowestBit(std::uint64_t word) {
+        int position = 0;
+        while ((word & 0xFFFF) == 0) {
+            word >>= 16;
+            position += 16;
+        }
+        while ((word & 1) == 0) {
+            word >>= 1;
+            position++;
+        }
+        return position;
+    }
+}
+
+/**
+ * @brief Construct a new BreadthFirstSearch object.
+ * @param alpha Switch to bottom-up once the frontier has more than 1/alpha of the unexplored edges.
+ * @param beta Switch back to top-down once the frontier has fewer than 1/beta of the users.
+ */
+BreadthFirstSearch::BreadthFirstSearch(int alpha, int beta) : alpha(alpha), beta(beta) {}
+
+
+/**
+ * @brief Run a direction-optimizing breadth-first search from a user.
+ * @param graph The snapshot to search.
+ * @param source The dense index of the user to start from.
+ * @param deterministic_order If true, order and parent match a classic queue BFS.
+ * @param result Receives the levels, parents and visiting order.
+ */
+void BreadthFirstSearch::run(const NetworkSnapshot& graph, int source, bool deterministic_order, BfsResult& result) {
+    const int users = graph.numberOfUsers();
+    const std::size_t words = (static_cast<std::size_t>(users) + 63) / 64;
+
+    result.source = source;
+    result.level.assign(users, -1);
+    result.parent.assign(users, -1);
+    result.order.clear();
+    visited.assign(words, 0);
+
+    setBit(visited, source);
+    result.level[source] = 0;
+    result.order.push_back(source);
+
+    // Edges left to explore from unvisited users, and edges leaving the frontier
+    std::int64_t unexploredEdges = graph.numberOfConnections() * 2 - graph.degree(source);
+    std::int64_t frontierEdges = graph.degree(source);
+    std::size_t frontierBegin = 0;
+    bool bottomUp = false;
+
+    for (int depth = 1; frontierBegin < result.order.size(); depth++) {
+        std::size_t frontierSize = result.order.size() - frontierBegin;
+
+        // Pick the direction of this level
+        if (!bottomUp && frontierEdges * alpha > unexploredEdges) {
+            bottomUp = true;
+        }
+        else if (bottomUp && static_cast<std::int64_t>(frontierSize) * beta < users) {
+            bottomUp = false;
+        }
+
+        std::size_t nextBegin = result.order.size();
+        std::int64_t newEdges = bottomUp
+            ? stepBottomUp(graph, depth, frontierBegin, result)
+            : stepTopDown(graph, depth, frontierBegin, result);
+
+        unexploredEdges -= newEdges;
+        frontierEdges = newEdges;
+        frontierBegin = nextBegin;
+    }
+
+    if (deterministic_order) {
+        reorder(graph, result);
+    }
+}
+
+
+/**
+ * @brief Expand one level from the frontier queue at the tail of result.order.
+ * @param graph The snapshot to search.
+ * @param depth The level being built.
+ * @param begin The position of the frontier in result.order.
+ * @param result The search result to update.
+ * @return The sum of the degrees of the new level.
+ */
+std::int64_t BreadthFirstSearch::stepTopDown(const NetworkSnapshot& graph, int depth, std::size_t begin, BfsResult& result) {
+    std::int64_t newEdges = 0;
+    const std::size_t end = result.order.size();
+
+    for (std::size_t position = begin; position < end; position++) {
+        int current = result.order[position];
+        for (const int* neighbor = graph.neighborsBegin(current); neighbor != graph.neighborsEnd(current); ++neighbor) {
+            if (!testBit(visited, *neighbor)) {
+                setBit(visited, *neighbor);
+                result.level[*neighbor] = depth;
+                result.parent[*neighbor] = current;
+                result.order.push_back(*neighbor);
+                newEdges += graph.degree(*neighbor);
+            }
+        }
+    }
+    return newEdges;
+}
+
+
+/**
+ * @brief Build one level by scanning the unvisited users for a parent in the frontier bitmap.
+ * @param graph The snapshot to search.
+ * @param depth The level being built.
+ * @param begin The position of the frontier in result.order.
+ * @param result The search result to update.
+ * @return The sum of the degrees of the new level.
+ */
+std::int64_t BreadthFirstSearch::stepBottomUp(const NetworkSnapshot& graph, int depth, std::size_t begin, BfsResult& result) {
+    const int users = graph.numberOfUsers();
+    const std::size_t words = visited.size();
+    std::int64_t newEdges = 0;
+
+    // Mark the frontier in a bitmap
+    frontier_bits.assign(words, 0);
+    for (std::size_t position = begin; position < result.order.size(); position++) {
+        setBit(frontier_bits, result.order[position]);
+    }
+
+    for (std::size_t word = 0; word < words; word++) {
+        std::uint64_t unvisited = ~visited[word];
+        // Ignore the padding bits of the last word
+        if (word == words - 1 && (users & 63) != 0) {
+            unvisited &= (std::uint64_t(1) << (users & 63)) - 1;
+        }
+
+        while (unvisited != 0) {
+            int current = static_cast<int>(word * 64) + lowestBit(unvisited);
+            unvisited &= unvisited - 1;
+
+            // Stop at the first neighbor in the frontier
+            for (const int* neighbor = graph.neighborsBegin(current); neighbor != graph.neighborsEnd(current); ++neighbor) {
+                if (testBit(frontier_bits, *neighbor)) {
+                    setBit(visited, current);
+                    result.level[current] = depth;
+                    result.parent[current] = *neighbor;
+                    result.order.push_back(current);
+                    newEdges += graph.degree(current);
+                    break;
+                }
+            }
+        }
+    }
+    return newEdges;
+}
+
+
+/**
+ * @brief Rewrite order and parent to match a classic queue BFS that visits neighbors in ascending order.
+ *
+ * A user at level d + 1 is visited by the first user at level d, in visiting order, that it is connected to.
+ * @param graph The snapshot that was searched.
+ * @param result The search result to reorder.
+ */
+void BreadthFirstSearch::reorder(const NetworkSnapshot& graph, BfsResult& result) {
+    // Reuse the frontier bitmap to mark users already placed
+    frontier_bits.assign(visited.size(), 0);
+    reordered.clear();
+    reordered.push_back(result.source);
+    setBit(frontier_bits, result.source);
+
+    for (std::size_t position = 0; position < reordered.size(); position++) {
+        int current = reordered[position];
+        int childLevel = result.level[current] + 1;
+        for (const int* neighbor = graph.neighborsBegin(current); neighbor != graph.neighborsEnd(current); ++neighbor) {
+            if (result.level[*neighbor] == childLevel && !testBit(frontier_bits, *neighbor)) {
+                setBit(frontier_bits, *neighbor);
+                result.parent[*neighbor] = current;
+                reordered.push_back(*neighbor);
+            }
+        }
+    }
+    result.order.swap(reordered);
+}
@@ -0,0 +1,87 @@
+#ifndef BREADTHFIRSTSEARCH_H
+#define BREADTHFIRSTSEARCH_H
+
+#include <cstdint>
+#include <vector>
+#include "NetworkSnapshot.h"
+
+
+/**
+ * @struct BfsResult
+ * @brief The outcome of a breadth-first search over a snapshot.
+ *
+ * All arrays use the dense indices of the snapshot that was searched.
+ */
+struct BfsResult {
+    int source;  // Dense index the search started from.
+    std::vector<int> level;  // Distance from the source, -1 if not reached.
+    std::vector<int> parent;  // Predecessor in the BFS tree, -1 for the source and unreached users.
+    std::vector<int> order;  // Reached users in visiting order.
+};
+
+
+/**
+ * @class BreadthFirstSearch
+ * @brief A direction-optimizing breadth-first search engine.
+ *
+ * Levels are expanded top-down from a frontier queue while the frontier is small, and bottom-up (every
+ * unvisited user looks for a parent in the frontier) once the frontier's edges outweigh the unvisited edges,
+ * following Beamer et al. The frontier and visited sets are bitmaps, and they are kept between runs.
+ */
+class BreadthFirstSearch {
+public:
+    /**
+     * @brief Construct a new Breadth First Search object.
+     * @param alpha Switch to bottom-up once the frontier has more than 1/alpha of the unexplored edges.
+     * @param beta Switch back to top-down once the frontier has fewer than 1/beta of the users.
+     */
+    explicit BreadthFirstSearch(int alpha = 15, int beta = 18);
+
+    /**
+     * @brief Run a breadth-first search from a user.
+     * @param graph The snapshot to search.
+     * @param source The dense index of the user to start from.
+     * @param deterministic_order If true, order and parent match a classic queue BFS that visits neighbors in
+     *        ascending order. Otherwise users are only grouped by level, which avoids a final pass over the edges.
+     * @param result Receives the levels, parents and visiting order.
+     */
+    void run(const NetworkSnapshot& graph, int source, bool deterministic_order, BfsResult& result);
+
+private:
+    int alpha;  // Top-down to bottom-up threshold.
+    int beta;  // Bottom-up to top-down threshold.
+    std::vector<std::uint64_t> visited;  // Bitmap of users reached so far.
+    std::vector<std::uint64_t> frontier_bits;  // Bitmap of the current level, used bottom-up.
+    std::vector<int> reordered;  // Scratch visiting order for deterministic results.
+
+    /**
+     * @brief Expand one level from the frontier queue.
+     *
+     * The frontier queue is the tail of result.order, and the new level is appended after it.
+     * @param graph The snapshot to search.
+     * @param depth The level being built.
+     * @param begin The position of the frontier in result.order.
+     * @param result The search result to update.
+     * @return The sum of the degrees of the new level.
+     */
+    std::int64_t stepTopDown(const NetworkSnapshot& graph, int depth, std::size_t begin, BfsResult& result);
+
+    /**
+     * @brief Build one level by scanning the unvisited users for a parent in the frontier bitmap.
+     * @param graph The snapshot to search.
+     * @param depth The level being built.
+     * @param begin The position of the frontier in result.order.
+     * @param result The search result to update.
+     * @return The sum of the degrees of the new level.
+     */
+    std::int64_t stepBottomUp(const NetworkSnapshot& graph, int depth, std::size_t begin, BfsResult& result);
+
+    /**
+     * @brief Rewrite order and parent to match a classic queue BFS.
+     * @param graph The snapshot that was searched.
+     * @param result The search result to reorder.
+     */
+    void reorder(const NetworkSnapshot& graph, BfsResult& result);
+};
+
+#endif // BREADTHFIRSTSEARCH_H
@@ -0,0 +1,438 @@
+#include "CompressedNetwork.h"
+#include <algorithm>
+#include "DeltaVarint.h"
+
+const int CompressedNetwork::kBlockValues;
+
+
+/**
+ * @brief Call a function with every neighbor of a user, in ascending order, decoding a block at a time.
+ * @param index The dense index of the user.
+ * @param visit The function to call with the dense index of each neighbor.
+ */
+template <typename Visitor>
+void CompressedNetwork::forEachNeighbor(int index, Visitor visit) const {
+    int block[kBlockValues];
+    const unsigned char* in = encoded.data() + offsets[index];
+    for (int begin = 0; begin < degrees[index]; begin += kBlockValues) {
+        int count = std::min(kBlockValues, degrees[index] - begin);
+        in = decodeDeltaVarint(in, count, begin == 0 ? 0 : block[kBlockValues - 1], block);
+        for (int position = 0; position < count; position++) {
+            visit(block[position]);
+        }
+    }
+}
+
+
+/**
+ * @brief Construct a Compressed Network object from a snapshot.
+ * @param graph The snapshot to compress.
+ */
+CompressedNetwork::CompressedNetwork(const NetworkSnapshot& graph)
+    : num_connections(graph.numberOfConnections()) {
+    const int users = graph.numberOfUsers();
+    user_ids.resize(users);
+    degrees.resize(users);
+    offsets.assign(users + 1, 0);
+
+    // Size every list first, so the encoded array is allocated once at its final size
+    for (int index = 0; index < users; index++) {
+        user_ids[index] = graph.userId(index);
+        degrees[index] = graph.degree(index);
+        const int* neighbors = graph.neighborsBegin(index);
+        std::uint64_t bytes = 0;
+        for (int begin = 0; begin < degrees[index]; begin += kBlockValues) {
+            int count = std::min(kBlockValues, degrees[index] - begin);
+            bytes += deltaVarintSize(neighbors + begin, count, begin == 0 ? 0 : neighbors[begin - 1]);
+        }
+        offsets[index + 1] = offsets[index] + bytes;
+    }
+
+    encoded.assign(static_cast<std::size_t>(offsets[users]) + kDeltaVarintPadding, 0);
+    for (int index = 0; index < users; index++) {
+        const int* neighbors = graph.neighborsBegin(index);
+        unsigned char* out = encoded.data() + offsets[index];
+        for (int begin = 0; begin < degrees[index]; begin += kBlockValues) {
+            int count = std::min(kBlockValues, degrees[index] - begin);
+            out += encodeDeltaVarint(neighbors + begin, count, begin == 0 ? 0 : neighbors[begin - 1], out);
+        }
+    }
+
+    forward.frontier_edges = 0;
+    backward.frontier_edges = 0;
+}
+
+
+/**
+ * @brief Compress a snapshot file, reading it in place from a mapping.
+ * @param path The path of the snapshot file.
+ * @return The compressed network, or nullptr if the file is missing or not a valid snapshot.
+ */
+std::unique_ptr<CompressedNetwork> CompressedNetwork::open(const std::string& path) {
+    std::shared_ptr<const NetworkSnapshot> graph = NetworkSnapshot::open(path);
+    if (!graph) {
+        return nullptr;
+    }
+    return std::unique_ptr<CompressedNetwork>(new CompressedNetwork(*graph));
+}
+
+
+/**
+ * @brief Get the number of users in the network.
+ * @return The number of users in the network.
+ */
+int CompressedNetwork::numberOfUsers() const {
+    return static_cast<int>(user_ids.size());
+}
+
+
+/**
+ * @brief Get the number of connections in the network.
+ * @return The number of connections in the network.
+ */
+long long CompressedNetwork::numberOfConnections() const {
+    return num_connections;
+}
+
+
+/**
+ * @brief Check if a user is in the network.
+ * @param user_id The ID of the user.
+ * @return true if the user is in the network, false otherwise.
+ */
+bool CompressedNetwork::hasUser(UserId user_id) const {
+    return indexOf(user_id) != -1;
+}
+
+
+/**
+ * @brief Get the connections of a user, in ascending ID order.
+ * @param user_id The ID of the user.
+ * @param connections Receives the IDs of the connected users.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus CompressedNetwork::connectionsOf(UserId user_id, std::vector<UserId>& connections) const {
+    connections.clear();
+    int index = indexOf(user_id);
+    if (index == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+    connections.reserve(degrees[index]);
+    forEachNeighbor(index, [this, &connections](int neighbor) {
+        connections.push_back(user_ids[neighbor]);
+    });
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Check if two users are connected.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return true if the two users are connected or are the same existing user, false otherwise.
+ */
+bool CompressedNetwork::isConnected(UserId user_id1, UserId user_id2) const {
+    int index1 = indexOf(user_id1);
+    int index2 = indexOf(user_id2);
+    if (index1 == -1 || index2 == -1) {
+        return false;
+    }
+    if (index1 == index2) {
+        return true;
+    }
+    if (degrees[index2] < degrees[index1]) {
+        std::swap(index1, index2);
+    }
+
+    // Decode the shorter list until a block reaches the other user
+    int block[kBlockValues];
+    const unsigned char* in = encoded.data() + offsets[index1];
+    for (int begin = 0; begin < degrees[index1]; begin += kBlockValues) {
+        int count = std::min(kBlockValues, degrees[index1] - begin);
+        in = decodeDeltaVarint(in, count, begin == 0 ? 0 : block[kBlockValues - 1], block);
+        if (block[count - 1] >= index2) {
+            return std::binary_search(block, block + count, index2);
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Find the length of the shortest path between two users with a bidirectional search.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+ */
+int CompressedNetwork::findShortestPath(UserId user_id1, UserId user_id2) {
+    int start = indexOf(user_id1);
+    int end = indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        return -1;
+    }
+    return search(start, end, nullptr);
+}
+
+
+/**
+ * @brief Find the shortest path between two users with a bidirectional search.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+ * @return Ok, UserNotFound or NoPath.
+ */
+NetworkStatus CompressedNetwork::findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path) {
+    path.clear();
+    int start = indexOf(user_id1);
+    int end = indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+    if (search(start, end, &row) == -1) {
+        return NetworkStatus::NoPath;
+    }
+    path.reserve(row.size());
+    for (int user : row) {
+        path.push_back(user_ids[user]);
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Perform a breadth-first search from a given user, visiting neighbors in ascending ID order.
+ * @param user_id The ID of the user to start the search from.
+ * @param order Receives the IDs of the reached users in visiting order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus CompressedNetwork::BFS(UserId user_id, std::vector<UserId>& order) {
+    order.clear();
+    int start = indexOf(user_id);
+    if (start == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+
+    visited.assign((user_ids.size() + 63) / 64, 0);
+    stack.clear();
+    stack.push_back(start);
+    visited[start / 64] |= std::uint64_t(1) << (start % 64);
+    for (std::size_t head = 0; head < stack.size(); head++) {
+        forEachNeighbor(stack[head], [this](int neighbor) {
+            std::uint64_t bit = std::uint64_t(1) << (neighbor % 64);
+            if (!(visited[neighbor / 64] & bit)) {
+                visited[neighbor / 64] |= bit;
+                stack.push_back(neighbor);
+            }
+        });
+    }
+
+    order.reserve(stack.size());
+    for (int index : stack) {
+        order.push_back(user_ids[index]);
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Perform a depth-first search from a given user, exploring neighbors in ascending ID order.
+ * @param user_id The ID of the user to start the search from.
+ * @param order Receives the IDs of the reached users in visiting order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus CompressedNetwork::DFS(UserId user_id, std::vector<UserId>& order) {
+    order.clear();
+    int start = indexOf(user_id);
+    if (start == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+
+    visited.assign((user_ids.size() + 63) / 64, 0);
+    stack.clear();
+    stack.push_back(start);
+    visited[start / 64] |= std::uint64_t(1) << (start % 64);
+    while (!stack.empty()) {
+        int current = stack.back();
+        stack.pop_back();
+        order.push_back(user_ids[current]);
+
+        // Push in descending order so the neighbor with the smallest ID is explored first
+        decodeNeighbors(current, row);
+        for (std::size_t position = row.size(); position-- > 0; ) {
+            int neighbor = row[position];
+            std::uint64_t bit = std::uint64_t(1) << (neighbor % 64);
+            if (!(visited[neighbor / 64] & bit)) {
+                visited[neighbor / 64] |= bit;
+                stack.push_back(neighbor);
+            }
+        }
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Get the size of the encoded neighbor lists.
+ * @return The number of bytes of the encoded lists, padding included.
+ */
+std::size_t CompressedNetwork::encodedBytes() const {
+    return encoded.size();
+}
+
+
+/**
+ * @brief Get the memory the network holds.
+ * @return The number of bytes of the user IDs, the list offsets and the encoded lists.
+ */
+std::size_t CompressedNetwork::memoryUsage() const {
+    return user_ids.size() * sizeof(UserId) + offsets.size() * sizeof(std::uint64_t)
+        + degrees.size() * sizeof(int) + encoded.size();
+}
+
+
+/**
+ * @brief Find the dense index of a user.
+ * @param user_id The ID of the user to find.
+ * @return The dense index of the user if found, -1 otherwise.
+ */
+int CompressedNetwork::indexOf(UserId user_id) const {
+    std::vector<UserId>::const_iterator it = std::lower_bound(user_ids.begin(), user_ids.end(), user_id);
+    if (it == user_ids.end() || *it != user_id) {
+        return -1;
+    }
+    return static_cast<int>(it - user_ids.begin());
+}
+
+
+/**
+ * @brief Decode the whole list of a user.
+ * @param index The dense index of the user.
+ * @param out Receives the dense indices of the neighbors, in ascending order.
+ */
+void CompressedNetwork::decodeNeighbors(int index, std::vector<int>& out) const {
+    out.resize(degrees[index]);
+    const unsigned char* in = encoded.data() + offsets[index];
+    for (int begin = 0; begin < degrees[index]; begin += kBlockValues) {
+        int count = std::min(kBlockValues, degrees[index] - begin);
+        in = decodeDeltaVarint(in, count, begin == 0 ? 0 : out[begin - 1], out.data() + begin);
+    }
+}
+
+
+/**
+ * @brief Find a shortest path between two users by their dense indices.
+ * @param source The dense index of the first user.
+ * @param target The dense index of the second user.
+ * @param path If not nullptr, receives the dense indices on the path from source to target.
+ * @return The length of the shortest path, or -1 if no path exists.
+ */
+int CompressedNetwork::search(int source, int target, std::vector<int>* path) {
+    reset(forward, source);
+    reset(backward, target);
+
+    if (path != nullptr) {
+        path->clear();
+    }
+    if (source == target) {
+        if (path != nullptr) {
+            path->push_back(source);
+        }
+        return 0;
+    }
+
+    int length = -1;
+    int meeting = -1;
+    while (!forward.frontier.empty() && !backward.frontier.empty()) {
+        // Always expand the side with less work pending
+        if (forward.frontier_edges <= backward.frontier_edges) {
+            length = expand(forward, backward, meeting);
+        }
+        else {
+            length = expand(backward, forward, meeting);
+        }
+        if (length != -1) {
+            break;
+        }
+    }
+
+    if (length == -1 || path == nullptr) {
+        return length;
+    }
+
+    // Walk from the meeting user back to the source, then on to the target
+    for (int current = meeting; current != -1; current = forward.parent[current]) {
+        path->push_back(current);
+    }
+    std::reverse(path->begin(), path->end());
+    for (int current = backward.parent[meeting]; current != -1; current = backward.parent[current]) {
+        path->push_back(current);
+    }
+    return length;
+}
+
+
+/**
+ * @brief Prepare a side for a new search.
+ * @param side The side to prepare.
+ * @param endpoint The dense index the side starts from.
+ */
+void CompressedNetwork::reset(Side& side, int endpoint) {
+    if (side.distance.size() != user_ids.size()) {
+        side.distance.assign(user_ids.size(), -1);
+        side.parent.assign(user_ids.size(), -1);
+    }
+    else {
+        // Only undo the labels of the previous search
+        for (int user : side.touched) {
+            side.distance[user] = -1;
+            side.parent[user] = -1;
+        }
+    }
+    side.touched.clear();
+    side.frontier.clear();
+    side.next.clear();
+
+    side.distance[endpoint] = 0;
+    side.touched.push_back(endpoint);
+    side.frontier.push_back(endpoint);
+    side.frontier_edges = degrees[endpoint];
+}
+
+
+/**
+ * @brief Expand one full level of a side.
+ * @param side The side to expand.
+ * @param other The opposite side.
+ * @param meeting Receives the user joining the shortest connection found, if any.
+ * @return The length of the shortest connection found at this level, or -1 if the sides did not meet.
+ */
+int CompressedNetwork::expand(Side& side, const Side& other, int& meeting) {
+    int best = -1;
+    side.next.clear();
+    side.frontier_edges = 0;
+
+    for (int current : side.frontier) {
+        int nextDistance = side.distance[current] + 1;
+        forEachNeighbor(current, [&](int neighbor) {
+            if (side.distance[neighbor] != -1) {
+                return;
+            }
+            side.distance[neighbor] = nextDistance;
+            side.parent[neighbor] = current;
+            side.touched.push_back(neighbor);
+            side.next.push_back(neighbor);
+            side.frontier_edges += degrees[neighbor];
+
+            // The whole level is finished so the shortest of the connections it finds is kept
+            if (other.distance[neighbor] != -1) {
+                int length = nextDistance + other.distance[neighbor];
+                if (best == -1 || length < best) {
+                    best = length;
+                    meeting = neighbor;
+                }
+            }
+        });
+    }
+    side.frontier.swap(side.next);
+    return best;
+}
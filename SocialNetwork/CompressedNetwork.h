@@ -0,0 +1,204 @@
+#ifndef COMPRESSEDNETWORK_H
+#define COMPRESSEDNETWORK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "NetworkStatus.h"
+#include "UserId.h"
+
+
+/**
+ * @class CompressedNetwork
+ * @brief A read-only social network whose neighbor lists are delta and varint compressed.
+ *
+ * Users keep the dense indices of the snapshot the network was built from, so neighbor lists are sorted and the
+ * gaps between consecutive neighbors are small. Each list is cut into blocks of kBlockValues neighbors, and every
+ * block is encoded with encodeDeltaVarint() against the last neighbor of the previous block. Queries decode one
+ * block at a time into a buffer on the stack, so nothing is decompressed ahead of time: isConnected() stops at the
+ * first block that reaches the user it looks for, and traversals decode each list once when they expand a user.
+ *
+ * A neighbor takes 1.25 bytes when the gap to the previous one is below 256 and 2.25 bytes below 65536, against 4
+ * bytes in a snapshot row. Building from a mapped snapshot file with open() never holds the uncompressed lists in
+ * memory, which suits networks that do not fit in RAM uncompressed. Traversals visit users in the same order as the
+ * ones of SocialNetwork. Queries that search keep scratch state in the object, so one network must only be searched
+ * by one thread at a time.
+ */
+class CompressedNetwork {
+public:
+    static const int kBlockValues = 128;  // The neighbors encoded and decoded together.
+
+    /**
+     * @brief Construct a Compressed Network object from a snapshot.
+     * @param graph The snapshot to compress.
+     */
+    explicit CompressedNetwork(const NetworkSnapshot& graph);
+
+    CompressedNetwork(const CompressedNetwork&) = delete;
+    CompressedNetwork& operator=(const CompressedNetwork&) = delete;
+
+    /**
+     * @brief Compress a snapshot file, reading it in place from a mapping.
+     * @param path The path of the snapshot file.
+     * @return The compressed network, or nullptr if the file is missing or not a valid snapshot.
+     */
+    static std::unique_ptr<CompressedNetwork> open(const std::string& path);
+
+    /**
+     * @brief Get the number of users in the network.
+     * @return The number of users in the network.
+     */
+    int numberOfUsers() const;
+
+    /**
+     * @brief Get the number of connections in the network.
+     * @return The number of connections in the network.
+     */
+    long long numberOfConnections() const;
+
+    /**
+     * @brief Check if a user is in the network.
+     * @param user_id The ID of the user.
+     * @return true if the user is in the network, false otherwise.
+     */
+    bool hasUser(UserId user_id) const;
+
+    /**
+     * @brief Get the connections of a user, in ascending ID order.
+     * @param user_id The ID of the user.
+     * @param connections Receives the IDs of the connected users.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus connectionsOf(UserId user_id, std::vector<UserId>& connections) const;
+
+    /**
+     * @brief Check if two users are connected.
+     *
+     * The list of the user with fewer connections is decoded until it reaches the other user.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return true if the two users are connected or are the same existing user, false otherwise.
+     */
+    bool isConnected(UserId user_id1, UserId user_id2) const;
+
+    /**
+     * @brief Find the length of the shortest path between two users with a bidirectional search.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+     */
+    int findShortestPath(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Find the shortest path between two users with a bidirectional search.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+     * @return Ok, UserNotFound or NoPath.
+     */
+    NetworkStatus findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path);
+
+    /**
+     * @brief Perform a breadth-first search from a given user, visiting neighbors in ascending ID order.
+     * @param user_id The ID of the user to start the search from.
+     * @param order Receives the IDs of the reached users in visiting order.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus BFS(UserId user_id, std::vector<UserId>& order);
+
+    /**
+     * @brief Perform a depth-first search from a given user, exploring neighbors in ascending ID order.
+     * @param user_id The ID of the user to start the search from.
+     * @param order Receives the IDs of the reached users in visiting order.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus DFS(UserId user_id, std::vector<UserId>& order);
+
+    /**
+     * @brief Get the size of the encoded neighbor lists.
+     * @return The number of bytes of the encoded lists, padding included.
+     */
+    std::size_t encodedBytes() const;
+
+    /**
+     * @brief Get the memory the network holds.
+     * @return The number of bytes of the user IDs, the list offsets and the encoded lists.
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    /**
+     * @struct Side
+     * @brief The search state grown from one endpoint of a shortest path search.
+     */
+    struct Side {
+        std::vector<int> distance;  // Distance from the endpoint, -1 if not reached.
+        std::vector<int> parent;  // Predecessor towards the endpoint, -1 for the endpoint itself.
+        std::vector<int> frontier;  // Users at the deepest level reached so far.
+        std::vector<int> next;  // Users discovered by the level being expanded.
+        std::vector<int> touched;  // Users whose distance must be reset before the next search.
+        long long frontier_edges;  // Sum of the degrees of the frontier.
+    };
+
+    std::vector<UserId> user_ids;  // User ID of every dense index, sorted ascending.
+    std::vector<std::uint64_t> offsets;  // Start of the encoded list of every user, num_users + 1 entries.
+    std::vector<int> degrees;  // The number of connections of every user.
+    std::vector<unsigned char> encoded;  // The encoded lists, followed by kDeltaVarintPadding bytes.
+    long long num_connections;  // The number of connections.
+    Side forward;  // Shortest path search side grown from the source.
+    Side backward;  // Shortest path search side grown from the target.
+    std::vector<std::uint64_t> visited;  // Bitmap of the users reached by the current traversal.
+    std::vector<int> stack;  // Reusable queue of BFS, or stack of DFS.
+    std::vector<int> row;  // Reusable decoded list, or dense indices of a path.
+
+    /**
+     * @brief Find the dense index of a user.
+     * @param user_id The ID of the user to find.
+     * @return The dense index of the user if found, -1 otherwise.
+     */
+    int indexOf(UserId user_id) const;
+
+    /**
+     * @brief Call a function with every neighbor of a user, in ascending order, decoding a block at a time.
+     * @param index The dense index of the user.
+     * @param visit The function to call with the dense index of each neighbor.
+     */
+    template <typename Visitor>
+    void forEachNeighbor(int index, Visitor visit) const;
+
+    /**
+     * @brief Decode the whole list of a user.
+     * @param index The dense index of the user.
+     * @param out Receives the dense indices of the neighbors, in ascending order.
+     */
+    void decodeNeighbors(int index, std::vector<int>& out) const;
+
+    /**
+     * @brief Find a shortest path between two users by their dense indices.
+     * @param source The dense index of the first user.
+     * @param target The dense index of the second user.
+     * @param path If not nullptr, receives the dense indices on the path from source to target.
+     * @return The length of the shortest path, or -1 if no path exists.
+     */
+    int search(int source, int target, std::vector<int>* path);
+
+    /**
+     * @brief Prepare a side for a new search.
+     * @param side The side to prepare.
+     * @param endpoint The dense index the side starts from.
+     */
+    void reset(Side& side, int endpoint);
+
+    /**
+     * @brief Expand one full level of a side.
+     * @param side The side to expand.
+     * @param other The opposite side.
+     * @param meeting Receives the user joining the shortest connection found, if any.
+     * @return The length of the shortest connection found at this level, or -1 if the sides did not meet.
+     */
+    int expand(Side& side, const Side& other, int& meeting);
+};
+
+#endif // COMPRESSEDNETWORK_H
@@ -0,0 +1,145 @@
+#include "ConnectedComponents.h"
+#include <algorithm>
+#include <functional>
+
+/**
+ * @brief Default constructor for ConnectedComponents class.
+ * Creates an empty forest.
+ */
+ConnectedComponents::ConnectedComponents() : mark(0), num_components(0) {}
+
+
+/**
+ * @brief Add a user that is not connected to anyone.
+ * @param slot The slot of the user.
+ */
+void ConnectedComponents::addSlot(int slot) {
+    if (slot >= static_cast<int>(parent.size())) {
+        parent.resize(slot + 1);
+        size.resize(slot + 1, 0);
+    }
+    parent[slot] = slot;
+    size[slot] = 1;
+    num_components++;
+}
+
+
+/**
+ * @brief Remove a user, after removeConnection() was called for all of its connections.
+ * @param slot The slot of the user.
+ */
+void ConnectedComponents::removeSlot(int slot) {
+    // A user that was never merged can leave at once
+    if (parent[slot] == slot && size[slot] == 1) {
+        size[slot] = 0;
+        num_components--;
+        return;
+    }
+    pending_removed.push_back(slot);
+}
+
+
+/**
+ * @brief Record a new connection between two users.
+ * @param slot1 The slot of the first user.
+ * @param slot2 The slot of the second user.
+ */
+void ConnectedComponents::addConnection(int slot1, int slot2) {
+    int root1 = find(slot1);
+    int root2 = find(slot2);
+    if (root1 == root2) {
+        return;
+    }
+    // Hang the smaller tree under the larger one
+    if (size[root1] < size[root2]) {
+        std::swap(root1, root2);
+    }
+    parent[root2] = root1;
+    size[root1] += size[root2];
+    num_components--;
+}
+
+
+/**
+ * @brief Record that a connection between two users was removed.
+ * @param slot1 The slot of the first user.
+ * @param slot2 The slot of the second user.
+ */
+void ConnectedComponents::removeConnection(int slot1, int slot2) {
+    pending_endpoints.push_back(slot1);
+    pending_endpoints.push_back(slot2);
+}
+
+
+/**
+ * @brief Check if removals are waiting for flush().
+ * @return true if components must be relabeled before they are queried, false otherwise.
+ */
+bool ConnectedComponents::hasPending() const {
+    return !pending_endpoints.empty() || !pending_removed.empty();
+}
+
+
+/**
+ * @brief Find the representative of the component of a user, halving the path on the way.
+ * @param slot The slot of the user.
+ * @return The slot of the representative user.
+ */
+int ConnectedComponents::find(int slot) {
+    while (parent[slot] != slot) {
+        parent[slot] = parent[parent[slot]];
+        slot = parent[slot];
+    }
+    return slot;
+}
+
+
+/**
+ * @brief Get the number of users in the component of a user.
+ * @param slot The slot of the user.
+ * @return The size of the component.
+ */
+int ConnectedComponents::componentSize(int slot) {
+    return size[find(slot)];
+}
+
+
+/**
+ * @brief Get the number of components.
+ * @return The number of components, counting users without connections.
+ */
+int ConnectedComponents::numberOfComponents() const {
+    return num_components;
+}
+
+
+/**
+ * @brief Get the sizes of all components.
+ * @return The size of every component, largest first.
+ */
+std::vector<int> ConnectedComponents::componentSizes() const {
+    std::vector<int> sizes;
+    sizes.reserve(num_components);
+    for (int slot = 0; slot < static_cast<int>(parent.size()); slot++) {
+        // Roots of free slots have size 0
+        if (parent[slot] == slot && size[slot] > 0) {
+            sizes.push_back(size[slot]);
+        }
+    }
+    std::sort(sizes.begin(), sizes.end(), std::greater<int>());
+    return sizes;
+}
+
+
+/**
+ * @brief Remove all users.
+ */
+void ConnectedComponents::clear() {
+    std::vector<int>().swap(parent);
+    std::vector<int>().swap(size);
+    pending_endpoints.clear();
+    pending_removed.clear();
+    std::vector<unsigned>().swap(visit_mark);
+    mark = 0;
+    num_components = 0;
+}
@@ -0,0 +1,173 @@
+#ifndef CONNECTEDCOMPONENTS_H
+#define CONNECTEDCOMPONENTS_H
+
+#include <algorithm>
+#include <vector>
+
+
+/**
+ * @class ConnectedComponents
+ * @brief Incrementally maintained connected components over the stable slots of a user table.
+ *
+ * Added connections are merged with a union-find forest (union by size, path halving). A union-find cannot
+ * split, so removed connections and users only record their endpoints as pending. The next query first calls
+ * flush(), which runs a breadth-first search from every pending endpoint and relabels just the components that
+ * lost a connection; every user of such a component is reachable from one of its pending endpoints. Until then,
+ * freed slots stay in the forest because other slots may still point through them, so a freed slot must not be
+ * added again while work is pending.
+ */
+class ConnectedComponents {
+public:
+    /**
+     * @brief Construct an empty Connected Components object.
+     */
+    ConnectedComponents();
+
+    /**
+     * @brief Add a user that is not connected to anyone.
+     * @param slot The slot of the user. It must not be in use, and must not be a freed slot while hasPending().
+     */
+    void addSlot(int slot);
+
+    /**
+     * @brief Remove a user, after removeConnection() was called for all of its connections.
+     * @param slot The slot of the user.
+     */
+    void removeSlot(int slot);
+
+    /**
+     * @brief Record a new connection between two users.
+     * @param slot1 The slot of the first user.
+     * @param slot2 The slot of the second user.
+     */
+    void addConnection(int slot1, int slot2);
+
+    /**
+     * @brief Record that a connection between two users was removed.
+     * @param slot1 The slot of the first user.
+     * @param slot2 The slot of the second user.
+     */
+    void removeConnection(int slot1, int slot2);
+
+    /**
+     * @brief Check if removals are waiting for flush().
+     * @return true if components must be relabeled before they are queried, false otherwise.
+     */
+    bool hasPending() const;
+
+    /**
+     * @brief Relabel the components that lost connections or users since the last flush.
+     * @param for_each_neighbor Called as for_each_neighbor(slot, visit); must call visit(neighbor_slot) for every
+     *                          current connection of the user in slot.
+     */
+    template <typename ForEachNeighbor>
+    void flush(ForEachNeighbor for_each_neighbor);
+
+    /**
+     * @brief Find the representative of the component of a user. Requires !hasPending().
+     * @param slot The slot of the user.
+     * @return The slot of the representative user, equal for all users of a component.
+     */
+    int find(int slot);
+
+    /**
+     * @brief Get the number of users in the component of a user. Requires !hasPending().
+     * @param slot The slot of the user.
+     * @return The size of the component.
+     */
+    int componentSize(int slot);
+
+    /**
+     * @brief Get the number of components. Requires !hasPending().
+     * @return The number of components, counting users without connections.
+     */
+    int numberOfComponents() const;
+
+    /**
+     * @brief Get the sizes of all components. Requires !hasPending().
+     * @return The size of every component, largest first.
+     */
+    std::vector<int> componentSizes() const;
+
+    /**
+     * @brief Remove all users.
+     */
+    void clear();
+
+private:
+    std::vector<int> parent;  // Parent of every slot in the forest, a root is its own parent.
+    std::vector<int> size;  // Number of users under every root, 0 for free slots.
+    std::vector<int> pending_endpoints;  // Slots that lost a connection since the last flush.
+    std::vector<int> pending_removed;  // Slots of users removed since the last flush.
+    std::vector<unsigned> visit_mark;  // Slots visited by the current flush carry the current mark.
+    unsigned mark;  // The mark of the current flush.
+    int num_components;  // The number of components.
+};
+
+
+/**
+ * @brief Relabel the components that lost connections or users since the last flush.
+ * @param for_each_neighbor Called as for_each_neighbor(slot, visit) for every current connection of slot.
+ */
+template <typename ForEachNeighbor>
+void ConnectedComponents::flush(ForEachNeighbor for_each_neighbor) {
+    if (!hasPending()) {
+        return;
+    }
+    visit_mark.resize(parent.size(), 0);
+    if (++mark == 0) {
+        std::fill(visit_mark.begin(), visit_mark.end(), 0);
+        mark = 1;
+    }
+
+    // Count the old components that are affected, removed users included
+    std::vector<int> oldRoots;
+    for (int slot : pending_endpoints) {
+        oldRoots.push_back(find(slot));
+    }
+    for (int slot : pending_removed) {
+        oldRoots.push_back(find(slot));
+    }
+    std::sort(oldRoots.begin(), oldRoots.end());
+    int affected = static_cast<int>(std::unique(oldRoots.begin(), oldRoots.end()) - oldRoots.begin());
+
+    // Free slots are only reachable through the forest, so they can be reset once no live slot points at them
+    for (int slot : pending_removed) {
+        visit_mark[slot] = mark;
+    }
+
+    // Every surviving user of an affected component is reachable from one of its pending endpoints
+    int found = 0;
+    std::vector<int> queue;
+    for (int start : pending_endpoints) {
+        if (visit_mark[start] == mark) {
+            continue;
+        }
+        visit_mark[start] = mark;
+        queue.clear();
+        queue.push_back(start);
+        for (std::size_t head = 0; head < queue.size(); head++) {
+            for_each_neighbor(queue[head], [this, &queue](int neighbor) {
+                if (visit_mark[neighbor] != mark) {
+                    visit_mark[neighbor] = mark;
+                    queue.push_back(neighbor);
+                }
+            });
+        }
+        for (int slot : queue) {
+            parent[slot] = start;
+        }
+        size[start] = static_cast<int>(queue.size());
+        found++;
+    }
+
+    for (int slot : pending_removed) {
+        parent[slot] = slot;
+        size[slot] = 0;
+    }
+    num_components += found - affected;
+    pending_endpoints.clear();
+    pending_removed.clear();
+}
+
+#endif // CONNECTEDCOMPONENTS_H
@@ -0,0 +1,169 @@
+#include "ConnectionRecommender.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+    /**
+     * @brief Order recommendations from best to worst.
+     * @param a The first recommendation.
+     * @param b The second recommendation.
+     * @return true if a has a higher score than b, or the same score and a lower index.
+     */
+    bool better(const Recommendation& a, const Recommendation& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.user < b.user;
+    }
+}
+
+/**
+ * @brief Default constructor for ConnectionRecommender class.
+ * Scratch state is created on the first query.
+ */
+ConnectionRecommender::ConnectionRecommender() {}
+
+
+/**
+ * @brief Recommend connections for one user.
+ * @param graph The snapshot to query.
+ * @param user The dense index of the user.
+ * @param k The maximum number of recommendations.
+ * @param score How candidates are scored.
+ * @param max_fanout Neighbors with more connections than this are not walked through, 0 for no limit.
+ * @param recommendations Receives the recommendations as dense indices, best first.
+ */
+void ConnectionRecommender::recommend(const NetworkSnapshot& graph, int user, int k, RecommendationScore score, int max_fanout,
+                                      std::vector<Recommendation>& recommendations) {
+    if (scratch.empty()) {
+        scratch.resize(1);
+    }
+    recommendOne(graph, user, k, score, max_fanout, scratch[0], recommendations);
+}
+
+
+/**
+ * @brief Recommend connections for many users in parallel.
+ * @param graph The snapshot to query.
+ * @param pool The thread pool to run the queries on.
+ * @param users Dense indices of the users. A negative index gets no recommendations.
+ * @param k The maximum number of recommendations per user.
+ * @param score How candidates are scored.
+ * @param max_fanout Neighbors with more connections than this are not walked through, 0 for no limit.
+ * @param recommendations Receives the recommendations of every user, in query order.
+ */
+void ConnectionRecommender::recommendBatch(const NetworkSnapshot& graph, ThreadPool& pool, const std::vector<int>& users, int k,
+                                           RecommendationScore score, int max_fanout,
+                                           std::vector<std::vector<Recommendation>>& recommendations) {
+    recommendations.assign(users.size(), std::vector<Recommendation>());
+    if (scratch.size() < pool.size()) {
+        scratch.resize(pool.size());
+    }
+
+    pool.parallelFor(users.size(), 1, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        for (std::size_t position = begin; position < end; position++) {
+            if (users[position] >= 0) {
+                recommendOne(graph, users[position], k, score, max_fanout, scratch[worker], recommendations[position]);
+            }
+        }
+    });
+}
+
+
+/**
+ * @brief Recommend connections for one user with a given scratch state.
+ * @param graph The snapshot to query.
+ * @param user The dense index of the user.
+ * @param k The maximum number of recommendations.
+ * @param score How candidates are scored.
+ * @param max_fanout Neighbors with more connections than this are not walked through, 0 for no limit.
+ * @param state The scratch state of the calling worker.
+ * @param recommendations Receives the recommendations as dense indices, best first.
+ */
+void ConnectionRecommender::recommendOne(const NetworkSnapshot& graph, int user, int k, RecommendationScore score, int max_fanout,
+                                         Scratch& state, std::vector<Recommendation>& recommendations) {
+    recommendations.clear();
+    if (k <= 0) {
+        return;
+    }
+
+    const std::size_t numUsers = static_cast<std::size_t>(graph.numberOfUsers());
+    if (state.mutual.size() != numUsers) {
+        state.mutual.assign(numUsers, 0);
+        state.weight.assign(numUsers, 0.0);
+    }
+    const bool adamicAdar = score == RecommendationScore::AdamicAdar;
+
+    // The user and its neighbors are never candidates
+    const int* userBegin = graph.neighborsBegin(user);
+    const int* userEnd = graph.neighborsEnd(user);
+    state.mutual[user] = -1;
+    for (const int* neighbor = userBegin; neighbor != userEnd; ++neighbor) {
+        state.mutual[*neighbor] = -1;
+    }
+
+    // Count the mutual connections of everyone two hops away
+    for (const int* neighbor = userBegin; neighbor != userEnd; ++neighbor) {
+        const int degree = graph.degree(*neighbor);
+        if (max_fanout > 0 && degree > max_fanout) {
+            continue;
+        }
+        // A neighbor with one connection only leads back to the user, so the log is never 0
+        const double weight = adamicAdar && degree > 1 ? 1.0 / std::log(static_cast<double>(degree)) : 0.0;
+        for (const int* candidate = graph.neighborsBegin(*neighbor); candidate != graph.neighborsEnd(*neighbor); ++candidate) {
+            int& count = state.mutual[*candidate];
+            if (count < 0) {
+                continue;
+            }
+            if (count == 0) {
+                state.touched.push_back(*candidate);
+            }
+            count++;
+            if (adamicAdar) {
+                state.weight[*candidate] += weight;
+            }
+        }
+    }
+
+    // Keep the best k candidates in a heap with the worst on top
+    const int userDegree = graph.degree(user);
+    for (int candidate : state.touched) {
+        Recommendation next;
+        next.user = candidate;
+        next.mutual = state.mutual[candidate];
+        switch (score) {
+            case RecommendationScore::CommonNeighbors:
+                next.score = next.mutual;
+                break;
+            case RecommendationScore::AdamicAdar:
+                next.score = state.weight[candidate];
+                break;
+            case RecommendationScore::Jaccard:
+                next.score = static_cast<double>(next.mutual) / (userDegree + graph.degree(candidate) - next.mutual);
+                break;
+        }
+
+        if (static_cast<int>(recommendations.size()) < k) {
+            recommendations.push_back(next);
+            std::push_heap(recommendations.begin(), recommendations.end(), better);
+        }
+        else if (better(next, recommendations.front())) {
+            std::pop_heap(recommendations.begin(), recommendations.end(), better);
+            recommendations.back() = next;
+            std::push_heap(recommendations.begin(), recommendations.end(), better);
+        }
+    }
+    std::sort_heap(recommendations.begin(), recommendations.end(), better);
+
+    // Leave the counters clear for the next query
+    for (int candidate : state.touched) {
+        state.mutual[candidate] = 0;
+        state.weight[candidate] = 0.0;
+    }
+    state.touched.clear();
+    state.mutual[user] = 0;
+    for (const int* neighbor = userBegin; neighbor != userEnd; ++neighbor) {
+        state.mutual[*neighbor] = 0;
+    }
+}
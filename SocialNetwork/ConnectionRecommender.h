@@ -0,0 +1,101 @@
+#ifndef CONNECTIONRECOMMENDER_H
+#define CONNECTIONRECOMMENDER_H
+
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+#include "UserId.h"
+
+
+/**
+ * @enum RecommendationScore
+ * @brief How a candidate two hops away from a user is scored.
+ */
+enum class RecommendationScore {
+    CommonNeighbors,  // The number of mutual connections.
+    AdamicAdar,  // The sum of 1 / log(degree) over the mutual connections, so mutual hubs count less.
+    Jaccard  // The mutual connections divided by the union of both users' connections.
+};
+
+
+/**
+ * @struct Recommendation
+ * @brief A user recommended as a new connection.
+ */
+struct Recommendation {
+    UserId user;  // The recommended user, a dense index or a user ID depending on the caller.
+    int mutual;  // The number of mutual connections found.
+    double score;  // The score of the recommendation, higher is better.
+};
+
+
+/**
+ * @class ConnectionRecommender
+ * @brief Recommends the users two hops away that share the most connections with a user.
+ *
+ * The connections of every neighbor of the user are walked once and accumulated in dense per-worker counters
+ * indexed by the snapshot, and the best k candidates are kept in a bounded heap. Neighbors with more than a
+ * fan-out cap of connections are skipped as intermediaries, which bounds the work through hubs; the mutual counts
+ * then only cover the remaining neighbors.
+ */
+class ConnectionRecommender {
+public:
+    /**
+     * @brief Construct a new Connection Recommender object.
+     */
+    ConnectionRecommender();
+
+    /**
+     * @brief Recommend connections for one user.
+     * @param graph The snapshot to query.
+     * @param user The dense index of the user.
+     * @param k The maximum number of recommendations.
+     * @param score How candidates are scored.
+     * @param max_fanout Neighbors with more connections than this are not walked through, 0 for no limit.
+     * @param recommendations Receives the recommendations as dense indices, best first. Equal scores are ordered
+     *                        by ascending index.
+     */
+    void recommend(const NetworkSnapshot& graph, int user, int k, RecommendationScore score, int max_fanout,
+                   std::vector<Recommendation>& recommendations);
+
+    /**
+     * @brief Recommend connections for many users in parallel.
+     * @param graph The snapshot to query.
+     * @param pool The thread pool to run the queries on.
+     * @param users Dense indices of the users. A negative index gets no recommendations.
+     * @param k The maximum number of recommendations per user.
+     * @param score How candidates are scored.
+     * @param max_fanout Neighbors with more connections than this are not walked through, 0 for no limit.
+     * @param recommendations Receives the recommendations of every user, in query order.
+     */
+    void recommendBatch(const NetworkSnapshot& graph, ThreadPool& pool, const std::vector<int>& users, int k,
+                        RecommendationScore score, int max_fanout, std::vector<std::vector<Recommendation>>& recommendations);
+
+private:
+    /**
+     * @struct Scratch
+     * @brief Per-worker state, reused between queries.
+     */
+    struct Scratch {
+        std::vector<int> mutual;  // Mutual connections of every candidate, -1 for the user and its neighbors.
+        std::vector<double> weight;  // Adamic-Adar sums of every candidate.
+        std::vector<int> touched;  // Candidates with a nonzero count, to be reset after the query.
+    };
+
+    std::vector<Scratch> scratch;  // One scratch state per worker.
+
+    /**
+     * @brief Recommend connections for one user with a given scratch state.
+     * @param graph The snapshot to query.
+     * @param user The dense index of the user.
+     * @param k The maximum number of recommendations.
+     * @param score How candidates are scored.
+     * @param max_fanout Neighbors with more connections than this are not walked through, 0 for no limit.
+     * @param state The scratch state of the calling worker.
+     * @param recommendations Receives the recommendations as dense indices, best first.
+     */
+    static void recommendOne(const NetworkSnapshot& graph, int user, int k, RecommendationScore score, int max_fanout,
+                             Scratch& state, std::vector<Recommendation>& recommendations);
+};
+
+#endif // CONNECTIONRECOMMENDER_H
@@ -0,0 +1,146 @@
+#include "DeltaVarint.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define DELTA_VARINT_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace {
+    const std::uint32_t kLengthMasks[4] = { 0xFFu, 0xFFFFu, 0xFFFFFFu, 0xFFFFFFFFu };  // The bytes of each code.
+
+    /**
+     * @brief Get the code of the number of bytes a gap takes.
+     * @param gap The gap.
+     * @return The number of bytes minus one.
+     */
+    unsigned lengthCode(std::uint32_t gap) {
+        return gap < (1u << 8) ? 0 : gap < (1u << 16) ? 1 : gap < (1u << 24) ? 2 : 3;
+    }
+
+#ifdef DELTA_VARINT_SSSE3
+    /**
+     * @struct ShuffleTable
+     * @brief For every control byte, the shuffle that spreads its four gaps over 32-bit lanes, and their length.
+     */
+    struct ShuffleTable {
+        unsigned char masks[256][16];  // Source byte of every output byte, 0x80 for zero.
+        unsigned char lengths[256];  // The number of data bytes of the four gaps.
+
+        /**
+         * @brief Construct the Shuffle Table object.
+         */
+        ShuffleTable() {
+            for (int control = 0; control < 256; control++) {
+                int source = 0;
+                for (int lane = 0; lane < 4; lane++) {
+                    int bytes = ((control >> (2 * lane)) & 3) + 1;
+                    for (int byte = 0; byte < 4; byte++) {
+                        masks[control][4 * lane + byte] = static_cast<unsigned char>(byte < bytes ? source + byte : 0x80);
+                    }
+                    source += bytes;
+                }
+                lengths[control] = static_cast<unsigned char>(source);
+            }
+        }
+    };
+
+    const ShuffleTable kShuffles;  // Built once at startup.
+#endif
+}
+
+/**
+ * @brief Get the largest number of bytes an array can encode to.
+ * @param count The number of values.
+ * @return The number of bytes, not counting the padding.
+ */
+std::size_t deltaVarintBound(std::size_t count) {
+    return (count + 3) / 4 + 4 * count;
+}
+
+
+/**
+ * @brief Get the number of bytes an array encodes to.
+ * @param values The sorted values.
+ * @param count The number of values.
+ * @param base A value below values[0], which the first gap is taken from.
+ * @return The number of bytes encodeDeltaVarint() writes.
+ */
+std::size_t deltaVarintSize(const int* values, std::size_t count, int base) {
+    std::size_t bytes = (count + 3) / 4;
+    for (std::size_t position = 0; position < count; position++) {
+        bytes += lengthCode(static_cast<std::uint32_t>(values[position] - base)) + 1;
+        base = values[position];
+    }
+    return bytes;
+}
+
+
+/**
+ * @brief Encode a sorted array as control bytes followed by the bytes of the gaps.
+ * @param values The sorted values.
+ * @param count The number of values.
+ * @param base A value below values[0], which the first gap is taken from.
+ * @param out Receives the encoded bytes, room for deltaVarintBound(count) bytes.
+ * @return The number of bytes written.
+ */
+std::size_t encodeDeltaVarint(const int* values, std::size_t count, int base, unsigned char* out) {
+    const std::size_t controlBytes = (count + 3) / 4;
+    std::memset(out, 0, controlBytes);
+    unsigned char* data = out + controlBytes;
+    for (std::size_t position = 0; position < count; position++) {
+        std::uint32_t gap = static_cast<std::uint32_t>(values[position] - base);
+        base = values[position];
+        unsigned code = lengthCode(gap);
+        out[position / 4] |= static_cast<unsigned char>(code << (2 * (position % 4)));
+        for (unsigned byte = 0; byte <= code; byte++) {
+            *data++ = static_cast<unsigned char>(gap >> (8 * byte));
+        }
+    }
+    return static_cast<std::size_t>(data - out);
+}
+
+
+/**
+ * @brief Decode an array written by encodeDeltaVarint().
+ * @param in The encoded bytes, followed by at least kDeltaVarintPadding readable bytes.
+ * @param count The number of values.
+ * @param base The base the array was encoded with.
+ * @param out Receives the values, room for count values.
+ * @return The end of the encoded bytes.
+ */
+const unsigned char* decodeDeltaVarint(const unsigned char* in, std::size_t count, int base, int* out) {
+    const unsigned char* data = in + (count + 3) / 4;
+    std::size_t position = 0;
+
+#ifdef DELTA_VARINT_SSSE3
+    // Four gaps per control byte: shuffle them into lanes, then add up the lanes and the previous value
+    __m128i previous = _mm_set1_epi32(base);
+    for (; position + 4 <= count; position += 4) {
+        unsigned bits = in[position / 4];
+        __m128i gaps = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(kShuffles.masks[bits])));
+        data += kShuffles.lengths[bits];
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 4));
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 8));
+        previous = _mm_add_epi32(gaps, previous);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + position), previous);
+        previous = _mm_shuffle_epi32(previous, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    if (position > 0) {
+        base = out[position - 1];
+    }
+#endif
+
+    // One gap at a time, read with a 4-byte load that the padding keeps in bounds
+    for (; position < count; position++) {
+        unsigned code = (in[position / 4] >> (2 * (position % 4))) & 3;
+        std::uint32_t gap;
+        std::memcpy(&gap, data, sizeof(gap));
+        data += code + 1;
+        base += static_cast<int>(gap & kLengthMasks[code]);
+        out[position] = base;
+    }
+    return data;
+}
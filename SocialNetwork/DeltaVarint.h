@@ -0,0 +1,56 @@
+#ifndef DELTAVARINT_H
+#define DELTAVARINT_H
+
+#include <cstddef>
+
+
+/**
+ * Kernels that compress sorted arrays of distinct non-negative integers, such as neighbor lists, by storing the
+ * gaps between consecutive values with the Stream VByte layout of Lemire et al. Every gap takes 1 to 4 bytes, and
+ * its length is a 2-bit code; the codes of four gaps share a control byte. All control bytes come first, followed
+ * by the data bytes, so a decoder reads one control byte and then finds four gaps at known byte positions.
+ *
+ * With SSSE3 a group of four gaps is decoded by one byte shuffle picked by the control byte, and the gaps are
+ * turned back into values with an SSE2 prefix sum. Without it the gaps are read with one unaligned load and a
+ * mask each. Encoded data is little-endian.
+ */
+
+const std::size_t kDeltaVarintPadding = 16;  // Readable bytes a decoder needs after the end of encoded data.
+
+/**
+ * @brief Get the largest number of bytes an array can encode to.
+ * @param count The number of values.
+ * @return The number of bytes, not counting the padding.
+ */
+std::size_t deltaVarintBound(std::size_t count);
+
+/**
+ * @brief Get the number of bytes an array encodes to.
+ * @param values The sorted values.
+ * @param count The number of values.
+ * @param base A value below values[0], which the first gap is taken from.
+ * @return The number of bytes encodeDeltaVarint() writes.
+ */
+std::size_t deltaVarintSize(const int* values, std::size_t count, int base);
+
+/**
+ * @brief Encode a sorted array as control bytes followed by the bytes of the gaps.
+ * @param values The sorted values.
+ * @param count The number of values.
+ * @param base A value below values[0], which the first gap is taken from.
+ * @param out Receives the encoded bytes, room for deltaVarintBound(count) bytes.
+ * @return The number of bytes written.
+ */
+std::size_t encodeDeltaVarint(const int* values, std::size_t count, int base, unsigned char* out);
+
+/**
+ * @brief Decode an array written by encodeDeltaVarint().
+ * @param in The encoded bytes, followed by at least kDeltaVarintPadding readable bytes.
+ * @param count The number of values.
+ * @param base The base the array was encoded with.
+ * @param out Receives the values, room for count values.
+ * @return The end of the encoded bytes.
+ */
+const unsigned char* decodeDeltaVarint(const unsigned char* in, std::size_t count, int base, int* out);
+
+#endif // DELTAVARINT_H
@@ -0,0 +1,192 @@
+#include "DistanceOracle.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include "BreadthFirstSearch.h"
+
+namespace {
+    /**
+     * @brief Choose the landmarks of a snapshot.
+     * @param graph The snapshot.
+     * @param count The number of landmarks.
+     * @param selection How the landmarks are chosen.
+     * @param seed The seed of a random selection.
+     * @return The dense indices of the landmarks.
+     */
+    std::vector<int> chooseLandmarks(const NetworkSnapshot& graph, int count, LandmarkSelection selection, std::uint64_t seed) {
+        const int users = graph.numberOfUsers();
+        count = std::max(0, std::min(count, users));
+        std::vector<int> chosen;
+
+        if (selection == LandmarkSelection::HighestDegree) {
+            // Keep the count best users in a heap with the weakest on top, ties broken by index
+            auto stronger = [&graph](int a, int b) {
+                return graph.degree(a) != graph.degree(b) ? graph.degree(a) > graph.degree(b) : a < b;
+            };
+            for (int index = 0; index < users; index++) {
+                if (static_cast<int>(chosen.size()) < count) {
+                    chosen.push_back(index);
+                    std::push_heap(chosen.begin(), chosen.end(), stronger);
+                }
+                else if (count > 0 && stronger(index, chosen.front())) {
+                    std::pop_heap(chosen.begin(), chosen.end(), stronger);
+                    chosen.back() = index;
+                    std::push_heap(chosen.begin(), chosen.end(), stronger);
+                }
+            }
+            std::sort_heap(chosen.begin(), chosen.end(), stronger);
+            return chosen;
+        }
+
+        // Draw distinct users, few enough that rejection is cheap
+        std::mt19937_64 random(seed);
+        std::vector<char> taken(static_cast<std::size_t>(users), 0);
+        while (static_cast<int>(chosen.size()) < count) {
+            int index = static_cast<int>(random() % static_cast<std::uint64_t>(users));
+            if (!taken[index]) {
+                taken[index] = 1;
+                chosen.push_back(index);
+            }
+        }
+        return chosen;
+    }
+}
+
+/**
+ * @brief Default constructor for DistanceOracle class.
+ * The oracle is filled in by build().
+ */
+DistanceOracle::DistanceOracle() : selection(LandmarkSelection::HighestDegree), seed(0) {}
+
+
+/**
+ * @brief Build an oracle for a snapshot.
+ * @param graph The snapshot to build the oracle for.
+ * @param landmarks The number of landmarks, at most the number of users.
+ * @param selection How the landmarks are chosen.
+ * @param seed The seed of a random selection.
+ * @param pool The thread pool to search on, or nullptr.
+ * @return The oracle.
+ */
+std::shared_ptr<const DistanceOracle> DistanceOracle::build(std::shared_ptr<const NetworkSnapshot> graph, int landmarks,
+                                                            LandmarkSelection selection, std::uint64_t seed, ThreadPool* pool) {
+    std::shared_ptr<DistanceOracle> oracle(new DistanceOracle());
+    oracle->graph = graph;
+    oracle->selection = selection;
+    oracle->seed = seed;
+    oracle->landmark_indices = chooseLandmarks(*graph, landmarks, selection, seed);
+
+    const std::size_t users = static_cast<std::size_t>(graph->numberOfUsers());
+    const std::size_t count = oracle->landmark_indices.size();
+    const unsigned workers = pool != nullptr ? pool->size() : 1;
+
+    // Search from every landmark, writing one contiguous column per landmark
+    std::vector<std::uint16_t> columns(count * users);
+    std::vector<BreadthFirstSearch> engines(workers);
+    std::vector<BfsResult> results(workers);
+    auto searchLandmarks = [&](unsigned worker, std::size_t begin, std::size_t end) {
+        for (std::size_t landmark = begin; landmark < end; landmark++) {
+            BfsResult& result = results[worker];
+            engines[worker].run(*graph, oracle->landmark_indices[landmark], false, result);
+            std::uint16_t* column = columns.data() + landmark * users;
+            for (std::size_t user = 0; user < users; user++) {
+                int level = result.level[user];
+                if (level == -1) {
+                    column[user] = kUnreachable;
+                }
+                else {
+                    column[user] = static_cast<std::uint16_t>(std::min<int>(level, kTooFar));
+                }
+            }
+        }
+    };
+
+    // Transpose so the distances of one user are contiguous
+    oracle->distances.resize(count * users);
+    std::uint16_t* rows = oracle->distances.data();
+    auto transpose = [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t user = begin; user < end; user++) {
+            for (std::size_t landmark = 0; landmark < count; landmark++) {
+                rows[user * count + landmark] = columns[landmark * users + user];
+            }
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->parallelFor(count, 1, searchLandmarks);
+        pool->parallelFor(users, 1 << 12, transpose);
+    }
+    else {
+        searchLandmarks(0, 0, count);
+        transpose(0, 0, users);
+    }
+    return oracle;
+}
+
+
+/**
+ * @brief Build an oracle with the same settings for a newer snapshot.
+ * @param graph The newer snapshot.
+ * @param pool The thread pool to search on, or nullptr.
+ * @return The new oracle.
+ */
+std::shared_ptr<const DistanceOracle> DistanceOracle::rebuild(std::shared_ptr<const NetworkSnapshot> graph, ThreadPool* pool) const {
+    return build(graph, static_cast<int>(landmark_indices.size()), selection, seed, pool);
+}
+
+
+/**
+ * @brief Bound the distance between two users with the triangle inequality over all landmarks.
+ * @param index1 The dense index of the first user in snapshot().
+ * @param index2 The dense index of the second user in snapshot().
+ * @return The distance bounds.
+ */
+DistanceEstimate DistanceOracle::estimate(int index1, int index2) const {
+    if (index1 == index2) {
+        return DistanceEstimate{ 0, 0, true };
+    }
+
+    const std::size_t count = landmark_indices.size();
+    const std::uint16_t* row1 = distances.data() + static_cast<std::size_t>(index1) * count;
+    const std::uint16_t* row2 = distances.data() + static_cast<std::size_t>(index2) * count;
+    DistanceEstimate estimate{ 1, -1, false };
+    for (std::size_t landmark = 0; landmark < count; landmark++) {
+        int distance1 = row1[landmark];
+        int distance2 = row2[landmark];
+        if (distance1 == kTooFar || distance2 == kTooFar) {
+            continue;
+        }
+        if ((distance1 == kUnreachable) != (distance2 == kUnreachable)) {
+            // The landmark's component holds exactly one of the users
+            return DistanceEstimate{ -1, -1, true };
+        }
+        if (distance1 == kUnreachable) {
+            continue;
+        }
+        if (estimate.upper == -1 || distance1 + distance2 < estimate.upper) {
+            estimate.upper = distance1 + distance2;
+        }
+        estimate.lower = std::max(estimate.lower, std::abs(distance1 - distance2));
+    }
+    estimate.exact = estimate.lower == estimate.upper;
+    return estimate;
+}
+
+
+/**
+ * @brief Get the snapshot the oracle describes.
+ * @return The snapshot the oracle was built from.
+ */
+const std::shared_ptr<const NetworkSnapshot>& DistanceOracle::snapshot() const {
+    return graph;
+}
+
+
+/**
+ * @brief Get the landmarks.
+ * @return The dense indices of the landmarks in snapshot().
+ */
+const std::vector<int>& DistanceOracle::landmarks() const {
+    return landmark_indices;
+}
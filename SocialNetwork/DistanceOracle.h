@@ -0,0 +1,105 @@
+#ifndef DISTANCEORACLE_H
+#define DISTANCEORACLE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+
+
+/**
+ * @enum LandmarkSelection
+ * @brief How the landmarks of a distance oracle are chosen.
+ */
+enum class LandmarkSelection {
+    HighestDegree,  // The users with the most connections, which lie on many shortest paths.
+    Random  // Users drawn uniformly from a seed.
+};
+
+
+/**
+ * @struct DistanceEstimate
+ * @brief Bounds on the distance between two users.
+ */
+struct DistanceEstimate {
+    int lower;  // A lower bound on the distance, -1 if the users are not connected.
+    int upper;  // An upper bound on the distance, -1 if unknown or the users are not connected.
+    bool exact;  // true if lower == upper is the distance, or the users are known not to be connected.
+};
+
+
+/**
+ * @class DistanceOracle
+ * @brief Estimates distances from precomputed breadth-first searches of a few landmark users.
+ *
+ * For every landmark L, the distance d(L, u) of every user u is stored, user by user, so an estimate reads two
+ * short contiguous rows. By the triangle inequality |d(L, a) - d(L, b)| <= d(a, b) <= d(L, a) + d(L, b) for every
+ * landmark, and the tightest bounds over all landmarks are returned. A landmark that reaches exactly one of the
+ * two users proves they are not connected.
+ *
+ * An oracle is immutable and describes the snapshot it was built from.
+ */
+class DistanceOracle {
+public:
+    /**
+     * @brief Build an oracle for a snapshot.
+     *
+     * The landmark searches run in parallel on the pool, or one after the other on the calling thread without one.
+     * @param graph The snapshot to build the oracle for.
+     * @param landmarks The number of landmarks, at most the number of users.
+     * @param selection How the landmarks are chosen.
+     * @param seed The seed of a random selection.
+     * @param pool The thread pool to search on, or nullptr.
+     * @return The oracle.
+     */
+    static std::shared_ptr<const DistanceOracle> build(std::shared_ptr<const NetworkSnapshot> graph, int landmarks,
+                                                       LandmarkSelection selection, std::uint64_t seed, ThreadPool* pool);
+
+    /**
+     * @brief Build an oracle with the same settings for a newer snapshot.
+     * @param graph The newer snapshot.
+     * @param pool The thread pool to search on, or nullptr.
+     * @return The new oracle.
+     */
+    std::shared_ptr<const DistanceOracle> rebuild(std::shared_ptr<const NetworkSnapshot> graph, ThreadPool* pool) const;
+
+    /**
+     * @brief Bound the distance between two users.
+     * @param index1 The dense index of the first user in snapshot().
+     * @param index2 The dense index of the second user in snapshot().
+     * @return The distance bounds.
+     */
+    DistanceEstimate estimate(int index1, int index2) const;
+
+    /**
+     * @brief Get the snapshot the oracle describes.
+     * @return The snapshot the oracle was built from.
+     */
+    const std::shared_ptr<const NetworkSnapshot>& snapshot() const;
+
+    /**
+     * @brief Get the landmarks.
+     * @return The dense indices of the landmarks in snapshot().
+     */
+    const std::vector<int>& landmarks() const;
+
+private:
+    // Stored for users a landmark does not reach
+    static const std::uint16_t kUnreachable = 0xFFFF;
+    // Stored for distances too long to store, which give no bound
+    static const std::uint16_t kTooFar = 0xFFFE;
+
+    std::shared_ptr<const NetworkSnapshot> graph;  // The snapshot the distances were computed on.
+    std::vector<int> landmark_indices;  // The dense indices of the landmarks.
+    std::vector<std::uint16_t> distances;  // distances[u * landmarks + l] = d(landmark l, user u).
+    LandmarkSelection selection;  // How the landmarks were chosen.
+    std::uint64_t seed;  // The seed of a random selection.
+
+    /**
+     * @brief Construct an empty oracle, filled in by build().
+     */
+    DistanceOracle();
+};
+
+#endif // DISTANCEORACLE_H
@@ -1,24 +1,27 @@
+#include "NetworkPrinter.h"
 #include "SocialNetwork.h"
 #include <iostream>
 
 int main() {
     // Create a SocialNetwork object
     SocialNetwork network;
+    // Console front end that reports the outcome of every operation
+    NetworkPrinter console(network);
 
     int choice;
-    int user_id1, user_id2;
+    UserId user_id1, user_id2;
     for (int i = 1; i < 11; i++) {
-        network.addUser(i);
+        console.addUser(i);
     }
-    network.addConnection(1, 2);
-    network.addConnection(1, 3);
-    network.addConnection(1, 4);
-    network.addConnection(2, 5);
-    network.addConnection(3, 6);
-    network.addConnection(4, 7);
-    network.addConnection(4, 8);
-    network.addConnection(5, 9);
-    network.addConnection(6, 10);
+    console.addConnection(1, 2);
+    console.addConnection(1, 3);
+    console.addConnection(1, 4);
+    console.addConnection(2, 5);
+    console.addConnection(3, 6);
+    console.addConnection(4, 7);
+    console.addConnection(4, 8);
+    console.addConnection(5, 9);
+    console.addConnection(6, 10);
     /*
     Here is an example graph you can start with:
 
@@ -60,14 +63,14 @@ int main() {
         case 1: {
             std::cout << "Enter user ID to add: ";
             std::cin >> user_id1;
-            network.addUser(user_id1);
+            console.addUser(user_id1);
             break;
         }
         case 2: {
             if (!network.isEmpty()) {
                 std::cout << "Enter user ID to remove: ";
                 std::cin >> user_id1;
-                network.removeUser(user_id1);
+                console.removeUser(user_id1);
             }
             else {
                 std::cout << "Network is empty." << std::endl;
@@ -79,7 +82,7 @@ int main() {
             std::cin >> user_id1;
             std::cout << "Enter Second's user ID: ";
             std::cin >> user_id2;
-            network.addConnection(user_id1, user_id2);
+            console.addConnection(user_id1, user_id2);
             break;
         }
         case 4: {
@@ -88,7 +91,7 @@ int main() {
                 std::cin >> user_id1;
                 std::cout << "Enter Second's user ID: ";
                 std::cin >> user_id2;
-                network.removeConnection(user_id1, user_id2);
+                console.removeConnection(user_id1, user_id2);
             }
             else {
                 std::cout << "Network is empty." << std::endl;
@@ -101,7 +104,7 @@ int main() {
                 std::cin >> user_id1;
                 std::cout << "Enter Second's user ID: ";
                 std::cin >> user_id2;
-                int shortestPath = network.findShortestPath(user_id1, user_id2);
+                int shortestPath = console.findShortestPath(user_id1, user_id2);
                 if (shortestPath != -1) {
                     std::cout << "Shortest path length: " << shortestPath << std::endl;
                 }
@@ -115,7 +118,7 @@ int main() {
             if (!network.isEmpty()) {
                 std::cout << "Enter user ID to start BFS traversal: ";
                 std::cin >> user_id1;
-                network.BFS(user_id1);
+                console.BFS(user_id1);
             }
             else {
                 std::cout << "Network is empty." << std::endl;
@@ -126,7 +129,7 @@ int main() {
             if (!network.isEmpty()) {
                 std::cout << "Enter user ID to start DFS traversal: ";
                 std::cin >> user_id1;
-                network.DFS(user_id1);
+                console.DFS(user_id1);
             }
             else {
                 std::cout << "Network is empty." << std::endl;
@@ -138,7 +141,7 @@ int main() {
                 std::cout << "Network is empty." << std::endl;
             }
             else {
-                network.printNetwork();
+                console.printNetwork();
             }
             break;
         }
@@ -176,12 +179,7 @@ int main() {
                 std::cout << "Enter Second's user ID: ";
                 std::cin >> user_id2;
 
-                if (network.isConnected(user_id1, user_id2)) {
-                    std::cout << "Users " << user_id1 << " and " << user_id2 << " are connected." << std::endl;
-                }
-                else {
-                    std::cout << "Users " << user_id1 << " and " << user_id2 << " are not connected." << std::endl;
-                }
+                console.isConnected(user_id1, user_id2);
             }
             else {
                 std::cout << "Network is empty." << std::endl;
@@ -195,7 +193,7 @@ int main() {
                 char confirm;
                 std::cin >> confirm;
                 if (confirm == 'y' || confirm == 'Y') {
-                    network.clearNetwork();
+                    console.clearNetwork();
                 }
                 else {
                     std::cout << "Network was not cleared." << std::endl;
@@ -0,0 +1,128 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Default constructor for MappedFile class.
+ * Nothing is mapped until open is called.
+ */
+MappedFile::MappedFile() : bytes(nullptr), length(0)
+#ifdef _WIN32
+    , file_handle(nullptr), mapping_handle(nullptr)
+#endif
+{}
+
+
+/**
+ * @brief Destructor for MappedFile class.
+ * Calls close to unmap the file.
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+
+/**
+ * @brief Map a file, replacing any previous mapping.
+ * @param path The path of the file.
+ * @return true if the file was mapped, false otherwise.
+ */
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    // Sharing delete access lets a newer snapshot replace the file while it is mapped
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    mapping_handle = mapping;
+    bytes = static_cast<const unsigned char*>(view);
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor == -1) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        ::close(descriptor);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+    // The mapping stays valid after the descriptor is closed
+    ::close(descriptor);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    bytes = static_cast<const unsigned char*>(view);
+    length = static_cast<std::size_t>(status.st_size);
+#endif
+    return true;
+}
+
+
+/**
+ * @brief Unmap the file.
+ */
+void MappedFile::close() {
+    if (bytes == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+    CloseHandle(static_cast<HANDLE>(file_handle));
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+
+/**
+ * @brief Get the first byte of the mapping.
+ * @return A pointer to the mapped bytes, or nullptr if nothing is mapped.
+ */
+const unsigned char* MappedFile::data() const {
+    return bytes;
+}
+
+
+/**
+ * @brief Get the size of the mapping.
+ * @return The number of mapped bytes.
+ */
+std::size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,62 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+
+/**
+ * @class MappedFile
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * The mapping is shared, so processes that map the same file share its pages in the page cache.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Construct a Mapped File object that maps nothing.
+     */
+    MappedFile();
+
+    /**
+     * @brief Unmap the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, replacing any previous mapping.
+     * @param path The path of the file.
+     * @return true if the file was mapped, false otherwise.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the file.
+     */
+    void close();
+
+    /**
+     * @brief Get the first byte of the mapping.
+     * @return A pointer to the mapped bytes, or nullptr if nothing is mapped.
+     */
+    const unsigned char* data() const;
+
+    /**
+     * @brief Get the size of the mapping.
+     * @return The number of mapped bytes.
+     */
+    std::size_t size() const;
+
+private:
+    const unsigned char* bytes;  // The mapped bytes.
+    std::size_t length;  // The number of mapped bytes.
+#ifdef _WIN32
+    void* file_handle;  // The handle of the open file.
+    void* mapping_handle;  // The handle of the file mapping.
+#endif
+};
+
+#endif // MAPPEDFILE_H
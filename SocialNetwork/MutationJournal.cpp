@@ -0,0 +1,525 @@
+#include "MutationJournal.h"
+#include "MappedFile.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const std::uint64_t kMagic = 0x4C4E524A4B52544EULL;  // "NTRKJRNL" read as a little-endian word
+    const std::uint32_t kByteOrderMark = 0x01020304;
+    const std::uint32_t kVersion = 1;
+    const std::size_t kFileHeaderSize = 16;
+    const std::size_t kGroupHeaderSize = 16;
+    // An operation byte and two 10-byte varints
+    const std::size_t kMaxRecordSize = 21;
+
+    /**
+     * @struct FileHeader
+     * @brief The header at the start of a journal file.
+     */
+    struct FileHeader {
+        std::uint64_t magic;  // Identifies a journal file.
+        std::uint32_t byte_order;  // kByteOrderMark as written by the writing machine.
+        std::uint32_t version;  // Format version.
+    };
+
+    /**
+     * @struct GroupHeader
+     * @brief The header in front of every group of records.
+     */
+    struct GroupHeader {
+        std::uint32_t payload_size;  // Size of the records, padded to a multiple of 4 bytes.
+        std::uint32_t record_count;  // Number of records in the group.
+        std::uint64_t checksum;  // Checksum of the two fields above and the payload.
+    };
+
+    /**
+     * @struct GroupLocation
+     * @brief Where a group was found while opening a journal.
+     */
+    struct GroupLocation {
+        std::uint64_t offset;  // Offset of the group header in the file.
+        std::size_t first_record;  // Index of the group's first record among all records of the file.
+    };
+
+    static_assert(sizeof(FileHeader) == kFileHeaderSize, "unexpected journal header layout");
+    static_assert(sizeof(GroupHeader) == kGroupHeaderSize, "unexpected group header layout");
+
+    /**
+     * @brief Compute a Fletcher-style checksum of a group, over 32-bit words.
+     * @param header The group header, its checksum field is ignored.
+     * @param payload The padded records of the group.
+     * @return The checksum of the group.
+     */
+    std::uint64_t groupChecksum(const GroupHeader& header, const unsigned char* payload) {
+        std::uint64_t sum1 = header.payload_size;
+        std::uint64_t sum2 = sum1;
+        sum1 += header.record_count;
+        sum2 += sum1;
+        for (std::size_t position = 0; position < header.payload_size; position += 4) {
+            std::uint32_t word;
+            std::memcpy(&word, payload + position, 4);
+            sum1 += word;
+            sum2 += sum1;
+        }
+        return (sum2 << 32) ^ sum1;
+    }
+
+    /**
+     * @brief Append a user ID as a zigzag varint, so small IDs of either sign take few bytes.
+     * @param user_id The user ID.
+     * @param out The buffer to append to.
+     */
+    void putVarint(UserId user_id, std::vector<unsigned char>& out) {
+        std::uint64_t value = (static_cast<std::uint64_t>(user_id) << 1) ^ static_cast<std::uint64_t>(user_id >> 63);
+        while (value >= 0x80) {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    /**
+     * @brief Read a user ID written by putVarint.
+     * @param cursor The position to read at, advanced past the varint.
+     * @param end The end of the readable bytes.
+     * @param user_id Receives the user ID.
+     * @return true if a complete varint was read, false otherwise.
+     */
+    bool getVarint(const unsigned char*& cursor, const unsigned char* end, UserId& user_id) {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+            unsigned char byte = *cursor++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                user_id = static_cast<UserId>((value >> 1) ^ (0 - (value & 1)));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Decode the records of a group.
+     * @param header The group header.
+     * @param payload The padded records of the group.
+     * @param out Receives header.record_count records.
+     * @return true if every record was decoded, false if the group is malformed.
+     */
+    bool decodeGroup(const GroupHeader& header, const unsigned char* payload, JournalRecord* out) {
+        const unsigned char* cursor = payload;
+        const unsigned char* end = payload + header.payload_size;
+        for (std::uint32_t record = 0; record < header.record_count; record++) {
+            if (cursor == end) {
+                return false;
+            }
+            unsigned char operation = *cursor++;
+            out[record].user_id1 = 0;
+            out[record].user_id2 = 0;
+            switch (static_cast<JournalOperation>(operation)) {
+            case JournalOperation::AddUser:
+            case JournalOperation::RemoveUser:
+                if (!getVarint(cursor, end, out[record].user_id1)) {
+                    return false;
+                }
+                break;
+            case JournalOperation::AddConnection:
+            case JournalOperation::RemoveConnection:
+            case JournalOperation::LoadConnection:
+                if (!getVarint(cursor, end, out[record].user_id1) || !getVarint(cursor, end, out[record].user_id2)) {
+                    return false;
+                }
+                break;
+            case JournalOperation::Clear:
+                break;
+            default:
+                return false;
+            }
+            out[record].operation = static_cast<JournalOperation>(operation);
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Default constructor for MutationJournal class.
+ * The journal writes nothing until open is called.
+ */
+MutationJournal::MutationJournal() : buffer(kGroupHeaderSize), buffered_records(0), unsynced_groups(0), file_size(0)
+#ifdef _WIN32
+    , file_handle(nullptr)
+#else
+    , descriptor(-1)
+#endif
+{}
+
+
+/**
+ * @brief Destructor for MutationJournal class.
+ * Calls close to write the buffered records and flush the file.
+ */
+MutationJournal::~MutationJournal() {
+    close();
+}
+
+
+/**
+ * @brief Open a journal file for appending, creating it if needed, and read the records it already holds.
+ * @param path The path of the file.
+ * @param options When to write, flush and compact.
+ * @param pool The thread pool to decode on.
+ * @param records Receives the records of the file, in order.
+ * @return true if the file was opened, false if it could not be created or is not a journal.
+ */
+bool MutationJournal::open(const std::string& path, const JournalOptions& options, ThreadPool& pool,
+                           std::vector<JournalRecord>& records) {
+    close();
+    this->options = options;
+    records.clear();
+
+    // Read the existing groups from a mapping, a missing file or a header torn on creation is a new journal
+    std::uint64_t valid_size = 0;
+    MappedFile mapping;
+    if (mapping.open(path) && mapping.size() >= kFileHeaderSize) {
+        const unsigned char* data = mapping.data();
+        FileHeader header;
+        std::memcpy(&header, data, kFileHeaderSize);
+        if (header.magic != kMagic || header.byte_order != kByteOrderMark || header.version != kVersion) {
+            return false;
+        }
+
+        // The group headers chain the groups, so locating them is a cheap sequential pass
+        std::vector<GroupLocation> groups;
+        std::size_t num_records = 0;
+        std::uint64_t position = kFileHeaderSize;
+        while (position + kGroupHeaderSize <= mapping.size()) {
+            GroupHeader group;
+            std::memcpy(&group, data + position, kGroupHeaderSize);
+            if (group.payload_size % 4 != 0 || group.record_count > group.payload_size
+                || group.payload_size > mapping.size() - position - kGroupHeaderSize) {
+                break;
+            }
+            groups.push_back(GroupLocation{ position, num_records });
+            num_records += group.record_count;
+            position += kGroupHeaderSize + group.payload_size;
+        }
+
+        // Verify and decode the groups in parallel, each into its own range of records
+        records.resize(num_records);
+        std::vector<char> intact(groups.size(), 0);
+        pool.parallelFor(groups.size(), 16, [&](unsigned, std::size_t begin, std::size_t end) {
+            for (std::size_t index = begin; index < end; index++) {
+                GroupHeader group;
+                std::memcpy(&group, data + groups[index].offset, kGroupHeaderSize);
+                const unsigned char* payload = data + groups[index].offset + kGroupHeaderSize;
+                intact[index] = group.checksum == groupChecksum(group, payload)
+                    && decodeGroup(group, payload, records.data() + groups[index].first_record);
+            }
+        });
+
+        // The journal ends at the first damaged group
+        valid_size = position;
+        for (std::size_t index = 0; index < groups.size(); index++) {
+            if (!intact[index]) {
+                valid_size = groups[index].offset;
+                records.resize(groups[index].first_record);
+                break;
+            }
+        }
+    }
+    mapping.close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        records.clear();
+        return false;
+    }
+    file_handle = file;
+#else
+    descriptor = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (descriptor == -1) {
+        records.clear();
+        return false;
+    }
+#endif
+
+    // Drop a torn tail, or start a new file with its header
+    bool opened;
+    if (valid_size == 0) {
+        FileHeader header;
+        header.magic = kMagic;
+        header.byte_order = kByteOrderMark;
+        header.version = kVersion;
+        opened = truncate(0) && writeBytes(reinterpret_cast<const unsigned char*>(&header), kFileHeaderSize) && flush();
+    }
+    else {
+        opened = truncate(valid_size);
+    }
+    if (!opened) {
+        close();
+        records.clear();
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Write the buffered records, flush and close the file.
+ */
+void MutationJournal::close() {
+    if (!isOpen()) {
+        return;
+    }
+    sync();
+#ifdef _WIN32
+    CloseHandle(static_cast<HANDLE>(file_handle));
+    file_handle = nullptr;
+#else
+    ::close(descriptor);
+    descriptor = -1;
+#endif
+    buffer.resize(kGroupHeaderSize);
+    buffered_records = 0;
+    unsynced_groups = 0;
+    file_size = 0;
+}
+
+
+/**
+ * @brief Check if a journal file is open.
+ * @return true if the journal is open, false otherwise.
+ */
+bool MutationJournal::isOpen() const {
+#ifdef _WIN32
+    return file_handle != nullptr;
+#else
+    return descriptor != -1;
+#endif
+}
+
+
+/**
+ * @brief Record a change, writing a group when enough records are buffered.
+ * @param operation The change.
+ * @param user_id1 The user, or the first user of a connection.
+ * @param user_id2 The second user of a connection, 0 otherwise.
+ * @return true if the record was buffered and any write succeeded, false otherwise.
+ */
+bool MutationJournal::append(JournalOperation operation, UserId user_id1, UserId user_id2) {
+    if (!isOpen()) {
+        return false;
+    }
+    buffer.reserve(buffer.size() + kMaxRecordSize);
+    buffer.push_back(static_cast<unsigned char>(operation));
+    if (operation != JournalOperation::Clear) {
+        putVarint(user_id1, buffer);
+    }
+    if (operation == JournalOperation::AddConnection || operation == JournalOperation::RemoveConnection
+        || operation == JournalOperation::LoadConnection) {
+        putVarint(user_id2, buffer);
+    }
+    buffered_records++;
+
+    if (buffered_records < options.group_records) {
+        return true;
+    }
+    return commit();
+}
+
+
+/**
+ * @brief Write the buffered records as a group.
+ * @return true if the group was written, false otherwise.
+ */
+bool MutationJournal::commit() {
+    if (!isOpen()) {
+        return false;
+    }
+    if (buffered_records == 0) {
+        return true;
+    }
+
+    // Pad the records to whole words and fill in the header reserved at the front of the buffer
+    const std::size_t unpadded = buffer.size();
+    const std::uint64_t committed = file_size;
+    while ((buffer.size() - kGroupHeaderSize) % 4 != 0) {
+        buffer.push_back(0);
+    }
+    GroupHeader group;
+    group.payload_size = static_cast<std::uint32_t>(buffer.size() - kGroupHeaderSize);
+    group.record_count = static_cast<std::uint32_t>(buffered_records);
+    group.checksum = groupChecksum(group, buffer.data() + kGroupHeaderSize);
+    std::memcpy(buffer.data(), &group, kGroupHeaderSize);
+
+    // One write per group; a failed write is cut off so later groups stay readable
+    if (!writeBytes(buffer.data(), buffer.size())) {
+        truncate(committed);
+        buffer.resize(unpadded);
+        return false;
+    }
+    buffer.resize(kGroupHeaderSize);
+    buffered_records = 0;
+
+    unsynced_groups++;
+    if (options.groups_per_sync > 0 && unsynced_groups >= options.groups_per_sync) {
+        return flush();
+    }
+    return true;
+}
+
+
+/**
+ * @brief Write the buffered records and flush the file to disk.
+ * @return true if every record appended so far is durable, false otherwise.
+ */
+bool MutationJournal::sync() {
+    return commit() && flush();
+}
+
+
+/**
+ * @brief Drop every record, after the network was saved to a snapshot that holds them.
+ * @return true if the file was truncated and flushed, false otherwise.
+ */
+bool MutationJournal::reset() {
+    if (!isOpen()) {
+        return false;
+    }
+    buffer.resize(kGroupHeaderSize);
+    buffered_records = 0;
+    return truncate(kFileHeaderSize);
+}
+
+
+/**
+ * @brief Check if the journal has grown past options.compaction_bytes.
+ * @return true if the journal should be compacted, false otherwise.
+ */
+bool MutationJournal::needsCompaction() const {
+    return size() >= options.compaction_bytes;
+}
+
+
+/**
+ * @brief Get the size of the journal.
+ * @return The number of bytes written and buffered.
+ */
+std::uint64_t MutationJournal::size() const {
+    return file_size + (buffered_records > 0 ? buffer.size() : 0);
+}
+
+
+/**
+ * @brief Flush a file written by another writer to disk, together with its directory entry.
+ * @param path The path of the file.
+ * @return true if the file was flushed, false otherwise.
+ */
+bool MutationJournal::syncFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool flushed = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return flushed;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1) {
+        return false;
+    }
+    bool flushed = fsync(file) == 0;
+    ::close(file);
+
+    // A rename is only durable once the directory is flushed as well
+    std::string::size_type slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int parent = ::open(directory.c_str(), O_RDONLY);
+    if (parent != -1) {
+        fsync(parent);
+        ::close(parent);
+    }
+    return flushed;
+#endif
+}
+
+
+/**
+ * @brief Write bytes at the end of the file.
+ * @param data The bytes.
+ * @param size The number of bytes.
+ * @return true if every byte was written, false otherwise.
+ */
+bool MutationJournal::writeBytes(const unsigned char* data, std::size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        DWORD chunk = static_cast<DWORD>(size < 0x40000000 ? size : 0x40000000);
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(file_handle), data, chunk, &written, nullptr) || written == 0) {
+            return false;
+        }
+#else
+        ssize_t written = ::write(descriptor, data, size);
+        if (written <= 0) {
+            return false;
+        }
+#endif
+        data += written;
+        size -= static_cast<std::size_t>(written);
+        file_size += static_cast<std::uint64_t>(written);
+    }
+    return true;
+}
+
+
+/**
+ * @brief Cut the file to a size and flush it.
+ * @param size The new size of the file.
+ * @return true if the file was truncated, false otherwise.
+ */
+bool MutationJournal::truncate(std::uint64_t size) {
+#ifdef _WIN32
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(static_cast<HANDLE>(file_handle), position, nullptr, FILE_BEGIN)
+        || !SetEndOfFile(static_cast<HANDLE>(file_handle))) {
+        return false;
+    }
+#else
+    if (ftruncate(descriptor, static_cast<off_t>(size)) != 0
+        || lseek(descriptor, static_cast<off_t>(size), SEEK_SET) == static_cast<off_t>(-1)) {
+        return false;
+    }
+#endif
+    file_size = size;
+    return flush();
+}
+
+
+/**
+ * @brief Flush the file to disk.
+ * @return true if the file was flushed, false otherwise.
+ */
+bool MutationJournal::flush() {
+    unsynced_groups = 0;
+#ifdef _WIN32
+    return FlushFileBuffers(static_cast<HANDLE>(file_handle)) != 0;
+#elif defined(__linux__)
+    // The size is metadata fdatasync still flushes, the timestamps are not needed
+    return fdatasync(descriptor) == 0;
+#else
+    return fsync(descriptor) == 0;
+#endif
+}
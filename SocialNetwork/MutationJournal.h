@@ -0,0 +1,179 @@
+#ifndef MUTATIONJOURNAL_H
+#define MUTATIONJOURNAL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+#include "UserId.h"
+
+
+/**
+ * @enum JournalOperation
+ * @brief A change to a social network recorded in a journal.
+ */
+enum class JournalOperation : unsigned char {
+    AddUser = 1,  // addUser(user_id1).
+    RemoveUser = 2,  // removeUser(user_id1).
+    AddConnection = 3,  // addConnection(user_id1, user_id2).
+    RemoveConnection = 4,  // removeConnection(user_id1, user_id2).
+    LoadConnection = 5,  // A connection of a bulk load, which adds missing users.
+    Clear = 6  // clearNetwork().
+};
+
+
+/**
+ * @struct JournalRecord
+ * @brief One recorded change.
+ */
+struct JournalRecord {
+    JournalOperation operation;  // The change.
+    UserId user_id1;  // The user, or the first user of a connection.
+    UserId user_id2;  // The second user of a connection, 0 otherwise.
+};
+
+
+/**
+ * @struct JournalOptions
+ * @brief How often a journal writes, flushes and compacts.
+ */
+struct JournalOptions {
+    int group_records = 256;  // Records buffered before they are written as one group.
+    int groups_per_sync = 16;  // Groups written between two flushes to disk, 0 to leave flushing to the system.
+    std::uint64_t compaction_bytes = 64ull << 20;  // Journal size that triggers a compaction into the snapshot.
+};
+
+
+/**
+ * @class MutationJournal
+ * @brief An append-only file of the changes made to a social network since its last snapshot.
+ *
+ * Records are buffered and written as checksummed groups of options.group_records records, and the file is only
+ * flushed to disk every options.groups_per_sync groups, so a change costs an encode into memory most of the time.
+ * A crash loses at most the buffered records and the groups written since the last flush; sync() makes everything
+ * appended so far durable.
+ *
+ * The file is a header followed by groups. A group is its payload size, record count and checksum, then the
+ * records, each an operation byte followed by the zigzag varint encoding of its user IDs. A torn or corrupt group
+ * ends the journal: it and everything after it are dropped when the journal is opened again.
+ */
+class MutationJournal {
+public:
+    /**
+     * @brief Construct a Mutation Journal object that is not open.
+     */
+    MutationJournal();
+
+    /**
+     * @brief Write the buffered records, flush and close the file.
+     */
+    ~MutationJournal();
+
+    MutationJournal(const MutationJournal&) = delete;
+    MutationJournal& operator=(const MutationJournal&) = delete;
+
+    /**
+     * @brief Open a journal file for appending, creating it if needed, and read the records it already holds.
+     *
+     * The groups are located in one pass over their headers, then verified and decoded in parallel on the pool.
+     * The file is truncated after the last intact group.
+     * @param path The path of the file.
+     * @param options When to write, flush and compact.
+     * @param pool The thread pool to decode on.
+     * @param records Receives the records of the file, in order.
+     * @return true if the file was opened, false if it could not be created or is not a journal.
+     */
+    bool open(const std::string& path, const JournalOptions& options, ThreadPool& pool, std::vector<JournalRecord>& records);
+
+    /**
+     * @brief Write the buffered records, flush and close the file.
+     */
+    void close();
+
+    /**
+     * @brief Check if a journal file is open.
+     * @return true if the journal is open, false otherwise.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Record a change, writing a group when enough records are buffered.
+     * @param operation The change.
+     * @param user_id1 The user, or the first user of a connection.
+     * @param user_id2 The second user of a connection, 0 otherwise.
+     * @return true if the record was buffered and any write succeeded, false otherwise.
+     */
+    bool append(JournalOperation operation, UserId user_id1, UserId user_id2 = 0);
+
+    /**
+     * @brief Write the buffered records as a group.
+     * @return true if the group was written, false otherwise.
+     */
+    bool commit();
+
+    /**
+     * @brief Write the buffered records and flush the file to disk.
+     * @return true if every record appended so far is durable, false otherwise.
+     */
+    bool sync();
+
+    /**
+     * @brief Drop every record, after the network was saved to a snapshot that holds them.
+     * @return true if the file was truncated and flushed, false otherwise.
+     */
+    bool reset();
+
+    /**
+     * @brief Check if the journal has grown past options.compaction_bytes.
+     * @return true if the journal should be compacted, false otherwise.
+     */
+    bool needsCompaction() const;
+
+    /**
+     * @brief Get the size of the journal.
+     * @return The number of bytes written and buffered.
+     */
+    std::uint64_t size() const;
+
+    /**
+     * @brief Flush a file written by another writer to disk, together with its directory entry.
+     * @param path The path of the file.
+     * @return true if the file was flushed, false otherwise.
+     */
+    static bool syncFile(const std::string& path);
+
+private:
+    JournalOptions options;  // When to write, flush and compact.
+    std::vector<unsigned char> buffer;  // Encoded records not written yet.
+    int buffered_records;  // The number of records in buffer.
+    int unsynced_groups;  // Groups written since the last flush.
+    std::uint64_t file_size;  // The number of bytes in the file.
+#ifdef _WIN32
+    void* file_handle;  // The handle of the open file.
+#else
+    int descriptor;  // The descriptor of the open file, -1 if closed.
+#endif
+
+    /**
+     * @brief Write bytes at the end of the file.
+     * @param data The bytes.
+     * @param size The number of bytes.
+     * @return true if every byte was written, false otherwise.
+     */
+    bool writeBytes(const unsigned char* data, std::size_t size);
+
+    /**
+     * @brief Cut the file to a size and flush it.
+     * @param size The new size of the file.
+     * @return true if the file was truncated, false otherwise.
+     */
+    bool truncate(std::uint64_t size);
+
+    /**
+     * @brief Flush the file to disk.
+     * @return true if the file was flushed, false otherwise.
+     */
+    bool flush();
+};
+
+#endif // MUTATIONJOURNAL_H
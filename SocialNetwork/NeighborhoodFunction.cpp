@@ -0,0 +1,212 @@
+#include "NeighborhoodFunction.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NEIGHBORHOOD_FUNCTION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const std::size_t kChunkUsers = 1 << 10;  // Users per chunk of work and per partial sum.
+
+    /**
+     * @brief Mix the bits of a 64-bit value (the MurmurHash3 finalizer).
+     * @param value The value to mix.
+     * @return The mixed value.
+     */
+    std::uint64_t mix64(std::uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    /**
+     * @brief Merge a counter into another by taking the maximum of every register.
+     * @param target The registers of the counter to merge into.
+     * @param source The registers of the counter to merge.
+     * @param count The number of registers, a multiple of 16.
+     */
+    void mergeRegisters(unsigned char* target, const unsigned char* source, std::size_t count) {
+        std::size_t position = 0;
+#ifdef NEIGHBORHOOD_FUNCTION_SSE2
+        for (; position + 16 <= count; position += 16) {
+            __m128i merged = _mm_max_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(target + position)),
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + position)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + position), merged);
+        }
+#endif
+        for (; position < count; position++) {
+            target[position] = std::max(target[position], source[position]);
+        }
+    }
+
+    /**
+     * @brief Estimate the number of distinct users a HyperLogLog counter has seen.
+     * @param registers The registers of the counter.
+     * @param count The number of registers.
+     * @param alpha The bias correction for the number of registers.
+     * @param inverse_powers 2^-r for every register value r.
+     * @return The estimate, with the linear counting correction for small sets.
+     */
+    double estimateCount(const unsigned char* registers, std::size_t count, double alpha, const double* inverse_powers) {
+        double sum = 0;
+        std::size_t zeros = 0;
+        for (std::size_t position = 0; position < count; position++) {
+            sum += inverse_powers[registers[position]];
+            zeros += registers[position] == 0;
+        }
+        double estimate = alpha * count * count / sum;
+        if (estimate <= 2.5 * count && zeros > 0) {
+            estimate = count * std::log(static_cast<double>(count) / zeros);
+        }
+        return estimate;
+    }
+}
+
+/**
+ * @brief Estimate the number of users within every number of hops of every user with HyperANF, in parallel.
+ * @param graph The snapshot to measure.
+ * @param pool The thread pool to merge on.
+ * @param options The counter size, the hops to keep and the seed.
+ * @param result Receives the reach of every user and the neighborhood function.
+ */
+void approximateNeighborhoodFunction(const NetworkSnapshot& graph, ThreadPool& pool,
+                                     const NeighborhoodOptions& options, NeighborhoodResult& result) {
+    const int users = graph.numberOfUsers();
+    const int bits = std::min(std::max(options.register_bits, 4), 12);
+    const std::size_t registers = std::size_t(1) << bits;
+    const int hops = std::max(options.hops, 0);
+    result.reach.assign(hops, std::vector<float>(users, 0.0f));
+    result.pairs.clear();
+    result.iterations = 0;
+    result.effective_diameter = 0;
+    if (users == 0) {
+        return;
+    }
+
+    // The HyperLogLog bias correction, tabulated for small counters
+    double alpha = 0.7213 / (1 + 1.079 / registers);
+    if (registers == 16) {
+        alpha = 0.673;
+    }
+    else if (registers == 32) {
+        alpha = 0.697;
+    }
+    else if (registers == 64) {
+        alpha = 0.709;
+    }
+    double inversePowers[64];
+    for (int value = 0; value < 64; value++) {
+        inversePowers[value] = std::ldexp(1.0, -value);
+    }
+
+    // Every user starts out counting itself: one register holds the position of the lowest set bit of its hash
+    std::vector<unsigned char> current(users * registers, 0);
+    std::vector<unsigned char> next(users * registers);
+    const std::uint64_t salt = mix64(options.seed ^ 0x9E3779B97F4A7C15ull);
+    for (int user = 0; user < users; user++) {
+        std::uint64_t hash = mix64(static_cast<std::uint64_t>(graph.userId(user)) ^ salt);
+        std::uint64_t rest = hash >> bits;
+        int rank = 1;
+        while (rank <= 64 - bits && (rest & 1) == 0) {
+            rest >>= 1;
+            rank++;
+        }
+        current[user * registers + (hash & (registers - 1))] = static_cast<unsigned char>(rank);
+    }
+
+    const std::size_t chunks = (users + kChunkUsers - 1) / kChunkUsers;
+    std::vector<double> estimateParts(chunks, 0.0);
+    std::vector<int> changedParts(chunks, 0);
+    std::vector<float> estimates(users);
+    std::vector<char> changed(users, 1);
+    std::vector<char> nextChanged(users);
+    pool.parallelForChunks(users, kChunkUsers, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        double sum = 0;
+        for (int user = static_cast<int>(begin); user < static_cast<int>(end); user++) {
+            estimates[user] = static_cast<float>(estimateCount(&current[user * registers], registers, alpha, inversePowers));
+            sum += estimates[user];
+        }
+        estimateParts[chunk] = sum;
+    });
+    auto sumParts = [](const std::vector<double>& parts) {
+        double total = 0;
+        for (double part : parts) {
+            total += part;
+        }
+        return total;
+    };
+    result.pairs.push_back(sumParts(estimateParts));
+
+    const int maxIterations = options.max_iterations > 0 ? std::max(options.max_iterations, hops) : 0;
+    while (maxIterations == 0 || result.iterations < maxIterations) {
+        // A counter only grows when a neighbor's counter changed in the previous hop, and only the changed
+        // neighbors can add to it: the others were merged already
+        pool.parallelForChunks(users, kChunkUsers, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+            double sum = 0;
+            int changes = 0;
+            for (int user = static_cast<int>(begin); user < static_cast<int>(end); user++) {
+                unsigned char* target = &next[user * registers];
+                const unsigned char* own = &current[user * registers];
+                std::memcpy(target, own, registers);
+                for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                    if (changed[*neighbor]) {
+                        mergeRegisters(target, &current[*neighbor * registers], registers);
+                    }
+                }
+                nextChanged[user] = std::memcmp(target, own, registers) != 0;
+                if (nextChanged[user]) {
+                    estimates[user] = static_cast<float>(estimateCount(target, registers, alpha, inversePowers));
+                    changes++;
+                }
+                sum += estimates[user];
+            }
+            estimateParts[chunk] = sum;
+            changedParts[chunk] = changes;
+        });
+
+        int changes = 0;
+        for (int part : changedParts) {
+            changes += part;
+        }
+        if (changes == 0) {
+            break;
+        }
+        current.swap(next);
+        changed.swap(nextChanged);
+        result.iterations++;
+        result.pairs.push_back(sumParts(estimateParts));
+
+        if (result.iterations <= hops) {
+            std::vector<float>& reach = result.reach[result.iterations - 1];
+            pool.parallelForChunks(users, kChunkUsers, [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (int user = static_cast<int>(begin); user < static_cast<int>(end); user++) {
+                    reach[user] = std::max(estimates[user] - 1.0f, 0.0f);
+                }
+            });
+        }
+    }
+
+    // Once no counter changes, the reach stays the same for any further hops
+    for (int hop = result.iterations + 1; hop <= hops; hop++) {
+        for (int user = 0; user < users; user++) {
+            result.reach[hop - 1][user] = std::max(estimates[user] - 1.0f, 0.0f);
+        }
+    }
+
+    // The first hop count that reaches 90% of the pairs, interpolated between hops
+    const double target = 0.9 * result.pairs.back();
+    for (std::size_t hop = 1; hop < result.pairs.size(); hop++) {
+        if (result.pairs[hop] >= target) {
+            double below = result.pairs[hop - 1];
+            double step = result.pairs[hop] - below;
+            result.effective_diameter = (hop - 1) + (step > 0 ? std::min(std::max((target - below) / step, 0.0), 1.0) : 1.0);
+            break;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef NEIGHBORHOODFUNCTION_H
+#define NEIGHBORHOODFUNCTION_H
+
+#include <cstdint>
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+
+
+/**
+ * @struct NeighborhoodOptions
+ * @brief The precision and extent of an approximate neighborhood function.
+ */
+struct NeighborhoodOptions {
+    int register_bits = 6;  // Every counter has 2^register_bits one-byte registers, from 4 to 12. The relative
+                            // standard error of a reach estimate is about 1.04 / sqrt(2^register_bits).
+    int hops = 4;  // Keep the reach of every user for 1..hops hops.
+    int max_iterations = 0;  // Stop after this many hops, but not before hops, even if counters still change. 0 for
+                             // no limit.
+    std::uint64_t seed = 0;  // Salt of the hash that assigns users to registers.
+};
+
+
+/**
+ * @struct NeighborhoodResult
+ * @brief The approximate neighborhood function of a snapshot.
+ *
+ * Per-user arrays use the dense indices of the snapshot that was measured.
+ */
+struct NeighborhoodResult {
+    std::vector<std::vector<float>> reach;  // reach[h - 1][user] estimates the number of other users at most h hops
+                                            // from user, for h = 1..options.hops.
+    std::vector<double> pairs;  // pairs[t] estimates the number of ordered pairs of users at most t hops apart,
+                                // each user paired with itself included, for t = 0..iterations.
+    int iterations;  // The number of hops after which no counter changed, or the limit of options.max_iterations.
+    double effective_diameter;  // The interpolated number of hops within which 90% of the pairs of pairs.back() lie.
+};
+
+
+/**
+ * @brief Estimate the number of users within every number of hops of every user with HyperANF, in parallel.
+ *
+ * Every user keeps a HyperLogLog counter of the users at most t hops away, starting with itself at t = 0. Hop
+ * t + 1 merges the counters of every user's neighbors into its own by taking the maximum of every register, which
+ * is the union of the counted sets, so one pass over the connections advances all users by one hop. Registers are
+ * merged 16 at a time with SSE2 when it is available. A user is only merged again when a neighbor's counter changed
+ * in the previous hop, and the passes stop once no counter changes.
+ *
+ * Two counter arrays, for the current and the next hop, are the only state proportional to the counter size, so
+ * the memory is 2 * 2^register_bits bytes per user, plus the floats of the reach that is kept.
+ * @param graph The snapshot to measure.
+ * @param pool The thread pool to merge on.
+ * @param options The counter size, the hops to keep and the seed.
+ * @param result Receives the reach of every user and the neighborhood function.
+ */
+void approximateNeighborhoodFunction(const NetworkSnapshot& graph, ThreadPool& pool,
+                                     const NeighborhoodOptions& options, NeighborhoodResult& result);
+
+#endif // NEIGHBORHOODFUNCTION_H
@@ -0,0 +1,270 @@
+#include "NetworkPrinter.h"
+#include <vector>
+
+/**
+ * @brief Construct a new NetworkPrinter object.
+ * @param network The network to operate on.
+ * @param out The stream to describe the outcomes on.
+ */
+NetworkPrinter::NetworkPrinter(SocialNetwork& network, std::ostream& out) : network(network), out(out) {}
+
+
+/**
+ * @brief Add a user and report the outcome.
+ * @param user_id The ID of the user to be added.
+ * @return The status of the operation.
+ */
+NetworkStatus NetworkPrinter::addUser(UserId user_id) {
+    NetworkStatus status = network.addUser(user_id);
+    if (status == NetworkStatus::UserExists) {
+        out << "User with ID " << user_id << " already exists." << std::endl;
+    }
+    else {
+        out << "User " << user_id << " added successfully." << std::endl;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Remove a user and report the outcome.
+ * @param user_id The ID of the user to be removed.
+ * @return The status of the operation.
+ */
+NetworkStatus NetworkPrinter::removeUser(UserId user_id) {
+    NetworkStatus status = network.removeUser(user_id);
+    switch (status) {
+    case NetworkStatus::EmptyNetwork:
+        out << "Network is empty." << std::endl;
+        break;
+    case NetworkStatus::UserNotFound:
+        out << "User with ID " << user_id << " not found." << std::endl;
+        break;
+    default:
+        out << "User " << user_id << " removed successfully." << std::endl;
+        break;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Add a connection and report the outcome.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The status of the operation.
+ */
+NetworkStatus NetworkPrinter::addConnection(UserId user_id1, UserId user_id2) {
+    NetworkStatus status = network.addConnection(user_id1, user_id2);
+    switch (status) {
+    case NetworkStatus::SelfConnection:
+        out << "A user cannot connect to itself." << std::endl;
+        break;
+    case NetworkStatus::UserNotFound:
+        reportMissingUsers(user_id1, user_id2);
+        break;
+    case NetworkStatus::ConnectionExists:
+        out << "Connection between User " << user_id1 << " and User " << user_id2 << " already exists." << std::endl;
+        break;
+    default:
+        out << "Connection added between " << user_id1 << " and " << user_id2 << "." << std::endl;
+        break;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Remove a connection and report the outcome.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The status of the operation.
+ */
+NetworkStatus NetworkPrinter::removeConnection(UserId user_id1, UserId user_id2) {
+    NetworkStatus status = network.removeConnection(user_id1, user_id2);
+    switch (status) {
+    case NetworkStatus::EmptyNetwork:
+        out << "Network is empty." << std::endl;
+        break;
+    case NetworkStatus::UserNotFound:
+        reportMissingUsers(user_id1, user_id2);
+        break;
+    case NetworkStatus::SelfConnection:
+        out << "A user cannot disconnect to itself." << std::endl;
+        break;
+    case NetworkStatus::ConnectionNotFound:
+        out << "Connection between User " << user_id1 << " and User " << user_id2 << " does not exist." << std::endl;
+        break;
+    default:
+        out << "Connection removed between " << user_id1 << " and " << user_id2 << "." << std::endl;
+        break;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Check if two users are connected and report the outcome.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return true if the two users are connected, false otherwise.
+ */
+bool NetworkPrinter::isConnected(UserId user_id1, UserId user_id2) {
+    bool connected = network.isConnected(user_id1, user_id2);
+
+    // A user is connected to itself without being looked up
+    if (user_id1 != user_id2 && (!network.hasUser(user_id1) || !network.hasUser(user_id2))) {
+        out << "One of the users does not exist." << std::endl;
+    }
+    if (connected) {
+        out << "Users " << user_id1 << " and " << user_id2 << " are connected." << std::endl;
+    }
+    else {
+        out << "Users " << user_id1 << " and " << user_id2 << " are not connected." << std::endl;
+    }
+    return connected;
+}
+
+
+/**
+ * @brief Find and print the shortest path between two users.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The length of the shortest path, or -1 if there is none.
+ */
+int NetworkPrinter::findShortestPath(UserId user_id1, UserId user_id2) {
+    std::vector<UserId> path;
+    NetworkStatus status = network.findShortestPath(user_id1, user_id2, path);
+
+    if (status == NetworkStatus::UserNotFound) {
+        UserId missing = network.hasUser(user_id1) ? user_id2 : user_id1;
+        out << "User with ID " << missing << " does not exist." << std::endl;
+        return -1;
+    }
+    if (status == NetworkStatus::NoPath) {
+        out << "There is no path from user " << user_id1 << " to user " << user_id2 << "." << std::endl;
+        return -1;
+    }
+
+    out << "Shortest path from user " << user_id1 << " to user " << user_id2 << ": ";
+    for (UserId node : path) {
+        out << node << " ";
+    }
+    out << std::endl;
+    return static_cast<int>(path.size()) - 1;
+}
+
+
+/**
+ * @brief Print a breadth-first traversal from a user.
+ * @param user_id The ID of the user to start the search from.
+ * @return The status of the operation.
+ */
+NetworkStatus NetworkPrinter::BFS(UserId user_id) {
+    std::vector<UserId> order;
+    NetworkStatus status = network.BFS(user_id, order);
+    if (status == NetworkStatus::Ok) {
+        printTraversal("BFS", user_id, order);
+    }
+    else {
+        out << "User with ID " << user_id << " does not exist." << std::endl;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Print a depth-first traversal from a user.
+ * @param user_id The ID of the user to start the search from.
+ * @return The status of the operation.
+ */
+NetworkStatus NetworkPrinter::DFS(UserId user_id) {
+    std::vector<UserId> order;
+    NetworkStatus status = network.DFS(user_id, order);
+    if (status == NetworkStatus::Ok) {
+        printTraversal("DFS", user_id, order);
+    }
+    else {
+        out << "User with ID " << user_id << " does not exist." << std::endl;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Print every user with their connections.
+ */
+void NetworkPrinter::printNetwork() {
+    // Check if the network is empty
+    if (network.isEmpty()) {
+        out << "Network is empty." << std::endl;
+        return;
+    }
+
+    std::vector<UserId> connections;
+    for (UserId user_id : network.userIds()) {
+        network.connectionsOf(user_id, connections);
+
+        out << "\n--------------------------" << std::endl;
+        out << "User ID: " << user_id << std::endl;
+        out << "Number of connections: " << connections.size() << std::endl;
+
+        out << "Connected to: ";
+        if (connections.empty()) {
+            out << "None";
+        }
+        else {
+            for (std::size_t position = 0; position < connections.size(); position++) {
+                if (position != 0) {
+                    out << ", ";
+                }
+                out << connections[position];
+            }
+        }
+        out << std::endl;
+    }
+}
+
+
+/**
+ * @brief Clear the network and report the outcome.
+ */
+void NetworkPrinter::clearNetwork() {
+    if (!network.isEmpty()) {
+        network.clearNetwork();
+        out << "Network cleared." << std::endl;
+    }
+}
+
+
+/**
+ * @brief Report each of two users that is not in the network.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ */
+void NetworkPrinter::reportMissingUsers(UserId user_id1, UserId user_id2) {
+    if (!network.hasUser(user_id1)) {
+        out << "User with ID " << user_id1 << " not found." << std::endl;
+    }
+    if (!network.hasUser(user_id2)) {
+        out << "User with ID " << user_id2 << " not found." << std::endl;
+    }
+}
+
+
+/**
+ * @brief Print a traversal order.
+ * @param name The name of the traversal.
+ * @param user_id The ID of the user the traversal started from.
+ * @param order The IDs of the reached users in visiting order.
+ */
+void NetworkPrinter::printTraversal(const char* name, UserId user_id, const std::vector<UserId>& order) {
+    out << name << " starting from vertex " << user_id << ": ";
+    for (std::size_t position = 0; position < order.size(); position++) {
+        if (position != 0) {
+            out << ", ";
+        }
+        out << order[position];
+    }
+    out << std::endl;
+}
@@ -0,0 +1,114 @@
+#ifndef NETWORKPRINTER_H
+#define NETWORKPRINTER_H
+
+#include <iostream>
+#include "SocialNetwork.h"
+
+
+/**
+ * @class NetworkPrinter
+ * @brief A console front end for a social network.
+ *
+ * Every operation forwards to the network and then describes its outcome on an output stream, the way the
+ * interactive menu presents it. The network itself never writes to a stream.
+ */
+class NetworkPrinter {
+public:
+    /**
+     * @brief Construct a new Network Printer object.
+     * @param network The network to operate on.
+     * @param out The stream to describe the outcomes on.
+     */
+    NetworkPrinter(SocialNetwork& network, std::ostream& out = std::cout);
+
+    /**
+     * @brief Add a user and report the outcome.
+     * @param user_id The ID of the user to be added.
+     * @return The status of the operation.
+     */
+    NetworkStatus addUser(UserId user_id);
+
+    /**
+     * @brief Remove a user and report the outcome.
+     * @param user_id The ID of the user to be removed.
+     * @return The status of the operation.
+     */
+    NetworkStatus removeUser(UserId user_id);
+
+    /**
+     * @brief Add a connection and report the outcome.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The status of the operation.
+     */
+    NetworkStatus addConnection(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Remove a connection and report the outcome.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The status of the operation.
+     */
+    NetworkStatus removeConnection(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Check if two users are connected and report the outcome.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return true if the two users are connected, false otherwise.
+     */
+    bool isConnected(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Find and print the shortest path between two users.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The length of the shortest path, or -1 if there is none.
+     */
+    int findShortestPath(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Print a breadth-first traversal from a user.
+     * @param user_id The ID of the user to start the search from.
+     * @return The status of the operation.
+     */
+    NetworkStatus BFS(UserId user_id);
+
+    /**
+     * @brief Print a depth-first traversal from a user.
+     * @param user_id The ID of the user to start the search from.
+     * @return The status of the operation.
+     */
+    NetworkStatus DFS(UserId user_id);
+
+    /**
+     * @brief Print every user with their connections.
+     */
+    void printNetwork();
+
+    /**
+     * @brief Clear the network and report the outcome.
+     */
+    void clearNetwork();
+
+private:
+    SocialNetwork& network;  // The network to operate on.
+    std::ostream& out;  // The stream to describe the outcomes on.
+
+    /**
+     * @brief Report each of two users that is not in the network.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     */
+    void reportMissingUsers(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Print a traversal order.
+     * @param name The name of the traversal.
+     * @param user_id The ID of the user the traversal started from.
+     * @param order The IDs of the reached users in visiting order.
+     */
+    void printTraversal(const char* name, UserId user_id, const std::vector<UserId>& order);
+};
+
+#endif // NETWORKPRINTER_H
@@ -0,0 +1,213 @@
+#include "NetworkReader.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * @class ReadScope
+     * @brief Holds a version of the network for the duration of one query.
+     */
+    class ReadScope {
+    public:
+        ReadScope(SnapshotPublisher& publisher, int reader) : publisher(publisher), reader(reader) {
+            graph = publisher.enter(reader);
+        }
+
+        ~ReadScope() {
+            publisher.exit(reader);
+        }
+
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+
+        const NetworkSnapshot* graph;  // The version being read.
+
+    private:
+        SnapshotPublisher& publisher;  // The publisher of the version.
+        int reader;  // The reader slot.
+    };
+}
+
+/**
+ * @brief Construct a Network Reader object and register it with a publisher.
+ * @param publisher The publisher to read from.
+ */
+NetworkReader::NetworkReader(SnapshotPublisher& publisher) : publisher(publisher), reader(publisher.registerReader()) {}
+
+
+/**
+ * @brief Destructor for NetworkReader class.
+ * Gives the reader slot back to the publisher.
+ */
+NetworkReader::~NetworkReader() {
+    if (reader != -1) {
+        publisher.unregisterReader(reader);
+    }
+}
+
+
+/**
+ * @brief Check if the reader got a slot from its publisher.
+ * @return true if the reader can be used, false otherwise.
+ */
+bool NetworkReader::isRegistered() const {
+    return reader != -1;
+}
+
+
+/**
+ * @brief Get the version of the network the next query will read.
+ * @return The number of versions published so far.
+ */
+std::uint64_t NetworkReader::version() const {
+    return publisher.version();
+}
+
+
+/**
+ * @brief Check if a user is in the network.
+ * @param user_id The ID of the user.
+ * @return true if the user is in the network, false otherwise.
+ */
+bool NetworkReader::hasUser(UserId user_id) {
+    if (!acquireSlot()) {
+        return false;
+    }
+    ReadScope scope(publisher, reader);
+    return scope.graph->indexOf(user_id) != -1;
+}
+
+
+/**
+ * @brief Get the number of users in the network.
+ * @return The number of users in the network.
+ */
+int NetworkReader::numberOfUsers() {
+    if (!acquireSlot()) {
+        return 0;
+    }
+    ReadScope scope(publisher, reader);
+    return scope.graph->numberOfUsers();
+}
+
+
+/**
+ * @brief Get the number of connections in the network.
+ * @return The number of connections in the network.
+ */
+long long NetworkReader::numberOfConnections() {
+    if (!acquireSlot()) {
+        return 0;
+    }
+    ReadScope scope(publisher, reader);
+    return scope.graph->numberOfConnections();
+}
+
+
+/**
+ * @brief Check if two users are connected with a binary search in the sorted row of the first user.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return true if the two users are connected or are the same existing user, false otherwise.
+ */
+bool NetworkReader::isConnected(UserId user_id1, UserId user_id2) {
+    if (!acquireSlot()) {
+        return false;
+    }
+    ReadScope scope(publisher, reader);
+    int index1 = scope.graph->indexOf(user_id1);
+    int index2 = scope.graph->indexOf(user_id2);
+    if (index1 == -1 || index2 == -1) {
+        return false;
+    }
+    return index1 == index2
+        || std::binary_search(scope.graph->neighborsBegin(index1), scope.graph->neighborsEnd(index1), index2);
+}
+
+
+/**
+ * @brief Find the length of the shortest path between two users.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+ */
+int NetworkReader::findShortestPath(UserId user_id1, UserId user_id2) {
+    if (!acquireSlot()) {
+        return -1;
+    }
+    ReadScope scope(publisher, reader);
+    int start = scope.graph->indexOf(user_id1);
+    int end = scope.graph->indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        return -1;
+    }
+    return path_search.run(*scope.graph, start, end);
+}
+
+
+/**
+ * @brief Find the shortest path between two users.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+ * @return Ok, UserNotFound or NoPath.
+ */
+NetworkStatus NetworkReader::findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path) {
+    path.clear();
+    if (!acquireSlot()) {
+        return NetworkStatus::UserNotFound;
+    }
+    ReadScope scope(publisher, reader);
+    int start = scope.graph->indexOf(user_id1);
+    int end = scope.graph->indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+    if (path_search.run(*scope.graph, start, end, &dense_path) == -1) {
+        return NetworkStatus::NoPath;
+    }
+
+    // Translate the path to user IDs while the version is still held
+    path.reserve(dense_path.size());
+    for (int user : dense_path) {
+        path.push_back(scope.graph->userId(user));
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Perform a breadth-first search from a given user.
+ * @param user_id The ID of the user to start the search from.
+ * @param order Receives the IDs of the reached users in visiting order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus NetworkReader::BFS(UserId user_id, std::vector<UserId>& order) {
+    order.clear();
+    if (!acquireSlot()) {
+        return NetworkStatus::UserNotFound;
+    }
+    ReadScope scope(publisher, reader);
+    int start = scope.graph->indexOf(user_id);
+    if (start == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+
+    bfs_engine.run(*scope.graph, start, false, bfs_result);
+    order.reserve(bfs_result.order.size());
+    for (int index : bfs_result.order) {
+        order.push_back(scope.graph->userId(index));
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Take a reader slot if the reader has none yet.
+ * @return true if the reader holds a slot, false if the publisher still has no free one.
+ */
+bool NetworkReader::acquireSlot() {
+    if (reader == -1) {
+        reader = publisher.registerReader();
+    }
+    return reader != -1;
+}
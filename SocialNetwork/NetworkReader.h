@@ -0,0 +1,121 @@
+#ifndef NETWORKREADER_H
+#define NETWORKREADER_H
+
+#include <cstdint>
+#include <vector>
+#include "BidirectionalSearch.h"
+#include "BreadthFirstSearch.h"
+#include "NetworkStatus.h"
+#include "SnapshotPublisher.h"
+#include "UserId.h"
+
+
+/**
+ * @class NetworkReader
+ * @brief Answers queries on the latest published version of a network from one reader thread.
+ *
+ * Each query reads the version that is current when it starts, through the publisher's epoch protocol, so it
+ * never takes a lock and never waits for the writer. A reader keeps its own search scratch state and must only
+ * be used by one thread at a time; create one reader per thread.
+ *
+ * A reader created while the publisher had no free slot retries registration at each query. Until it gets a slot,
+ * queries answer as if the network were empty.
+ */
+class NetworkReader {
+public:
+    /**
+     * @brief Construct a Network Reader object and register it with a publisher.
+     * @param publisher The publisher to read from. It must outlive the reader.
+     */
+    explicit NetworkReader(SnapshotPublisher& publisher);
+
+    /**
+     * @brief Unregister the reader.
+     */
+    ~NetworkReader();
+
+    NetworkReader(const NetworkReader&) = delete;
+    NetworkReader& operator=(const NetworkReader&) = delete;
+
+    /**
+     * @brief Check if the reader got a slot from its publisher.
+     * @return true if the reader holds a slot, false if the publisher had no free reader slot so far.
+     */
+    bool isRegistered() const;
+
+    /**
+     * @brief Get the version of the network the next query will read.
+     * @return The number of versions published so far.
+     */
+    std::uint64_t version() const;
+
+    /**
+     * @brief Check if a user is in the network.
+     * @param user_id The ID of the user.
+     * @return true if the user is in the network, false otherwise.
+     */
+    bool hasUser(UserId user_id);
+
+    /**
+     * @brief Get the number of users in the network.
+     * @return The number of users in the network.
+     */
+    int numberOfUsers();
+
+    /**
+     * @brief Get the number of connections in the network.
+     * @return The number of connections in the network.
+     */
+    long long numberOfConnections();
+
+    /**
+     * @brief Check if two users are connected.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return true if the two users are connected or are the same existing user, false otherwise.
+     */
+    bool isConnected(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Find the length of the shortest path between two users.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+     */
+    int findShortestPath(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Find the shortest path between two users.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+     * @return Ok, UserNotFound or NoPath.
+     */
+    NetworkStatus findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path);
+
+    /**
+     * @brief Perform a breadth-first search from a given user.
+     *
+     * Users are listed level by level, in no particular order within a level, which saves a pass over the edges.
+     * @param user_id The ID of the user to start the search from.
+     * @param order Receives the IDs of the reached users in visiting order.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus BFS(UserId user_id, std::vector<UserId>& order);
+
+private:
+    SnapshotPublisher& publisher;  // The publisher of the versions.
+    int reader;  // The reader slot, -1 if none was free.
+    BidirectionalSearch path_search;  // Reusable scratch state for findShortestPath.
+    std::vector<int> dense_path;  // Reusable dense indices of a path.
+    BreadthFirstSearch bfs_engine;  // Reusable scratch state for BFS.
+    BfsResult bfs_result;  // Reusable result arrays for BFS.
+
+    /**
+     * @brief Take a reader slot if the reader has none yet.
+     * @return true if the reader holds a slot, false if the publisher still has no free one.
+     */
+    bool acquireSlot();
+};
+
+#endif // NETWORKREADER_H
@@ -0,0 +1,359 @@
+#include "NetworkSnapshot.h"
+#include "MutationJournal.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+    const std::uint64_t kMagic = 0x50414E534B52544EULL;  // "NTRKSNAP" read as a little-endian word
+    const std::uint32_t kByteOrderMark = 0x01020304;
+    const std::uint32_t kVersion = 2;
+    const std::size_t kAlignment = 64;
+
+    /**
+     * @struct FileHeader
+     * @brief The header at the start of a snapshot file.
+     */
+    struct FileHeader {
+        std::uint64_t magic;  // Identifies a snapshot file.
+        std::uint32_t byte_order;  // kByteOrderMark as written by the saving machine.
+        std::uint32_t version;  // Format version.
+        std::uint64_t header_size;  // Size of the header block, the user IDs start here.
+        std::uint64_t num_users;  // Number of users.
+        std::uint64_t num_neighbors;  // Number of entries in the neighbor array.
+        std::uint64_t payload_checksum;  // Checksum of the three arrays.
+        std::uint64_t header_checksum;  // Checksum of the fields above.
+    };
+
+    static_assert(sizeof(int) == 4, "snapshot files store 32-bit dense indices");
+    static_assert(sizeof(FileHeader) <= kAlignment, "the header must fit in one aligned block");
+
+    /**
+     * @brief Round a size up to the section alignment.
+     * @param size The size to round.
+     * @return The smallest multiple of kAlignment not below size.
+     */
+    std::uint64_t alignUp(std::uint64_t size) {
+        return (size + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    /**
+     * @brief Fold bytes into a Fletcher-style checksum of 32-bit words.
+     *
+     * Fletcher sums catch byte reordering as well as changed bytes, and run at memory speed.
+     * @param data The bytes to fold in, their count must be a multiple of 4.
+     * @param size The number of bytes.
+     * @param sum1 The running sum of the words.
+     * @param sum2 The running sum of sum1.
+     */
+    void checksum(const unsigned char* data, std::size_t size, std::uint64_t& sum1, std::uint64_t& sum2) {
+        for (std::size_t position = 0; position + 4 <= size; position += 4) {
+            std::uint32_t word;
+            std::memcpy(&word, data + position, 4);
+            sum1 += word;
+            sum2 += sum1;
+        }
+    }
+
+    /**
+     * @brief Compute the checksum of the three arrays of a snapshot.
+     * @param user_ids The user ID array.
+     * @param offsets The offset array.
+     * @param neighbors The neighbor array.
+     * @param num_users The number of users.
+     * @param num_neighbors The number of entries in the neighbor array.
+     * @return The checksum of the arrays.
+     */
+    std::uint64_t payloadChecksum(const UserId* user_ids, const std::int64_t* offsets, const int* neighbors,
+                                  std::uint64_t num_users, std::uint64_t num_neighbors) {
+        std::uint64_t sum1 = 0;
+        std::uint64_t sum2 = 0;
+        checksum(reinterpret_cast<const unsigned char*>(user_ids), num_users * sizeof(UserId), sum1, sum2);
+        checksum(reinterpret_cast<const unsigned char*>(offsets), (num_users + 1) * sizeof(std::int64_t), sum1, sum2);
+        checksum(reinterpret_cast<const unsigned char*>(neighbors), num_neighbors * sizeof(int), sum1, sum2);
+        return (sum2 << 32) ^ sum1;
+    }
+
+    /**
+     * @brief Compute the checksum of the fields of a header before header_checksum.
+     * @param header The header.
+     * @return The checksum of the header.
+     */
+    std::uint64_t headerChecksum(const FileHeader& header) {
+        std::uint64_t sum1 = 0;
+        std::uint64_t sum2 = 0;
+        checksum(reinterpret_cast<const unsigned char*>(&header), offsetof(FileHeader, header_checksum), sum1, sum2);
+        return (sum2 << 32) ^ sum1;
+    }
+
+    /**
+     * @brief Write zero bytes up to the next section boundary.
+     * @param file The file being written.
+     * @param written The number of bytes written so far, updated.
+     */
+    void pad(std::ofstream& file, std::uint64_t& written) {
+        static const char zeros[kAlignment] = {};
+        std::uint64_t aligned = alignUp(written);
+        file.write(zeros, static_cast<std::streamsize>(aligned - written));
+        written = aligned;
+    }
+}
+
+/**
+ * @brief Default constructor for NetworkSnapshot class.
+ * Creates a snapshot of an empty network.
+ */
+NetworkSnapshot::NetworkSnapshot() : owned_offsets(1, 0) {
+    user_ids = owned_user_ids.data();
+    offsets = owned_offsets.data();
+    neighbors = owned_neighbors.data();
+    num_users = 0;
+    num_neighbors = 0;
+}
+
+
+/**
+ * @brief Construct a snapshot from CSR arrays.
+ * @param user_ids The user ID of every dense index, in ascending order.
+ * @param offsets The start of every user's neighbors, with a final entry equal to the number of neighbors.
+ * @param neighbors The dense indices of all neighbors, sorted within each user.
+ */
+NetworkSnapshot::NetworkSnapshot(std::vector<UserId> user_ids, std::vector<std::int64_t> offsets, std::vector<int> neighbors)
+    : owned_user_ids(std::move(user_ids)), owned_offsets(std::move(offsets)), owned_neighbors(std::move(neighbors)) {
+    this->user_ids = owned_user_ids.data();
+    this->offsets = owned_offsets.data();
+    this->neighbors = owned_neighbors.data();
+    num_users = static_cast<int>(owned_user_ids.size());
+    num_neighbors = static_cast<std::int64_t>(owned_neighbors.size());
+}
+
+
+/**
+ * @brief Map a snapshot file and query it in place.
+ * @param path The path of the file.
+ * @param verify_checksum If true, the payload checksum is checked as well.
+ * @return The mapped snapshot, or nullptr if the file is missing, truncated or not a valid snapshot.
+ */
+std::shared_ptr<const NetworkSnapshot> NetworkSnapshot::open(const std::string& path, bool verify_checksum) {
+    std::shared_ptr<NetworkSnapshot> snapshot = std::make_shared<NetworkSnapshot>();
+    MappedFile& file = snapshot->mapping;
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) {
+        return nullptr;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(FileHeader));
+    if (header.magic != kMagic || header.byte_order != kByteOrderMark || header.version != kVersion
+        || header.header_checksum != headerChecksum(header) || header.num_users > 0x7FFFFFFF) {
+        return nullptr;
+    }
+
+    // Bound the counts by the file size first, so the section arithmetic below cannot overflow
+    if (header.header_size > file.size() || header.num_users > file.size() / sizeof(UserId)
+        || header.num_neighbors > file.size() / sizeof(int)) {
+        return nullptr;
+    }
+
+    // Check that every section lies inside the file
+    std::uint64_t offsetsStart = header.header_size + alignUp(header.num_users * sizeof(UserId));
+    std::uint64_t neighborsStart = offsetsStart + alignUp((header.num_users + 1) * sizeof(std::int64_t));
+    std::uint64_t end = neighborsStart + header.num_neighbors * sizeof(int);
+    if (header.header_size % kAlignment != 0 || end > file.size()) {
+        return nullptr;
+    }
+
+    snapshot->user_ids = reinterpret_cast<const UserId*>(file.data() + header.header_size);
+    snapshot->offsets = reinterpret_cast<const std::int64_t*>(file.data() + offsetsStart);
+    snapshot->neighbors = reinterpret_cast<const int*>(file.data() + neighborsStart);
+    snapshot->num_users = static_cast<int>(header.num_users);
+    snapshot->num_neighbors = static_cast<std::int64_t>(header.num_neighbors);
+
+    if (!snapshot->isWellFormed()) {
+        return nullptr;
+    }
+    if (verify_checksum && header.payload_checksum != payloadChecksum(snapshot->user_ids, snapshot->offsets,
+                                                                      snapshot->neighbors, header.num_users,
+                                                                      header.num_neighbors)) {
+        return nullptr;
+    }
+    return snapshot;
+}
+
+
+/**
+ * @brief Check that the arrays describe a graph queries can walk without leaving them.
+ * @return true if the user IDs ascend, the offsets rise from 0 to the number of neighbors and every neighbor is a
+ *         dense index, false otherwise.
+ */
+bool NetworkSnapshot::isWellFormed() const {
+    if (offsets[0] != 0 || offsets[num_users] != num_neighbors) {
+        return false;
+    }
+    for (int index = 0; index < num_users; index++) {
+        if (offsets[index] > offsets[index + 1] || (index > 0 && user_ids[index - 1] >= user_ids[index])) {
+            return false;
+        }
+    }
+    for (std::int64_t position = 0; position < num_neighbors; position++) {
+        if (static_cast<unsigned>(neighbors[position]) >= static_cast<unsigned>(num_users)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Write the snapshot to a file that open() can map.
+ * @param path The path of the file.
+ * @return true if the file was written, false otherwise.
+ */
+bool NetworkSnapshot::save(const std::string& path) const {
+    // Write next to the target and rename, so a mapping of the old file is never truncated under its readers
+    const std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(FileHeader));
+    header.magic = kMagic;
+    header.byte_order = kByteOrderMark;
+    header.version = kVersion;
+    header.header_size = kAlignment;
+    header.num_users = static_cast<std::uint64_t>(num_users);
+    header.num_neighbors = static_cast<std::uint64_t>(num_neighbors);
+    header.payload_checksum = payloadChecksum(user_ids, offsets, neighbors, header.num_users, header.num_neighbors);
+    header.header_checksum = headerChecksum(header);
+
+    std::uint64_t written = sizeof(FileHeader);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    pad(file, written);
+
+    // Sections are aligned so they can be read in place once mapped
+    file.write(reinterpret_cast<const char*>(user_ids), static_cast<std::streamsize>(num_users * sizeof(UserId)));
+    written += num_users * sizeof(UserId);
+    pad(file, written);
+    file.write(reinterpret_cast<const char*>(offsets), static_cast<std::streamsize>((num_users + 1) * sizeof(std::int64_t)));
+    written += (num_users + 1) * sizeof(std::int64_t);
+    pad(file, written);
+    file.write(reinterpret_cast<const char*>(neighbors), static_cast<std::streamsize>(num_neighbors * sizeof(int)));
+    file.close();
+    if (!file) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    // The new contents must be on disk before they replace the old file, or a crash could leave a short file
+    if (!MutationJournal::syncFile(temporaryPath)) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows, MoveFileEx does so in one step
+    bool replaced = MoveFileExA(temporaryPath.c_str(), path.c_str(),
+                                MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    bool replaced = std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+    if (!replaced) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    // Flush the directory entry of the rename as well
+    return MutationJournal::syncFile(path);
+}
+
+
+/**
+ * @brief Check if the snapshot reads its arrays from a mapped file.
+ * @return true if the snapshot is memory-mapped, false if it owns its arrays.
+ */
+bool NetworkSnapshot::isMapped() const {
+    return mapping.data() != nullptr;
+}
+
+
+/**
+ * @brief Get the number of users in the snapshot.
+ * @return The number of users in the snapshot.
+ */
+int NetworkSnapshot::numberOfUsers() const {
+    return num_users;
+}
+
+
+/**
+ * @brief Get the number of connections in the snapshot.
+ * @return The number of undirected connections in the snapshot.
+ */
+std::int64_t NetworkSnapshot::numberOfConnections() const {
+    // Each connection is stored in the rows of both users
+    return num_neighbors / 2;
+}
+
+
+/**
+ * @brief Get the ID of the user at a dense index.
+ * @param index The dense index of the user.
+ * @return The ID of the user.
+ */
+UserId NetworkSnapshot::userId(int index) const {
+    return user_ids[index];
+}
+
+
+/**
+ * @brief Find the dense index of a user with a binary search over the sorted IDs.
+ * @param user_id The ID of the user to find.
+ * @return The dense index of the user if found, -1 otherwise.
+ */
+int NetworkSnapshot::indexOf(UserId user_id) const {
+    const UserId* it = std::lower_bound(user_ids, user_ids + num_users, user_id);
+    if (it == user_ids + num_users || *it != user_id) {
+        return -1;
+    }
+    return static_cast<int>(it - user_ids);
+}
+
+
+/**
+ * @brief Get the number of connections of a user.
+ * @param index The dense index of the user.
+ * @return The number of connections of the user.
+ */
+int NetworkSnapshot::degree(int index) const {
+    return static_cast<int>(offsets[index + 1] - offsets[index]);
+}
+
+
+/**
+ * @brief Get the first neighbor of a user.
+ * @param index The dense index of the user.
+ * @return A pointer to the dense index of the user's first neighbor.
+ */
+const int* NetworkSnapshot::neighborsBegin(int index) const {
+    return neighbors + offsets[index];
+}
+
+
+/**
+ * @brief Get the end of the neighbors of a user.
+ * @param index The dense index of the user.
+ * @return A pointer past the dense index of the user's last neighbor.
+ */
+const int* NetworkSnapshot::neighborsEnd(int index) const {
+    return neighbors + offsets[index + 1];
+}
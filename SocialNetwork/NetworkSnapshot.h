@@ -0,0 +1,142 @@
+#ifndef NETWORKSNAPSHOT_H
+#define NETWORKSNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "UserId.h"
+
+
+/**
+ * @class NetworkSnapshot
+ * @brief An immutable compressed-sparse-row (CSR) view of a social network.
+ *
+ * Users are renumbered to dense indices 0..numberOfUsers()-1 in ascending order of their IDs. The neighbors of
+ * the user at index i are stored contiguously in neighbors[offsets[i], offsets[i + 1]), sorted in ascending
+ * order, so both the indices and the IDs of the neighbors are sorted.
+ *
+ * A snapshot either owns its arrays or reads them in place from a memory-mapped snapshot file written by save().
+ * The file holds a header followed by the user ID, offset and neighbor arrays, each aligned to 64 bytes:
+ *
+ *   magic, byte-order mark, version, header size, users, neighbors, payload checksum, header checksum
+ *
+ * User IDs are stored as 64-bit values and neighbors as 32-bit dense indices. Version 1 files, which stored
+ * 32-bit user IDs, are rejected.
+ */
+class NetworkSnapshot {
+public:
+    /**
+     * @brief Construct an empty Network Snapshot object.
+     */
+    NetworkSnapshot();
+
+    /**
+     * @brief Construct a Network Snapshot object from CSR arrays.
+     * @param user_ids The user ID of every dense index, in ascending order.
+     * @param offsets The start of every user's neighbors, with a final entry equal to the number of neighbors.
+     * @param neighbors The dense indices of all neighbors, sorted within each user.
+     */
+    NetworkSnapshot(std::vector<UserId> user_ids, std::vector<std::int64_t> offsets, std::vector<int> neighbors);
+
+    NetworkSnapshot(const NetworkSnapshot&) = delete;
+    NetworkSnapshot& operator=(const NetworkSnapshot&) = delete;
+
+    /**
+     * @brief Map a snapshot file and query it in place.
+     *
+     * The header and the structure of the arrays are always validated, so a damaged file cannot make queries
+     * read outside the mapping: offsets must rise from 0 to the number of neighbors and every neighbor must be a
+     * dense index. The payload checksum also catches damage that keeps the structure valid, such as a changed
+     * neighbor, and is optional.
+     * @param path The path of the file.
+     * @param verify_checksum If true, the payload checksum is checked as well.
+     * @return The mapped snapshot, or nullptr if the file is missing, truncated or not a valid snapshot.
+     */
+    static std::shared_ptr<const NetworkSnapshot> open(const std::string& path, bool verify_checksum = false);
+
+    /**
+     * @brief Write the snapshot to a file that open() can map.
+     *
+     * The file is written as path + ".tmp", flushed to disk and then renamed to path, so snapshots that still map an
+     * older file at path keep reading the old contents and a crash leaves either the old or the new file.
+     * @param path The path of the file.
+     * @return true if the file was written and flushed, false otherwise.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Check if the snapshot reads its arrays from a mapped file.
+     * @return true if the snapshot is memory-mapped, false if it owns its arrays.
+     */
+    bool isMapped() const;
+
+    /**
+     * @brief Get the number of users in the snapshot.
+     * @return The number of users in the snapshot.
+     */
+    int numberOfUsers() const;
+
+    /**
+     * @brief Get the number of connections in the snapshot.
+     * @return The number of undirected connections in the snapshot.
+     */
+    std::int64_t numberOfConnections() const;
+
+    /**
+     * @brief Get the ID of the user at a dense index.
+     * @param index The dense index of the user.
+     * @return The ID of the user.
+     */
+    UserId userId(int index) const;
+
+    /**
+     * @brief Find the dense index of a user.
+     * @param user_id The ID of the user to find.
+     * @return The dense index of the user if found, -1 otherwise.
+     */
+    int indexOf(UserId user_id) const;
+
+    /**
+     * @brief Get the number of connections of a user.
+     * @param index The dense index of the user.
+     * @return The number of connections of the user.
+     */
+    int degree(int index) const;
+
+    /**
+     * @brief Get the first neighbor of a user.
+     * @param index The dense index of the user.
+     * @return A pointer to the dense index of the user's first neighbor.
+     */
+    const int* neighborsBegin(int index) const;
+
+    /**
+     * @brief Get the end of the neighbors of a user.
+     * @param index The dense index of the user.
+     * @return A pointer past the dense index of the user's last neighbor.
+     */
+    const int* neighborsEnd(int index) const;
+
+private:
+    std::vector<UserId> owned_user_ids;  // Storage of user_ids when the snapshot owns its arrays.
+    std::vector<std::int64_t> owned_offsets;  // Storage of offsets when the snapshot owns its arrays.
+    std::vector<int> owned_neighbors;  // Storage of neighbors when the snapshot owns its arrays.
+    MappedFile mapping;  // The mapped snapshot file, if the arrays are read in place.
+
+    const UserId* user_ids;  // User ID of every dense index, sorted ascending.
+    const std::int64_t* offsets;  // Row offsets into neighbors, num_users + 1 entries.
+    const int* neighbors;  // Dense indices of the neighbors of every user, row by row.
+    int num_users;  // The number of users.
+    std::int64_t num_neighbors;  // The number of entries in neighbors, twice the number of connections.
+
+    /**
+     * @brief Check that the arrays describe a graph queries can walk without leaving them.
+     * @return true if the user IDs ascend, the offsets rise from 0 to the number of neighbors and every neighbor is
+     *         a dense index, false otherwise.
+     */
+    bool isWellFormed() const;
+};
+
+#endif // NETWORKSNAPSHOT_H
@@ -0,0 +1,157 @@
+#include "NetworkStatistics.h"
+#include <algorithm>
+
+/**
+ * @brief Default constructor for NetworkStatistics class.
+ * Starts with the statistics of an empty network.
+ */
+NetworkStatistics::NetworkStatistics() {
+    clear();
+}
+
+
+/**
+ * @brief Count a new user.
+ * @param degree The number of connections of the user.
+ */
+void NetworkStatistics::addUser(int degree) {
+    if (degree >= static_cast<int>(users_with_degree.size())) {
+        users_with_degree.resize(std::max<std::size_t>(degree + 1, users_with_degree.size() * 2), 0);
+    }
+    users_with_degree[degree]++;
+    histogram[bucketOf(degree)]++;
+    num_users++;
+    degree_sum += degree;
+    max_degree = std::max(max_degree, degree);
+}
+
+
+/**
+ * @brief Stop counting a user.
+ * @param degree The number of connections of the user.
+ */
+void NetworkStatistics::removeUser(int degree) {
+    users_with_degree[degree]--;
+    histogram[bucketOf(degree)]--;
+    num_users--;
+    degree_sum -= degree;
+
+    // The maximum only moves down past degrees nobody has anymore
+    while (max_degree > 0 && users_with_degree[max_degree] == 0) {
+        max_degree--;
+    }
+}
+
+
+/**
+ * @brief Move a user from one degree to another.
+ * @param from The previous number of connections of the user.
+ * @param to The new number of connections of the user.
+ */
+void NetworkStatistics::changeDegree(int from, int to) {
+    // Add first so the maximum never drops below the new degree
+    addUser(to);
+    removeUser(from);
+}
+
+
+/**
+ * @brief Count a new connection between two users.
+ * @param degree1 The number of connections of the first user before the change.
+ * @param degree2 The number of connections of the second user before the change.
+ */
+void NetworkStatistics::addConnection(int degree1, int degree2) {
+    changeDegree(degree1, degree1 + 1);
+    changeDegree(degree2, degree2 + 1);
+}
+
+
+/**
+ * @brief Stop counting a connection between two users.
+ * @param degree1 The number of connections of the first user before the change.
+ * @param degree2 The number of connections of the second user before the change.
+ */
+void NetworkStatistics::removeConnection(int degree1, int degree2) {
+    changeDegree(degree1, degree1 - 1);
+    changeDegree(degree2, degree2 - 1);
+}
+
+
+/**
+ * @brief Reset to the statistics of an empty network.
+ */
+void NetworkStatistics::clear() {
+    std::vector<int>().swap(users_with_degree);
+    std::fill(histogram, histogram + kBuckets, 0);
+    num_users = 0;
+    degree_sum = 0;
+    max_degree = 0;
+}
+
+
+/**
+ * @brief Get the number of users.
+ * @return The number of users.
+ */
+int NetworkStatistics::numberOfUsers() const {
+    return num_users;
+}
+
+
+/**
+ * @brief Get the number of connections.
+ * @return The number of undirected connections.
+ */
+std::int64_t NetworkStatistics::numberOfConnections() const {
+    // Each connection adds to the degree of both users
+    return degree_sum / 2;
+}
+
+
+/**
+ * @brief Get the highest number of connections of any user.
+ * @return The maximum degree, 0 for an empty network.
+ */
+int NetworkStatistics::maxDegree() const {
+    return max_degree;
+}
+
+
+/**
+ * @brief Get the average number of connections per user.
+ * @return The average degree, 0 for an empty network.
+ */
+double NetworkStatistics::averageDegree() const {
+    if (num_users == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(degree_sum) / num_users;
+}
+
+
+/**
+ * @brief Get the number of users in every degree bucket.
+ * @return The counts of the buckets up to the last nonempty one.
+ */
+std::vector<std::int64_t> NetworkStatistics::degreeHistogram() const {
+    int buckets = kBuckets;
+    while (buckets > 0 && histogram[buckets - 1] == 0) {
+        buckets--;
+    }
+    return std::vector<std::int64_t>(histogram, histogram + buckets);
+}
+
+
+/**
+ * @brief Get the histogram bucket of a degree.
+ * @param degree The number of connections.
+ * @return 0 for degree 0, otherwise floor(log2(degree)) + 1.
+ */
+int NetworkStatistics::bucketOf(int degree) {
+    int bucket = 0;
+    while (degree > 0) {
+        degree >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
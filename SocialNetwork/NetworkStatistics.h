@@ -0,0 +1,112 @@
+#ifndef NETWORKSTATISTICS_H
+#define NETWORKSTATISTICS_H
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @class NetworkStatistics
+ * @brief Degree statistics of a network, updated on every change instead of recomputed.
+ *
+ * The network reports every user it adds or removes and every change of a user's degree. From those the
+ * statistics keep the number of users, the sum of all degrees (twice the number of connections), the number of
+ * users of every exact degree, which tracks the maximum degree as it shrinks, and a histogram over power-of-two
+ * degree buckets. Every count reads in O(1), and the histogram in O(buckets).
+ */
+class NetworkStatistics {
+public:
+    // Number of histogram buckets, enough for any int degree
+    static const int kBuckets = 32;
+
+    /**
+     * @brief Construct the statistics of an empty network.
+     */
+    NetworkStatistics();
+
+    /**
+     * @brief Count a new user.
+     * @param degree The number of connections of the user.
+     */
+    void addUser(int degree = 0);
+
+    /**
+     * @brief Stop counting a user.
+     * @param degree The number of connections of the user.
+     */
+    void removeUser(int degree);
+
+    /**
+     * @brief Move a user from one degree to another.
+     * @param from The previous number of connections of the user.
+     * @param to The new number of connections of the user.
+     */
+    void changeDegree(int from, int to);
+
+    /**
+     * @brief Count a new connection between two users.
+     * @param degree1 The number of connections of the first user before the change.
+     * @param degree2 The number of connections of the second user before the change.
+     */
+    void addConnection(int degree1, int degree2);
+
+    /**
+     * @brief Stop counting a connection between two users.
+     * @param degree1 The number of connections of the first user before the change.
+     * @param degree2 The number of connections of the second user before the change.
+     */
+    void removeConnection(int degree1, int degree2);
+
+    /**
+     * @brief Reset to the statistics of an empty network.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of users.
+     * @return The number of users.
+     */
+    int numberOfUsers() const;
+
+    /**
+     * @brief Get the number of connections.
+     * @return The number of undirected connections.
+     */
+    std::int64_t numberOfConnections() const;
+
+    /**
+     * @brief Get the highest number of connections of any user.
+     * @return The maximum degree, 0 for an empty network.
+     */
+    int maxDegree() const;
+
+    /**
+     * @brief Get the average number of connections per user.
+     * @return The average degree, 0 for an empty network.
+     */
+    double averageDegree() const;
+
+    /**
+     * @brief Get the number of users in every degree bucket.
+     *
+     * Bucket 0 counts the users without connections, and bucket b > 0 the users with a degree in [2^(b-1), 2^b).
+     * @return The counts of the buckets up to the last nonempty one.
+     */
+    std::vector<std::int64_t> degreeHistogram() const;
+
+    /**
+     * @brief Get the histogram bucket of a degree.
+     * @param degree The number of connections.
+     * @return 0 for degree 0, otherwise floor(log2(degree)) + 1.
+     */
+    static int bucketOf(int degree);
+
+private:
+    std::vector<int> users_with_degree;  // The number of users of every degree, up to max_degree at least.
+    std::int64_t histogram[kBuckets];  // The number of users in every degree bucket.
+    int num_users;  // The number of users.
+    std::int64_t degree_sum;  // The sum of all degrees, twice the number of connections.
+    int max_degree;  // The highest degree of any user.
+};
+
+#endif // NETWORKSTATISTICS_H
@@ -0,0 +1,21 @@
+#ifndef NETWORKSTATUS_H
+#define NETWORKSTATUS_H
+
+
+/**
+ * @enum NetworkStatus
+ * @brief The outcome of an operation on a social network.
+ */
+enum class NetworkStatus {
+    Ok,  // The operation succeeded.
+    EmptyNetwork,  // The network has no users.
+    UserExists,  // A user with the given ID is already in the network.
+    UserNotFound,  // At least one of the given users is not in the network.
+    SelfConnection,  // Both given users are the same user.
+    ConnectionExists,  // The given users are already connected.
+    ConnectionNotFound,  // The given users are not connected.
+    NoPath,  // There is no path between the given users.
+    FileError  // A file could not be opened, read or written.
+};
+
+#endif // NETWORKSTATUS_H
@@ -0,0 +1,260 @@
+#include "PageRank.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+    const std::size_t kChunkUsers = 1 << 12;  // Users per chunk of work and per partial sum.
+
+    /**
+     * @brief Rescale the scores of every connected component to the total the component has at convergence.
+     *
+     * Score only moves between components through the teleport distribution, so the total of a component
+     * converges at the damping rate, the slowest rate of the iteration. A component that merged with another or
+     * split off since the scores were computed starts with the wrong total, which the iterations would take long
+     * to correct. Its converged total follows from the teleport distribution alone: s * T for a component with
+     * teleport mass T, and (1 - d) * s * t for a user without connections with teleport probability t, where
+     * s = 1 / (1 - d * T_isolated) and T_isolated is the teleport mass of all users without connections.
+     *
+     * The two sides of a bipartite component, which includes every tree, swap their score each iteration, so the
+     * split between them settles at the damping rate as well. It is set directly too: side A of a component
+     * converges to s * (T_A + d * T_B) / (1 + d).
+     * @param graph The snapshot being ranked.
+     * @param damping The damping factor.
+     * @param teleportOf Returns the teleport probability of a user.
+     * @param scores The scores to rescale, summing to 1.
+     */
+    template <typename Teleport>
+    void rescaleComponents(const NetworkSnapshot& graph, double damping, const Teleport& teleportOf,
+                           std::vector<double>& scores) {
+        const int users = graph.numberOfUsers();
+
+        // Label the components with a union-find that tracks the side of every user relative to its root
+        std::vector<int> root(users);
+        std::vector<char> side(users, 0);
+        std::vector<char> oddCycle(users, 0);
+        for (int user = 0; user < users; user++) {
+            root[user] = user;
+        }
+        auto find = [&root, &side](int user) {
+            int top = user;
+            int parity = 0;
+            while (root[top] != top) {
+                parity ^= side[top];
+                top = root[top];
+            }
+            // Point the path at the root, with the side of every user relative to it
+            while (root[user] != user) {
+                int next = root[user];
+                int step = side[user];
+                root[user] = top;
+                side[user] = static_cast<char>(parity);
+                parity ^= step;
+                user = next;
+            }
+            return top;
+        };
+        for (int user = 0; user < users; user++) {
+            for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                if (*neighbor > user) {
+                    int root1 = find(user);
+                    int root2 = find(*neighbor);
+                    if (root1 == root2) {
+                        oddCycle[root1] |= side[user] == side[*neighbor];
+                    }
+                    else {
+                        int low = std::min(root1, root2);
+                        int high = std::max(root1, root2);
+                        root[high] = low;
+                        side[high] = static_cast<char>(side[user] ^ side[*neighbor] ^ 1);
+                        oddCycle[low] |= oddCycle[high];
+                    }
+                }
+            }
+        }
+
+        // Current and teleport totals of both sides of every component, and their degree sums, kept at the root
+        std::vector<double> current(2 * static_cast<std::size_t>(users), 0.0);
+        std::vector<double> teleport(2 * static_cast<std::size_t>(users), 0.0);
+        std::vector<double> degrees(2 * static_cast<std::size_t>(users), 0.0);
+        double isolatedTeleport = 0;
+        for (int user = 0; user < users; user++) {
+            int component = find(user);
+            std::size_t slot = 2 * static_cast<std::size_t>(component) + (oddCycle[component] ? 0 : side[user]);
+            current[slot] += scores[user];
+            teleport[slot] += teleportOf(user);
+            degrees[slot] += graph.degree(user);
+            isolatedTeleport += graph.degree(user) > 0 ? 0.0 : teleportOf(user);
+        }
+
+        const double scale = 1 / (1 - damping * isolatedTeleport);
+        for (int user = 0; user < users; user++) {
+            int component = root[user];
+            std::size_t slot = 2 * static_cast<std::size_t>(component) + (oddCycle[component] ? 0 : side[user]);
+            double target;
+            if (graph.degree(user) == 0) {
+                target = (1 - damping) * scale * teleport[slot];
+            }
+            else if (oddCycle[component]) {
+                target = scale * teleport[slot];
+            }
+            else {
+                target = scale * (teleport[slot] + damping * teleport[slot ^ 1]) / (1 + damping);
+            }
+
+            if (current[slot] > 0) {
+                scores[user] *= target / current[slot];
+            }
+            else {
+                // No score to rescale: spread the total by degree, the shape of the scores without teleports
+                scores[user] = degrees[slot] > 0 ? target * graph.degree(user) / degrees[slot] : target;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Rank the users of a snapshot with PageRank in parallel.
+ * @param graph The snapshot to rank.
+ * @param pool The thread pool to rank on.
+ * @param options The damping, tolerance and iteration limit.
+ * @param seeds The dense indices of the users to teleport to, or empty to teleport to every user.
+ * @param initial The scores to start from, indexed like graph, or empty to start from the teleport distribution.
+ * @param result Receives the scores.
+ */
+void computePageRank(const NetworkSnapshot& graph, ThreadPool& pool, const PageRankOptions& options,
+                     const std::vector<int>& seeds, const std::vector<double>& initial, PageRankResult& result) {
+    const int users = graph.numberOfUsers();
+    const double damping = options.damping;
+    result.scores.assign(users, 0.0);
+    result.iterations = 0;
+    result.residual = 0;
+    result.converged = true;
+    if (users == 0) {
+        return;
+    }
+
+    // The teleport distribution, stored only when it is not uniform
+    std::vector<double> teleport;
+    const double uniform = 1.0 / users;
+    if (!seeds.empty()) {
+        teleport.assign(users, 0.0);
+        for (int seed : seeds) {
+            teleport[seed] += 1.0 / seeds.size();
+        }
+    }
+    auto teleportOf = [&teleport, uniform](int user) {
+        return teleport.empty() ? uniform : teleport[user];
+    };
+
+    // Start from the normalized initial scores, or from the teleport distribution
+    std::vector<double>& scores = result.scores;
+    double initialTotal = 0;
+    if (initial.size() == static_cast<std::size_t>(users)) {
+        for (double score : initial) {
+            initialTotal += std::max(score, 0.0);
+        }
+    }
+    for (int user = 0; user < users; user++) {
+        scores[user] = initialTotal > 0 ? std::max(initial[user], 0.0) / initialTotal : teleportOf(user);
+    }
+    if (initialTotal > 0) {
+        rescaleComponents(graph, damping, teleportOf, scores);
+    }
+
+    const std::size_t chunks = (users + kChunkUsers - 1) / kChunkUsers;
+    std::vector<double> danglingParts(chunks, 0.0);
+    std::vector<double> residualParts(chunks, 0.0);
+    std::vector<double> contribution(users);
+    std::vector<double> nextContribution(users);
+    std::vector<double> nextScores(users);
+
+    // The share of every user's score passed to each neighbor, and the scores of users without connections
+    pool.parallelForChunks(users, kChunkUsers, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        double dangling = 0;
+        for (int user = static_cast<int>(begin); user < static_cast<int>(end); user++) {
+            int degree = graph.degree(user);
+            contribution[user] = degree > 0 ? scores[user] / degree : 0.0;
+            dangling += degree > 0 ? 0.0 : scores[user];
+        }
+        danglingParts[chunk] = dangling;
+    });
+
+    while (result.iterations < options.max_iterations) {
+        double dangling = 0;
+        for (double part : danglingParts) {
+            dangling += part;
+        }
+        // Mass spread by the teleport distribution: the random jumps and the scores of users without connections
+        const double jump = (1 - damping) + damping * dangling;
+
+        pool.parallelForChunks(users, kChunkUsers, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+            double nextDangling = 0;
+            double residual = 0;
+            for (int user = static_cast<int>(begin); user < static_cast<int>(end); user++) {
+                double pulled = 0;
+                for (const int* neighbor = graph.neighborsBegin(user); neighbor != graph.neighborsEnd(user); ++neighbor) {
+                    pulled += contribution[*neighbor];
+                }
+                double score = jump * teleportOf(user) + damping * pulled;
+                residual += std::fabs(score - scores[user]);
+                nextScores[user] = score;
+
+                int degree = graph.degree(user);
+                nextContribution[user] = degree > 0 ? score / degree : 0.0;
+                nextDangling += degree > 0 ? 0.0 : score;
+            }
+            danglingParts[chunk] = nextDangling;
+            residualParts[chunk] = residual;
+        });
+        scores.swap(nextScores);
+        contribution.swap(nextContribution);
+
+        result.iterations++;
+        result.residual = 0;
+        for (double part : residualParts) {
+            result.residual += part;
+        }
+        if (result.residual < options.tolerance) {
+            break;
+        }
+    }
+    result.converged = result.residual < options.tolerance;
+}
+
+
+/**
+ * @brief Carry scores over from an older snapshot to a newer one, matching users by ID.
+ * @param previous The snapshot the scores were computed on.
+ * @param scores The scores, indexed like previous.
+ * @param graph The snapshot to carry the scores to.
+ * @param carried Receives the scores, indexed like graph.
+ */
+void carryScores(const NetworkSnapshot& previous, const std::vector<double>& scores, const NetworkSnapshot& graph,
+                 std::vector<double>& carried) {
+    const int users = graph.numberOfUsers();
+    carried.assign(users, -1.0);
+
+    // Both snapshots are in ascending ID order
+    double matchedTotal = 0;
+    int matched = 0;
+    int position = 0;
+    for (int user = 0; user < users; user++) {
+        UserId userId = graph.userId(user);
+        while (position < previous.numberOfUsers() && previous.userId(position) < userId) {
+            position++;
+        }
+        if (position < previous.numberOfUsers() && previous.userId(position) == userId) {
+            carried[user] = scores[position];
+            matchedTotal += scores[position];
+            matched++;
+        }
+    }
+
+    double newcomer = matched > 0 ? matchedTotal / matched : 0.0;
+    for (double& score : carried) {
+        if (score < 0) {
+            score = newcomer;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+
+
+/**
+ * @struct PageRankOptions
+ * @brief The parameters of a PageRank computation.
+ */
+struct PageRankOptions {
+    double damping = 0.85;  // The probability of following a connection rather than teleporting.
+    double tolerance = 1e-6;  // Stop once the scores change by less than this in total over one iteration.
+    int max_iterations = 100;  // Stop after this many iterations even if the scores have not converged.
+    bool warm_start = true;  // Start from the previous scores of the network, if there are any.
+};
+
+
+/**
+ * @struct PageRankResult
+ * @brief The PageRank scores of a snapshot.
+ *
+ * Per-user arrays use the dense indices of the snapshot that was ranked.
+ */
+struct PageRankResult {
+    std::vector<double> scores;  // The score of every user. The scores sum to 1.
+    int iterations;  // The number of iterations run.
+    double residual;  // The total change of the scores in the last iteration.
+    bool converged;  // true if the residual fell below the tolerance.
+};
+
+
+/**
+ * @brief Rank the users of a snapshot with PageRank in parallel.
+ *
+ * Every iteration pulls the new score of each user from the scores of its neighbors divided by their degrees,
+ * walking the sorted CSR rows in parallel. The contributions of the next iteration are written in the same pass,
+ * so an iteration reads the neighbor array once. Users without connections hand their score to the teleport
+ * distribution, which is uniform over all users, or over the seeds for personalized PageRank.
+ *
+ * Starting scores are normalized, and the total of every connected component is set to its converged value,
+ * which only depends on the teleport distribution. Totals otherwise converge at the damping rate, the slowest
+ * part of the iteration, so scores carried over from before components merged or split would take many
+ * iterations to settle.
+ *
+ * Partial sums are kept per chunk of users rather than per worker, so the result does not depend on the number of
+ * threads.
+ * @param graph The snapshot to rank.
+ * @param pool The thread pool to rank on.
+ * @param options The damping, tolerance and iteration limit.
+ * @param seeds The dense indices of the users to teleport to, or empty to teleport to every user.
+ * @param initial The scores to start from, indexed like graph, or empty to start from the teleport distribution.
+ * @param result Receives the scores.
+ */
+void computePageRank(const NetworkSnapshot& graph, ThreadPool& pool, const PageRankOptions& options,
+                     const std::vector<int>& seeds, const std::vector<double>& initial, PageRankResult& result);
+
+/**
+ * @brief Carry scores over from an older snapshot to a newer one, matching users by ID.
+ *
+ * Both snapshots list their users in ascending ID order, so the users are matched in one merge pass. Users that
+ * are new in graph start at the mean score of the users they were matched with.
+ * @param previous The snapshot the scores were computed on.
+ * @param scores The scores, indexed like previous.
+ * @param graph The snapshot to carry the scores to.
+ * @param carried Receives the scores, indexed like graph.
+ */
+void carryScores(const NetworkSnapshot& previous, const std::vector<double>& scores, const NetworkSnapshot& graph,
+                 std::vector<double>& carried);
+
+#endif // PAGERANK_H
@@ -0,0 +1,108 @@
+#include "ParallelSort.h"
+#include <algorithm>
+
+namespace {
+    // Below this size a comparison sort is faster than radix passes
+    const std::size_t kMinRadixKeys = 1 << 12;
+
+    /**
+     * @brief Sort a range of keys with a least-significant-digit radix sort on bytes.
+     *
+     * Bytes that are equal in every key are skipped, so keys that only use their low bits of each half (such
+     * as packed pairs of small indices) take few passes.
+     * @param keys The first key of the range, also receives the sorted keys.
+     * @param buffer Scratch space for as many keys as the range holds.
+     * @param count The number of keys in the range.
+     */
+    void radixSort(std::uint64_t* keys, std::uint64_t* buffer, std::size_t count) {
+        if (count < kMinRadixKeys) {
+            std::sort(keys, keys + count);
+            return;
+        }
+
+        // Count all byte values in one read of the keys
+        std::vector<std::size_t> histograms(8 * 256, 0);
+        for (std::size_t position = 0; position < count; position++) {
+            std::uint64_t key = keys[position];
+            for (int digit = 0; digit < 8; digit++) {
+                histograms[digit * 256 + ((key >> (8 * digit)) & 0xFF)]++;
+            }
+        }
+
+        std::uint64_t* source = keys;
+        std::uint64_t* target = buffer;
+        for (int digit = 0; digit < 8; digit++) {
+            std::size_t* histogram = &histograms[digit * 256];
+            // A byte that is the same in every key does not change the order
+            if (histogram[(keys[0] >> (8 * digit)) & 0xFF] == count) {
+                continue;
+            }
+            std::size_t offset = 0;
+            for (int value = 0; value < 256; value++) {
+                std::size_t bucket = histogram[value];
+                histogram[value] = offset;
+                offset += bucket;
+            }
+            for (std::size_t position = 0; position < count; position++) {
+                std::uint64_t key = source[position];
+                target[histogram[(key >> (8 * digit)) & 0xFF]++] = key;
+            }
+            std::swap(source, target);
+        }
+        if (source != keys) {
+            std::copy(source, source + count, keys);
+        }
+    }
+}
+
+/**
+ * @brief Sort 64-bit keys in ascending order on a thread pool.
+ * @param keys The keys to sort.
+ * @param pool The thread pool to sort on.
+ */
+void parallelSort(std::vector<std::uint64_t>& keys, ThreadPool& pool) {
+    const std::size_t count = keys.size();
+    std::vector<std::uint64_t> buffer(count);
+    const std::size_t workers = std::min<std::size_t>(pool.size(), std::max<std::size_t>(count / kMinRadixKeys, 1));
+
+    // Sort one run per worker
+    std::vector<std::size_t> bounds(workers + 1);
+    for (std::size_t run = 0; run <= workers; run++) {
+        bounds[run] = count * run / workers;
+    }
+    pool.parallelFor(workers, 1, [&keys, &buffer, &bounds](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t run = begin; run < end; run++) {
+            radixSort(keys.data() + bounds[run], buffer.data() + bounds[run], bounds[run + 1] - bounds[run]);
+        }
+    });
+
+    // Merge neighboring runs until one is left
+    std::vector<std::uint64_t>* source = &keys;
+    std::vector<std::uint64_t>* target = &buffer;
+    while (bounds.size() > 2) {
+        std::size_t runs = bounds.size() - 1;
+        std::size_t pairs = (runs + 1) / 2;
+        pool.parallelFor(pairs, 1, [&](unsigned, std::size_t begin, std::size_t end) {
+            for (std::size_t pair = begin; pair < end; pair++) {
+                std::size_t first = bounds[2 * pair];
+                std::size_t middle = bounds[std::min(2 * pair + 1, runs)];
+                std::size_t last = bounds[std::min(2 * pair + 2, runs)];
+                std::merge(source->begin() + first, source->begin() + middle,
+                           source->begin() + middle, source->begin() + last,
+                           target->begin() + first);
+            }
+        });
+
+        std::vector<std::size_t> merged;
+        for (std::size_t run = 0; run < runs; run += 2) {
+            merged.push_back(bounds[run]);
+        }
+        merged.push_back(count);
+        bounds.swap(merged);
+        std::swap(source, target);
+    }
+
+    if (source != &keys) {
+        keys.swap(buffer);
+    }
+}
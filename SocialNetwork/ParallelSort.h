@@ -0,0 +1,19 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+
+/**
+ * @brief Sort 64-bit keys in ascending order on a thread pool.
+ *
+ * The keys are split into one run per worker, the runs are radix sorted in parallel and then merged pairwise
+ * in parallel rounds through a buffer of the same size.
+ * @param keys The keys to sort.
+ * @param pool The thread pool to sort on.
+ */
+void parallelSort(std::vector<std::uint64_t>& keys, ThreadPool& pool);
+
+#endif // PARALLELSORT_H
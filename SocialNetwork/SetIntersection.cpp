@@ -0,0 +1,180 @@
+#include "SetIntersection.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SET_INTERSECTION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Gallop when one array is this many times larger than the other
+    const std::size_t kGallopRatio = 32;
+
+    /**
+     * @brief Intersect two sorted arrays with a scalar merge.
+     * @param a The first array.
+     * @param a_size The number of values in a.
+     * @param b The second array.
+     * @param b_size The number of values in b.
+     * @param out Receives the common values, or nullptr.
+     * @return The number of common values.
+     */
+    std::size_t scalarMerge(const int* a, std::size_t a_size, const int* b, std::size_t b_size, int* out) {
+        std::size_t count = 0;
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < a_size && j < b_size) {
+            if (a[i] < b[j]) {
+                i++;
+            }
+            else if (a[i] > b[j]) {
+                j++;
+            }
+            else {
+                if (out != nullptr) {
+                    out[count] = a[i];
+                }
+                count++;
+                i++;
+                j++;
+            }
+        }
+        return count;
+    }
+}
+
+/**
+ * @brief Intersect two sorted arrays with a block-wise merge.
+ * @param a The first array.
+ * @param a_size The number of values in a.
+ * @param b The second array.
+ * @param b_size The number of values in b.
+ * @param out Receives the common values, room for min(a_size, b_size) values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectMerge(const int* a, std::size_t a_size, const int* b, std::size_t b_size, int* out) {
+    std::size_t count = 0;
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+#ifdef SET_INTERSECTION_SSE2
+    while (i + 4 <= a_size && j + 4 <= b_size) {
+        __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+        // Compare the block of a with all four rotations of the block of b
+        __m128i equal = _mm_cmpeq_epi32(blockA, blockB);
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1))));
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2))));
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+
+        // Bit k is set if a[i + k] is in the block of b
+        for (int lane = 0; lane < 4; lane++) {
+            if (mask & (1 << lane)) {
+                if (out != nullptr) {
+                    out[count] = a[i + lane];
+                }
+                count++;
+            }
+        }
+
+        // Advance the block that ends with the smaller value, or both
+        int lastA = a[i + 3];
+        int lastB = b[j + 3];
+        if (lastA <= lastB) {
+            i += 4;
+        }
+        if (lastB <= lastA) {
+            j += 4;
+        }
+    }
+#endif
+
+    return count + scalarMerge(a + i, a_size - i, b + j, b_size - j, out != nullptr ? out + count : nullptr);
+}
+
+
+/**
+ * @brief Intersect a small sorted array with a much larger one by galloping through the larger one.
+ * @param small The smaller array.
+ * @param small_size The number of values in small.
+ * @param large The larger array.
+ * @param large_size The number of values in large.
+ * @param out Receives the common values, room for small_size values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectGalloping(const int* small, std::size_t small_size, const int* large, std::size_t large_size, int* out) {
+    std::size_t count = 0;
+    std::size_t low = 0;
+    for (std::size_t i = 0; i < small_size && low < large_size; i++) {
+        int value = small[i];
+
+        // Double the step until the window [low, high) contains value or reaches the end
+        std::size_t step = 1;
+        std::size_t high = low;
+        while (high < large_size && large[high] < value) {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        high = std::min(high + 1, large_size);
+
+        low = static_cast<std::size_t>(std::lower_bound(large + low, large + high, value) - large);
+        if (low < large_size && large[low] == value) {
+            if (out != nullptr) {
+                out[count] = value;
+            }
+            count++;
+            low++;
+        }
+    }
+    return count;
+}
+
+
+/**
+ * @brief Intersect a sorted array with a set stored as a bitmap.
+ * @param bitmap The set, bit v of word v / 64 is set if v is in it. It must cover every value of values.
+ * @param values The sorted array.
+ * @param size The number of values.
+ * @param out Receives the common values, room for size values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectBitmap(const std::uint64_t* bitmap, const int* values, std::size_t size, int* out) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        int value = values[i];
+        if ((bitmap[value >> 6] >> (value & 63)) & 1) {
+            if (out != nullptr) {
+                out[count] = value;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+
+/**
+ * @brief Intersect two sorted arrays with the kernel that suits their relative sizes.
+ * @param a The first array.
+ * @param a_size The number of values in a.
+ * @param b The second array.
+ * @param b_size The number of values in b.
+ * @param out Receives the common values, room for min(a_size, b_size) values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectSorted(const int* a, std::size_t a_size, const int* b, std::size_t b_size, int* out) {
+    if (a_size > b_size) {
+        std::swap(a, b);
+        std::swap(a_size, b_size);
+    }
+    if (a_size == 0) {
+        return 0;
+    }
+    if (b_size / a_size >= kGallopRatio) {
+        return intersectGalloping(a, a_size, b, b_size, out);
+    }
+    return intersectMerge(a, a_size, b, b_size, out);
+}
@@ -0,0 +1,65 @@
+#ifndef SETINTERSECTION_H
+#define SETINTERSECTION_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * Kernels that intersect sorted arrays of distinct non-negative integers, such as the neighbor rows of a
+ * NetworkSnapshot. Every kernel writes the common values in ascending order to out and returns how many there
+ * are; out may be nullptr to only count them.
+ */
+
+/**
+ * @brief Intersect two sorted arrays with a block-wise merge.
+ *
+ * Blocks of four values are compared all-against-all with SSE2 where the target supports it, and with a scalar
+ * merge otherwise. Best when both arrays have similar sizes.
+ * @param a The first array.
+ * @param a_size The number of values in a.
+ * @param b The second array.
+ * @param b_size The number of values in b.
+ * @param out Receives the common values, room for min(a_size, b_size) values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectMerge(const int* a, std::size_t a_size, const int* b, std::size_t b_size, int* out);
+
+/**
+ * @brief Intersect a small sorted array with a much larger one by galloping through the larger one.
+ *
+ * Each value of the small array is found with an exponential then a binary search that starts where the previous
+ * search ended, so the cost grows with the size of the small array and only logarithmically with the large one.
+ * @param small The smaller array.
+ * @param small_size The number of values in small.
+ * @param large The larger array.
+ * @param large_size The number of values in large.
+ * @param out Receives the common values, room for small_size values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectGalloping(const int* small, std::size_t small_size, const int* large, std::size_t large_size, int* out);
+
+/**
+ * @brief Intersect a sorted array with a set stored as a bitmap.
+ * @param bitmap The set, bit v of word v / 64 is set if v is in it. It must cover every value of values.
+ * @param values The sorted array.
+ * @param size The number of values.
+ * @param out Receives the common values, room for size values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectBitmap(const std::uint64_t* bitmap, const int* values, std::size_t size, int* out);
+
+/**
+ * @brief Intersect two sorted arrays with the kernel that suits their relative sizes.
+ *
+ * Galloping is used when one array is much larger than the other, the block-wise merge otherwise.
+ * @param a The first array.
+ * @param a_size The number of values in a.
+ * @param b The second array.
+ * @param b_size The number of values in b.
+ * @param out Receives the common values, room for min(a_size, b_size) values, or nullptr.
+ * @return The number of common values.
+ */
+std::size_t intersectSorted(const int* a, std::size_t a_size, const int* b, std::size_t b_size, int* out);
+
+#endif // SETINTERSECTION_H
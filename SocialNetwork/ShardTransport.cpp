@@ -0,0 +1,545 @@
+#include "ShardTransport.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "ThreadPool.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    /**
+     * @class ThreadTransport
+     * @brief Keeps the shard workers in the calling process and runs each round on a thread pool.
+     */
+    class ThreadTransport : public ShardTransport {
+    public:
+        ThreadTransport(int num_shards, unsigned num_threads) : num_threads(num_threads) {
+            workers.reserve(static_cast<std::size_t>(num_shards));
+            for (int shard = 0; shard < num_shards; shard++) {
+                workers.emplace_back(shard, num_shards);
+            }
+        }
+
+        int numberOfShards() const override {
+            return static_cast<int>(workers.size());
+        }
+
+        bool isHealthy() const override {
+            return true;
+        }
+
+        void call(int shard, ShardRequest& request, ShardReply& reply) override {
+            workers[shard].handle(request, reply);
+        }
+
+        void broadcast(std::vector<ShardRequest>& requests, std::vector<ShardReply>& replies) override {
+            // The pool is started on first use
+            if (!thread_pool) {
+                thread_pool.reset(new ThreadPool(num_threads));
+            }
+            replies.resize(workers.size());
+            thread_pool->parallelFor(workers.size(), 1, [&](unsigned, std::size_t begin, std::size_t end) {
+                for (std::size_t shard = begin; shard < end; shard++) {
+                    if (requests[shard].command != ShardCommand::None) {
+                        workers[shard].handle(requests[shard], replies[shard]);
+                    }
+                }
+            });
+        }
+
+    private:
+        std::vector<ShardWorker> workers;  // The worker of every shard.
+        std::unique_ptr<ThreadPool> thread_pool;  // Runs the shards, started on first use.
+        unsigned num_threads;  // Requested number of threads, 0 for the number of hardware threads.
+    };
+
+#ifndef _WIN32
+    typedef std::vector<unsigned char> Frame;  // A message on a socket: its length, then its fields.
+    typedef std::vector<std::pair<UserId, UserId>> Batch;  // (user, parent) messages, or (user, neighbor) pairs.
+
+#ifdef MSG_NOSIGNAL
+    const int kSendFlags = MSG_NOSIGNAL;  // A lost peer fails the write instead of raising SIGPIPE.
+#else
+    const int kSendFlags = 0;
+#endif
+
+    /**
+     * @brief Append a value to a frame.
+     * @param frame The frame.
+     * @param value The value, stored in native byte order since both ends run on the same machine.
+     */
+    template <typename T>
+    void put(Frame& frame, const T& value) {
+        const std::size_t size = frame.size();
+        frame.resize(size + sizeof(T));
+        std::memcpy(frame.data() + size, &value, sizeof(T));
+    }
+
+    /**
+     * @brief Append user IDs to a frame, after their count.
+     * @param frame The frame.
+     * @param values The user IDs.
+     */
+    void putIds(Frame& frame, const std::vector<UserId>& values) {
+        put(frame, static_cast<std::uint64_t>(values.size()));
+        const std::size_t size = frame.size();
+        frame.resize(size + values.size() * sizeof(UserId));
+        if (!values.empty()) {
+            std::memcpy(frame.data() + size, values.data(), values.size() * sizeof(UserId));
+        }
+    }
+
+    /**
+     * @brief Append pairs of user IDs to a frame, after their count.
+     * @param frame The frame.
+     * @param pairs The pairs.
+     */
+    void putBatch(Frame& frame, const Batch& pairs) {
+        put(frame, static_cast<std::uint64_t>(pairs.size()));
+        std::size_t size = frame.size();
+        frame.resize(size + pairs.size() * 2 * sizeof(UserId));
+        for (const std::pair<UserId, UserId>& pair : pairs) {
+            std::memcpy(frame.data() + size, &pair.first, sizeof(UserId));
+            std::memcpy(frame.data() + size + sizeof(UserId), &pair.second, sizeof(UserId));
+            size += 2 * sizeof(UserId);
+        }
+    }
+
+    /**
+     * @brief Append one batch per shard to a frame, after their count.
+     * @param frame The frame.
+     * @param batches The batches.
+     */
+    void putBatches(Frame& frame, const std::vector<Batch>& batches) {
+        put(frame, static_cast<std::uint64_t>(batches.size()));
+        for (const Batch& batch : batches) {
+            putBatch(frame, batch);
+        }
+    }
+
+    /**
+     * @brief Read a value from a frame.
+     * @param cursor The read position, advanced past the value.
+     * @param end The end of the frame.
+     * @param value Receives the value.
+     * @return true if the value was read, false if the frame ends first.
+     */
+    template <typename T>
+    bool get(const unsigned char*& cursor, const unsigned char* end, T& value) {
+        if (static_cast<std::size_t>(end - cursor) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Read the user IDs written by putIds().
+     * @param cursor The read position, advanced past the user IDs.
+     * @param end The end of the frame.
+     * @param values Receives the user IDs.
+     * @return true if the user IDs were read, false if the frame ends first.
+     */
+    bool getIds(const unsigned char*& cursor, const unsigned char* end, std::vector<UserId>& values) {
+        std::uint64_t count;
+        if (!get(cursor, end, count) || count > static_cast<std::size_t>(end - cursor) / sizeof(UserId)) {
+            return false;
+        }
+        values.resize(static_cast<std::size_t>(count));
+        if (count > 0) {
+            std::memcpy(values.data(), cursor, values.size() * sizeof(UserId));
+        }
+        cursor += values.size() * sizeof(UserId);
+        return true;
+    }
+
+    /**
+     * @brief Read the pairs written by putBatch().
+     * @param cursor The read position, advanced past the pairs.
+     * @param end The end of the frame.
+     * @param pairs Receives the pairs.
+     * @return true if the pairs were read, false if the frame ends first.
+     */
+    bool getBatch(const unsigned char*& cursor, const unsigned char* end, Batch& pairs) {
+        std::uint64_t count;
+        if (!get(cursor, end, count) || count > static_cast<std::size_t>(end - cursor) / (2 * sizeof(UserId))) {
+            return false;
+        }
+        pairs.resize(static_cast<std::size_t>(count));
+        for (std::pair<UserId, UserId>& pair : pairs) {
+            std::memcpy(&pair.first, cursor, sizeof(UserId));
+            std::memcpy(&pair.second, cursor + sizeof(UserId), sizeof(UserId));
+            cursor += 2 * sizeof(UserId);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read the batches written by putBatches().
+     * @param cursor The read position, advanced past the batches.
+     * @param end The end of the frame.
+     * @param batches Receives the batches.
+     * @return true if the batches were read, false if the frame ends first.
+     */
+    bool getBatches(const unsigned char*& cursor, const unsigned char* end, std::vector<Batch>& batches) {
+        std::uint64_t count;
+        if (!get(cursor, end, count) || count > static_cast<std::size_t>(end - cursor) / sizeof(std::uint64_t)) {
+            return false;
+        }
+        batches.resize(static_cast<std::size_t>(count));
+        for (Batch& batch : batches) {
+            if (!getBatch(cursor, end, batch)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Write a request into a frame.
+     * @param request The request.
+     * @param frame Receives the frame.
+     */
+    void encodeRequest(const ShardRequest& request, Frame& frame) {
+        frame.clear();
+        put(frame, std::uint64_t(0));
+        put(frame, static_cast<std::int32_t>(request.command));
+        put(frame, request.user);
+        put(frame, request.neighbor);
+        put(frame, static_cast<std::int32_t>(request.side));
+        put(frame, static_cast<std::int32_t>(request.level));
+        put(frame, static_cast<std::uint8_t>(request.list_frontier));
+        putIds(frame, request.user_ids);
+        putBatch(frame, request.links);
+        putBatches(frame, request.batches);
+    }
+
+    /**
+     * @brief Read a request from a frame written by encodeRequest().
+     * @param frame The frame.
+     * @param request Receives the request.
+     * @return true if the frame holds a whole request, false otherwise.
+     */
+    bool decodeRequest(const Frame& frame, ShardRequest& request) {
+        const unsigned char* cursor = frame.data() + sizeof(std::uint64_t);
+        const unsigned char* end = frame.data() + frame.size();
+        std::int32_t command;
+        std::int32_t side;
+        std::int32_t level;
+        std::uint8_t listFrontier;
+        if (!get(cursor, end, command) || !get(cursor, end, request.user) || !get(cursor, end, request.neighbor)
+            || !get(cursor, end, side) || !get(cursor, end, level) || !get(cursor, end, listFrontier)
+            || !getIds(cursor, end, request.user_ids) || !getBatch(cursor, end, request.links)
+            || !getBatches(cursor, end, request.batches)) {
+            return false;
+        }
+        request.command = static_cast<ShardCommand>(command);
+        request.side = side;
+        request.level = level;
+        request.list_frontier = listFrontier != 0;
+        // Sides index two-element arrays of the worker, Start counts them instead
+        switch (request.command) {
+        case ShardCommand::Start:
+            return side == 1 || side == 2;
+        case ShardCommand::Seed:
+        case ShardCommand::Expand:
+        case ShardCommand::Deliver:
+        case ShardCommand::Parent:
+            return side == 0 || side == 1;
+        default:
+            return true;
+        }
+    }
+
+    /**
+     * @brief Write a reply into a frame.
+     * @param reply The reply.
+     * @param frame Receives the frame.
+     */
+    void encodeReply(const ShardReply& reply, Frame& frame) {
+        frame.clear();
+        put(frame, std::uint64_t(0));
+        put(frame, static_cast<std::int32_t>(reply.status));
+        put(frame, reply.users);
+        put(frame, reply.links);
+        put(frame, reply.frontier);
+        put(frame, reply.user);
+        put(frame, static_cast<std::int32_t>(reply.meeting_length));
+        put(frame, static_cast<std::int32_t>(reply.traffic.rounds));
+        put(frame, reply.traffic.local_visits);
+        put(frame, reply.traffic.remote_messages);
+        put(frame, reply.traffic.remote_batches);
+        putIds(frame, reply.user_ids);
+        putBatches(frame, reply.batches);
+    }
+
+    /**
+     * @brief Read a reply from a frame written by encodeReply().
+     * @param frame The frame.
+     * @param reply Receives the reply.
+     * @return true if the frame holds a whole reply, false otherwise.
+     */
+    bool decodeReply(const Frame& frame, ShardReply& reply) {
+        const unsigned char* cursor = frame.data() + sizeof(std::uint64_t);
+        const unsigned char* end = frame.data() + frame.size();
+        std::int32_t status;
+        std::int32_t meetingLength;
+        std::int32_t rounds;
+        if (!get(cursor, end, status) || !get(cursor, end, reply.users) || !get(cursor, end, reply.links)
+            || !get(cursor, end, reply.frontier) || !get(cursor, end, reply.user) || !get(cursor, end, meetingLength)
+            || !get(cursor, end, rounds) || !get(cursor, end, reply.traffic.local_visits)
+            || !get(cursor, end, reply.traffic.remote_messages) || !get(cursor, end, reply.traffic.remote_batches)
+            || !getIds(cursor, end, reply.user_ids) || !getBatches(cursor, end, reply.batches)) {
+            return false;
+        }
+        reply.status = static_cast<NetworkStatus>(status);
+        reply.meeting_length = meetingLength;
+        reply.traffic.rounds = rounds;
+        return true;
+    }
+
+    /**
+     * @brief Write a frame to a socket, filling in its length first.
+     * @param socket The socket.
+     * @param frame The frame, with room for the length at the start.
+     * @return true if the whole frame was written, false if the peer is gone.
+     */
+    bool writeFrame(int socket, Frame& frame) {
+        const std::uint64_t length = frame.size() - sizeof(std::uint64_t);
+        std::memcpy(frame.data(), &length, sizeof(length));
+        const unsigned char* data = frame.data();
+        std::size_t left = frame.size();
+        while (left > 0) {
+            ssize_t written = ::send(socket, data, left, kSendFlags);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            left -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read bytes from a socket until all of them arrived.
+     * @param socket The socket.
+     * @param data Receives the bytes.
+     * @param size The number of bytes.
+     * @return true if all bytes were read, false if the peer is gone.
+     */
+    bool readBytes(int socket, unsigned char* data, std::size_t size) {
+        while (size > 0) {
+            ssize_t received = ::recv(socket, data, size, 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            data += received;
+            size -= static_cast<std::size_t>(received);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read a frame written by writeFrame().
+     * @param socket The socket.
+     * @param frame Receives the frame, length included.
+     * @return true if a whole frame was read, false if the peer is gone.
+     */
+    bool readFrame(int socket, Frame& frame) {
+        std::uint64_t length;
+        if (!readBytes(socket, reinterpret_cast<unsigned char*>(&length), sizeof(length))) {
+            return false;
+        }
+        frame.resize(sizeof(length) + static_cast<std::size_t>(length));
+        std::memcpy(frame.data(), &length, sizeof(length));
+        return readBytes(socket, frame.data() + sizeof(length), static_cast<std::size_t>(length));
+    }
+
+    /**
+     * @brief Serve the requests of one shard until the network closes its socket.
+     * @param socket The worker's end of the socket pair.
+     * @param shard The number of the shard.
+     * @param num_shards The number of shards of the network.
+     */
+    void runWorker(int socket, int shard, int num_shards) {
+        ShardWorker worker(shard, num_shards);
+        ShardRequest request;
+        ShardReply reply;
+        Frame frame;
+        while (readFrame(socket, frame) && decodeRequest(frame, request)) {
+            worker.handle(request, reply);
+            encodeReply(reply, frame);
+            if (!writeFrame(socket, frame)) {
+                break;
+            }
+        }
+        ::close(socket);
+    }
+
+    /**
+     * @class ProcessTransport
+     * @brief Runs every shard worker in a forked process, and exchanges frames with it over a Unix socket pair.
+     */
+    class ProcessTransport : public ShardTransport {
+    public:
+        ProcessTransport() : healthy(true) {}
+
+        ~ProcessTransport() override {
+            // A shut down socket ends the worker's loop, even while processes forked later still hold a copy
+            for (int socket : sockets) {
+                ::shutdown(socket, SHUT_RDWR);
+                ::close(socket);
+            }
+            for (pid_t pid : pids) {
+                while (::waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+                }
+            }
+        }
+
+        /**
+         * @brief Fork the worker processes.
+         * @param num_shards The number of shards.
+         * @return true if every worker was started, false otherwise.
+         */
+        bool start(int num_shards) {
+            for (int shard = 0; shard < num_shards; shard++) {
+                int ends[2];
+                if (::socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0) {
+                    return false;
+                }
+                pid_t pid = ::fork();
+                if (pid == -1) {
+                    ::close(ends[0]);
+                    ::close(ends[1]);
+                    return false;
+                }
+                if (pid == 0) {
+                    // The worker keeps only its own end, so it sees the network close its socket
+                    ::close(ends[0]);
+                    for (int socket : sockets) {
+                        ::close(socket);
+                    }
+                    runWorker(ends[1], shard, num_shards);
+                    ::_exit(0);
+                }
+                ::close(ends[1]);
+                sockets.push_back(ends[0]);
+                pids.push_back(pid);
+            }
+            return true;
+        }
+
+        int numberOfShards() const override {
+            return static_cast<int>(sockets.size());
+        }
+
+        bool isHealthy() const override {
+            return healthy;
+        }
+
+        void call(int shard, ShardRequest& request, ShardReply& reply) override {
+            if (!send(shard, request) || !receive(shard, reply)) {
+                reply = ShardReply();
+            }
+        }
+
+        void broadcast(std::vector<ShardRequest>& requests, std::vector<ShardReply>& replies) override {
+            // Every worker reads its whole request before it replies, so all requests go out before any reply is read
+            replies.resize(sockets.size());
+            for (std::size_t shard = 0; shard < sockets.size(); shard++) {
+                if (requests[shard].command != ShardCommand::None) {
+                    send(static_cast<int>(shard), requests[shard]);
+                }
+            }
+            for (std::size_t shard = 0; shard < sockets.size(); shard++) {
+                if (requests[shard].command != ShardCommand::None && !receive(static_cast<int>(shard), replies[shard])) {
+                    replies[shard] = ShardReply();
+                }
+            }
+        }
+
+    private:
+        std::vector<int> sockets;  // The network's end of the socket pair of every shard.
+        std::vector<pid_t> pids;  // The worker process of every shard.
+        Frame frame;  // Reusable frame buffer.
+        bool healthy;  // false once a worker could not be reached, after which no more frames are exchanged.
+
+        /**
+         * @brief Send a request to a worker, consuming its links and batches.
+         * @param shard The shard.
+         * @param request The request.
+         * @return true if the request was sent, false if the worker is lost.
+         */
+        bool send(int shard, ShardRequest& request) {
+            if (!healthy) {
+                return false;
+            }
+            encodeRequest(request, frame);
+            std::vector<std::pair<UserId, UserId>>().swap(request.links);
+            for (Batch& batch : request.batches) {
+                batch.clear();
+            }
+            healthy = writeFrame(sockets[shard], frame);
+            return healthy;
+        }
+
+        /**
+         * @brief Wait for the reply of a worker.
+         * @param shard The shard.
+         * @param reply Receives the reply.
+         * @return true if the reply was read, false if the worker is lost.
+         */
+        bool receive(int shard, ShardReply& reply) {
+            if (!healthy) {
+                return false;
+            }
+            healthy = readFrame(sockets[shard], frame) && decodeReply(frame, reply);
+            return healthy;
+        }
+    };
+#endif
+}
+
+/**
+ * @brief Create a transport whose workers run on a thread pool of the calling process.
+ * @param num_shards The number of shards, at least 1.
+ * @param num_threads The number of threads that run the shards, 0 for the number of hardware threads.
+ * @return The transport.
+ */
+std::unique_ptr<ShardTransport> ShardTransport::threads(int num_shards, unsigned num_threads) {
+    return std::unique_ptr<ShardTransport>(new ThreadTransport(std::max(num_shards, 1), num_threads));
+}
+
+
+/**
+ * @brief Create a transport that forks one worker process per shard, connected by a Unix socket pair.
+ * @param num_shards The number of shards, at least 1.
+ * @return The transport, or nullptr if a worker could not be started or the platform has no fork() and Unix
+ *         sockets, as on Windows.
+ */
+std::unique_ptr<ShardTransport> ShardTransport::processes(int num_shards) {
+#ifdef _WIN32
+    static_cast<void>(num_shards);
+    return nullptr;
+#else
+    // Workers that did start are stopped again when the transport is dropped
+    std::unique_ptr<ProcessTransport> transport(new ProcessTransport());
+    if (!transport->start(std::max(num_shards, 1))) {
+        return nullptr;
+    }
+    return std::unique_ptr<ShardTransport>(transport.release());
+#endif
+}
@@ -0,0 +1,72 @@
+#ifndef SHARDTRANSPORT_H
+#define SHARDTRANSPORT_H
+
+#include <memory>
+#include <vector>
+#include "ShardWorker.h"
+
+
+/**
+ * @class ShardTransport
+ * @brief Carries the requests of a sharded network to the workers of its shards and brings back their replies.
+ *
+ * threads() keeps every ShardWorker in the calling process and runs a round of requests on a thread pool.
+ * processes() starts one worker process per shard and talks to each over a Unix socket pair: requests and
+ * replies, including the per-destination batches of a traversal round, are written as length-prefixed frames.
+ * The network only ever talks to its shards through a transport, so both behave the same.
+ */
+class ShardTransport {
+public:
+    /**
+     * @brief Stop the workers.
+     */
+    virtual ~ShardTransport() = default;
+
+    /**
+     * @brief Create a transport whose workers run on a thread pool of the calling process.
+     * @param num_shards The number of shards, at least 1.
+     * @param num_threads The number of threads that run the shards, 0 for the number of hardware threads.
+     * @return The transport.
+     */
+    static std::unique_ptr<ShardTransport> threads(int num_shards, unsigned num_threads = 0);
+
+    /**
+     * @brief Create a transport that forks one worker process per shard, connected by a Unix socket pair.
+     *
+     * The workers are forked from the calling process, so create the transport before starting other threads.
+     * @param num_shards The number of shards, at least 1.
+     * @return The transport, or nullptr if a worker could not be started or the platform has no fork() and Unix
+     *         sockets, as on Windows.
+     */
+    static std::unique_ptr<ShardTransport> processes(int num_shards);
+
+    /**
+     * @brief Get the number of shards.
+     * @return The number of shards.
+     */
+    virtual int numberOfShards() const = 0;
+
+    /**
+     * @brief Check that every worker can still be reached.
+     * @return true if no worker was lost, false if a worker process exited. From then on every reply is empty.
+     */
+    virtual bool isHealthy() const = 0;
+
+    /**
+     * @brief Send a request to one shard and wait for its reply.
+     * @param shard The shard.
+     * @param request The request. Its links and batches may be consumed.
+     * @param reply Receives the reply.
+     */
+    virtual void call(int shard, ShardRequest& request, ShardReply& reply) = 0;
+
+    /**
+     * @brief Send a request to every shard, let the shards carry them out in parallel and wait for all replies.
+     * @param requests One request per shard, ShardCommand::None to leave a shard out. Their links and batches may
+     *        be consumed.
+     * @param replies Receives one reply per shard.
+     */
+    virtual void broadcast(std::vector<ShardRequest>& requests, std::vector<ShardReply>& replies) = 0;
+};
+
+#endif // SHARDTRANSPORT_H
@@ -0,0 +1,367 @@
+#include "ShardWorker.h"
+#include <algorithm>
+
+/**
+ * @brief Constructor for ShardWorker class.
+ * Creates an empty shard.
+ * @param shard The number of the shard.
+ * @param num_shards The number of shards of the network.
+ */
+ShardWorker::ShardWorker(int shard, int num_shards)
+    : shard(shard), num_shards(num_shards), num_links(0), traversal(0), meeting_slot(-1), meeting_length(0x7FFFFFFF) {}
+
+
+/**
+ * @brief Get the shard that owns a user.
+ * @param user_id The ID of the user.
+ * @param num_shards The number of shards of the network.
+ * @return The shard of the user, whether or not the user exists.
+ */
+int ShardWorker::shardOf(UserId user_id, int num_shards) {
+    // The high half of the hash, the shard's own index probes with the low bits
+    std::size_t high = UserIndex::hash(user_id) >> (sizeof(std::size_t) * 4);
+    return static_cast<int>(high % static_cast<std::size_t>(num_shards));
+}
+
+
+/**
+ * @brief Carry out a request.
+ * @param request The request. Its links and batches are consumed.
+ * @param reply Receives the outcome.
+ */
+void ShardWorker::handle(ShardRequest& request, ShardReply& reply) {
+    reply.status = NetworkStatus::Ok;
+    reply.users = 0;
+    reply.links = 0;
+    reply.frontier = 0;
+    reply.user = 0;
+    reply.meeting_length = -1;
+    reply.traffic = ExchangeStatistics{ 0, 0, 0, 0 };
+    reply.user_ids.clear();
+    for (std::vector<std::pair<UserId, UserId>>& batch : reply.batches) {
+        batch.clear();
+    }
+
+    switch (request.command) {
+    case ShardCommand::None:
+        break;
+
+    case ShardCommand::AddUser: {
+        const int slot = index.find(request.user);
+        if (slot != -1) {
+            reply.status = NetworkStatus::UserExists;
+            break;
+        }
+        allocateSlot(request.user);
+        break;
+    }
+
+    case ShardCommand::RemoveUser: {
+        const int slot = index.find(request.user);
+        if (slot == -1) {
+            reply.status = NetworkStatus::UserNotFound;
+            break;
+        }
+        // The shards of the neighbors drop their halves of the connections next
+        reply.user_ids.swap(connections[slot]);
+        std::vector<UserId>().swap(connections[slot]);
+        num_links -= static_cast<long long>(reply.user_ids.size());
+        index.erase(request.user);
+        free_slots.push_back(slot);
+        break;
+    }
+
+    case ShardCommand::HasUser: {
+        const int slot = index.find(request.user);
+        reply.status = slot != -1 ? NetworkStatus::Ok : NetworkStatus::UserNotFound;
+        break;
+    }
+
+    case ShardCommand::AddLink: {
+        const int slot = index.find(request.user);
+        if (slot == -1) {
+            reply.status = NetworkStatus::UserNotFound;
+            break;
+        }
+        std::vector<UserId>& row = connections[slot];
+        std::vector<UserId>::iterator position = std::lower_bound(row.begin(), row.end(), request.neighbor);
+        if (position != row.end() && *position == request.neighbor) {
+            reply.status = NetworkStatus::ConnectionExists;
+            break;
+        }
+        row.insert(position, request.neighbor);
+        num_links++;
+        break;
+    }
+
+    case ShardCommand::RemoveLink: {
+        const int slot = index.find(request.user);
+        if (slot == -1) {
+            reply.status = NetworkStatus::UserNotFound;
+            break;
+        }
+        std::vector<UserId>& row = connections[slot];
+        std::vector<UserId>::iterator position = std::lower_bound(row.begin(), row.end(), request.neighbor);
+        if (position == row.end() || *position != request.neighbor) {
+            reply.status = NetworkStatus::ConnectionNotFound;
+            break;
+        }
+        row.erase(position);
+        num_links--;
+        break;
+    }
+
+    case ShardCommand::HasLink: {
+        const int slot = index.find(request.user);
+        if (slot == -1) {
+            reply.status = NetworkStatus::UserNotFound;
+        }
+        else if (!std::binary_search(connections[slot].begin(), connections[slot].end(), request.neighbor)) {
+            reply.status = NetworkStatus::ConnectionNotFound;
+        }
+        break;
+    }
+
+    case ShardCommand::DropLinks:
+        for (UserId neighbor : request.user_ids) {
+            std::vector<UserId>& row = connections[index.find(neighbor)];
+            row.erase(std::lower_bound(row.begin(), row.end(), request.user));
+            num_links--;
+        }
+        break;
+
+    case ShardCommand::Load:
+        load(request.links, reply);
+        break;
+
+    case ShardCommand::Count:
+        reply.users = static_cast<long long>(user_ids.size() - free_slots.size());
+        reply.links = num_links;
+        break;
+
+    case ShardCommand::Start:
+        start(request.side);
+        break;
+
+    case ShardCommand::Seed: {
+        const int slot = index.find(request.user);
+        if (slot == -1) {
+            reply.status = NetworkStatus::UserNotFound;
+            break;
+        }
+        visited[request.side][slot] = traversal;
+        parent[request.side][slot] = request.user;
+        depth[request.side][slot] = 0;
+        frontier[request.side].push_back(slot);
+        break;
+    }
+
+    case ShardCommand::Expand:
+        expand(request.side, request.level, reply);
+        break;
+
+    case ShardCommand::Deliver:
+        deliver(request, reply);
+        break;
+
+    case ShardCommand::Parent: {
+        const int slot = index.find(request.user);
+        if (slot == -1) {
+            reply.status = NetworkStatus::UserNotFound;
+            break;
+        }
+        reply.user = parent[request.side][slot];
+        break;
+    }
+    }
+}
+
+
+/**
+ * @brief Add a user the shard does not hold yet.
+ * @param user_id The ID of the user.
+ * @return The slot of the user.
+ */
+int ShardWorker::allocateSlot(UserId user_id) {
+    int slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        user_ids[slot] = user_id;
+    }
+    else {
+        slot = static_cast<int>(user_ids.size());
+        user_ids.push_back(user_id);
+        connections.emplace_back();
+    }
+    index.insert(user_id, slot);
+    return slot;
+}
+
+
+/**
+ * @brief Merge sorted (user, neighbor) pairs into the connection lists, adding missing users.
+ * @param links The pairs, sorted and made unique in place.
+ * @param reply Receives the number of users and connection list entries added.
+ */
+void ShardWorker::load(std::vector<std::pair<UserId, UserId>>& links, ShardReply& reply) {
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+
+    std::vector<UserId> merged;
+    for (std::size_t first = 0; first < links.size(); ) {
+        UserId user_id = links[first].first;
+        int slot = index.find(user_id);
+        if (slot == -1) {
+            slot = allocateSlot(user_id);
+            reply.users++;
+        }
+
+        // The new neighbors of the user are sorted already, merge them into its row
+        std::size_t last = first;
+        merged.clear();
+        std::vector<UserId>& row = connections[slot];
+        std::vector<UserId>::const_iterator existing = row.cbegin();
+        for (; last < links.size() && links[last].first == user_id; last++) {
+            UserId neighbor = links[last].second;
+            if (neighbor == user_id) {
+                continue;
+            }
+            while (existing != row.cend() && *existing < neighbor) {
+                merged.push_back(*existing++);
+            }
+            if (existing != row.cend() && *existing == neighbor) {
+                continue;
+            }
+            merged.push_back(neighbor);
+            reply.links++;
+        }
+        merged.insert(merged.end(), existing, row.cend());
+        row.swap(merged);
+        first = last;
+    }
+    num_links += reply.links;
+    std::vector<std::pair<UserId, UserId>>().swap(links);
+}
+
+
+/**
+ * @brief Start a traversal: take a new stamp and clear the frontiers.
+ * @param sides The number of sides, 1 or 2.
+ */
+void ShardWorker::start(int sides) {
+    // A new stamp marks every slot unvisited, the arrays are only cleared when the stamp wraps
+    if (++traversal == 0) {
+        for (int side = 0; side < 2; side++) {
+            std::fill(visited[side].begin(), visited[side].end(), 0u);
+        }
+        traversal = 1;
+    }
+    for (int side = 0; side < sides; side++) {
+        visited[side].resize(user_ids.size(), 0u);
+        parent[side].resize(user_ids.size());
+        depth[side].resize(user_ids.size());
+        frontier[side].clear();
+    }
+}
+
+
+/**
+ * @brief Mark a user of the shard reached from a neighbor, and note where it meets the other side.
+ * @param side The side being expanded.
+ * @param level The level of the frontier being formed.
+ * @param slot The slot of the reached user.
+ * @param from The user it was reached from.
+ * @return true if the user was not visited before, false otherwise.
+ */
+bool ShardWorker::visit(int side, int level, int slot, UserId from) {
+    if (visited[side][slot] == traversal) {
+        return false;
+    }
+    visited[side][slot] = traversal;
+    parent[side][slot] = from;
+    depth[side][slot] = level;
+    next_frontier.push_back(slot);
+
+    // A plain BFS leaves the other side's arrays from an earlier search, with older stamps
+    const int other = 1 - side;
+    if (slot < static_cast<int>(visited[other].size()) && visited[other][slot] == traversal
+        && level + depth[other][slot] < meeting_length) {
+        meeting_slot = slot;
+        meeting_length = level + depth[other][slot];
+    }
+    return true;
+}
+
+
+/**
+ * @brief Expand the shard's part of a frontier, visiting local neighbors and batching the rest per destination.
+ * @param side The side to expand.
+ * @param level The level of the frontier being formed.
+ * @param reply Receives the batches and the traffic.
+ */
+void ShardWorker::expand(int side, int level, ShardReply& reply) {
+    meeting_slot = -1;
+    meeting_length = 0x7FFFFFFF;
+    next_frontier.clear();
+    outbox.resize(num_shards);
+    for (std::vector<std::pair<UserId, UserId>>& batch : outbox) {
+        batch.clear();
+    }
+
+    for (int slot : frontier[side]) {
+        const UserId from = user_ids[slot];
+        for (UserId neighbor : connections[slot]) {
+            int destination = shardOf(neighbor, num_shards);
+            if (destination != shard) {
+                outbox[destination].emplace_back(neighbor, from);
+            }
+            else if (visit(side, level, index.find(neighbor), from)) {
+                reply.traffic.local_visits++;
+            }
+        }
+    }
+
+    // Users reached through several neighbors are sent once
+    for (std::vector<std::pair<UserId, UserId>>& batch : outbox) {
+        if (batch.empty()) {
+            continue;
+        }
+        std::sort(batch.begin(), batch.end());
+        batch.erase(std::unique(batch.begin(), batch.end(), [](const std::pair<UserId, UserId>& a, const std::pair<UserId, UserId>& b) {
+            return a.first == b.first;
+        }), batch.end());
+        reply.traffic.remote_messages += static_cast<long long>(batch.size());
+        reply.traffic.remote_batches++;
+    }
+
+    // Hand the batches over and keep the reply's emptied vectors for the next round
+    reply.batches.swap(outbox);
+}
+
+
+/**
+ * @brief Visit the users of the batches sent to the shard and form its part of the next frontier.
+ * @param request The Deliver request. Its batches are emptied.
+ * @param reply Receives the size of the new frontier and where the sides met.
+ */
+void ShardWorker::deliver(ShardRequest& request, ShardReply& reply) {
+    for (std::vector<std::pair<UserId, UserId>>& batch : request.batches) {
+        for (const std::pair<UserId, UserId>& message : batch) {
+            visit(request.side, request.level, index.find(message.first), message.second);
+        }
+        batch.clear();
+    }
+    frontier[request.side].swap(next_frontier);
+
+    reply.frontier = static_cast<long long>(frontier[request.side].size());
+    if (request.list_frontier) {
+        for (int slot : frontier[request.side]) {
+            reply.user_ids.push_back(user_ids[slot]);
+        }
+    }
+    if (meeting_slot != -1) {
+        reply.user = user_ids[meeting_slot];
+        reply.meeting_length = meeting_length;
+    }
+}
@@ -0,0 +1,188 @@
+#ifndef SHARDWORKER_H
+#define SHARDWORKER_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "NetworkStatus.h"
+#include "UserId.h"
+#include "UserIndex.h"
+
+
+/**
+ * @struct ExchangeStatistics
+ * @brief The traffic between shards of the last traversal of a sharded network.
+ */
+struct ExchangeStatistics {
+    int rounds;  // The number of frontier exchanges, one per level.
+    long long local_visits;  // Neighbors that were visited without leaving their shard.
+    long long remote_messages;  // Neighbors sent to another shard, after removing duplicates.
+    long long remote_batches;  // Non-empty batches of messages from one shard to another.
+};
+
+
+/**
+ * @enum ShardCommand
+ * @brief The operations a shard worker carries out on its shard.
+ */
+enum class ShardCommand : std::int32_t {
+    None,  // Nothing to do, the shard is left out of a round.
+    AddUser,  // Add user.
+    RemoveUser,  // Remove user, replying with its connections.
+    HasUser,  // Check that user exists.
+    AddLink,  // Add neighbor to the connections of user.
+    RemoveLink,  // Remove neighbor from the connections of user.
+    HasLink,  // Check that neighbor is a connection of user.
+    DropLinks,  // Remove user from the connections of every user in user_ids.
+    Load,  // Merge the (user, neighbor) pairs of links into the connections, adding missing users.
+    Count,  // Reply with the number of users and connection list entries.
+    Start,  // Start a traversal with sides sides.
+    Seed,  // Put user at level 0 of side.
+    Expand,  // Expand the frontier of side to level, replying with the batches for the other shards.
+    Deliver,  // Visit the users of the batches sent to the shard, and form the next frontier of side.
+    Parent  // Reply with the user that user was reached from on side.
+};
+
+
+/**
+ * @struct ShardRequest
+ * @brief An operation sent to one shard.
+ */
+struct ShardRequest {
+    ShardCommand command;  // The operation.
+    UserId user;  // The user the operation is about.
+    UserId neighbor;  // The other user of a connection.
+    int side;  // The traversal side, 0 or 1, or the number of sides of Start.
+    int level;  // The level of the frontier being formed.
+    bool list_frontier;  // If true, Deliver replies with the users of the new frontier.
+    std::vector<UserId> user_ids;  // The users of DropLinks.
+    std::vector<std::pair<UserId, UserId>> links;  // The (user, neighbor) pairs of Load.
+    std::vector<std::vector<std::pair<UserId, UserId>>> batches;  // The (user, parent) batches of Deliver, per sender.
+
+    /**
+     * @brief Construct an empty Shard Request object.
+     */
+    ShardRequest() : command(ShardCommand::None), user(0), neighbor(0), side(0), level(0), list_frontier(false) {}
+};
+
+
+/**
+ * @struct ShardReply
+ * @brief The outcome of a ShardRequest.
+ */
+struct ShardReply {
+    NetworkStatus status;  // Ok, or why the operation failed.
+    long long users;  // The users added by Load, or counted by Count.
+    long long links;  // The connection list entries added by Load, or counted by Count.
+    long long frontier;  // The number of users of the frontier formed by Deliver.
+    UserId user;  // The parent found by Parent, or the user where the sides met in Deliver.
+    int meeting_length;  // The length of the shortest path through user found by Deliver, -1 if the sides did not meet.
+    ExchangeStatistics traffic;  // The shard's share of the traffic of Expand.
+    std::vector<UserId> user_ids;  // The connections of a removed user, or the users of the new frontier.
+    std::vector<std::vector<std::pair<UserId, UserId>>> batches;  // The (user, parent) batches of Expand, per destination.
+
+    /**
+     * @brief Construct the Shard Reply object of a shard that could not be reached.
+     */
+    ShardReply() : status(NetworkStatus::UserNotFound), users(0), links(0), frontier(0), user(0), meeting_length(-1),
+                   traffic{ 0, 0, 0, 0 } {}
+};
+
+
+/**
+ * @class ShardWorker
+ * @brief Owns the users of one shard with their sorted connection lists, and carries out the requests sent to it.
+ *
+ * A worker only ever reads and writes its own shard, so the workers of a network can run as tasks of one process
+ * or in processes of their own. All traffic between shards goes through the batches of Expand and Deliver.
+ */
+class ShardWorker {
+public:
+    /**
+     * @brief Construct a Shard Worker object with an empty shard.
+     * @param shard The number of the shard.
+     * @param num_shards The number of shards of the network.
+     */
+    ShardWorker(int shard, int num_shards);
+
+    /**
+     * @brief Get the shard that owns a user.
+     * @param user_id The ID of the user.
+     * @param num_shards The number of shards of the network.
+     * @return The shard of the user, whether or not the user exists.
+     */
+    static int shardOf(UserId user_id, int num_shards);
+
+    /**
+     * @brief Carry out a request.
+     * @param request The request. Its links and batches are consumed.
+     * @param reply Receives the outcome.
+     */
+    void handle(ShardRequest& request, ShardReply& reply);
+
+private:
+    int shard;  // The number of the shard.
+    int num_shards;  // The number of shards of the network.
+    UserIndex index;  // Hash index from user ID to slot.
+    std::vector<UserId> user_ids;  // The user ID of every slot.
+    std::vector<std::vector<UserId>> connections;  // The sorted IDs of the connections of every slot.
+    std::vector<int> free_slots;  // Slots of removed users available for reuse.
+    long long num_links;  // The number of connection list entries on the shard.
+
+    unsigned traversal;  // Stamp of the current traversal in visited.
+    std::vector<unsigned> visited[2];  // The traversal that last visited every slot, from each side.
+    std::vector<UserId> parent[2];  // The user every slot was reached from, from each side.
+    std::vector<int> depth[2];  // The level every slot was reached at, from each side.
+    std::vector<int> frontier[2];  // The slots of the current level of each side.
+    std::vector<int> next_frontier;  // The slots of the next level of the side being expanded.
+    std::vector<std::vector<std::pair<UserId, UserId>>> outbox;  // (user, parent) messages per destination shard.
+    int meeting_slot;  // The slot of the shortest path found this round where both sides met, or -1.
+    int meeting_length;  // The length of the path through meeting_slot.
+
+    /**
+     * @brief Add a user the shard does not hold yet.
+     * @param user_id The ID of the user.
+     * @return The slot of the user.
+     */
+    int allocateSlot(UserId user_id);
+
+    /**
+     * @brief Merge sorted (user, neighbor) pairs into the connection lists, adding missing users.
+     * @param links The pairs, sorted and made unique in place.
+     * @param reply Receives the number of users and connection list entries added.
+     */
+    void load(std::vector<std::pair<UserId, UserId>>& links, ShardReply& reply);
+
+    /**
+     * @brief Start a traversal: take a new stamp and clear the frontiers.
+     * @param sides The number of sides, 1 or 2.
+     */
+    void start(int sides);
+
+    /**
+     * @brief Mark a user of the shard reached from a neighbor, and note where it meets the other side.
+     * @param side The side being expanded.
+     * @param level The level of the frontier being formed.
+     * @param slot The slot of the reached user.
+     * @param from The user it was reached from.
+     * @return true if the user was not visited before, false otherwise.
+     */
+    bool visit(int side, int level, int slot, UserId from);
+
+    /**
+     * @brief Expand the shard's part of a frontier, visiting local neighbors and batching the rest per destination.
+     * @param side The side to expand.
+     * @param level The level of the frontier being formed.
+     * @param reply Receives the batches and the traffic.
+     */
+    void expand(int side, int level, ShardReply& reply);
+
+    /**
+     * @brief Visit the users of the batches sent to the shard and form its part of the next frontier.
+     * @param request The Deliver request. Its batches are emptied.
+     * @param reply Receives the size of the new frontier and where the sides met.
+     */
+    void deliver(ShardRequest& request, ShardReply& reply);
+};
+
+#endif // SHARDWORKER_H
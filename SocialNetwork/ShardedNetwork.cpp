@@ -0,0 +1,433 @@
+#include "ShardedNetwork.h"
+#include <algorithm>
+
+/**
+ * @brief Constructor for ShardedNetwork class.
+ * Creates num_shards empty shards run on a thread pool, which is started on first use.
+ * @param num_shards The number of shards, at least 1.
+ * @param num_threads The number of threads that run the shards, 0 for the number of hardware threads.
+ */
+ShardedNetwork::ShardedNetwork(int num_shards, unsigned num_threads)
+    : ShardedNetwork(ShardTransport::threads(num_shards, num_threads)) {}
+
+
+/**
+ * @brief Constructor for ShardedNetwork class.
+ * Creates a network over the empty shards of a transport.
+ * @param transport The transport to the workers of the shards.
+ */
+ShardedNetwork::ShardedNetwork(std::unique_ptr<ShardTransport> transport)
+    : transport(std::move(transport)), num_users(0), meeting(0), exchange{ 0, 0, 0, 0 } {
+    requests.resize(this->transport->numberOfShards());
+    replies.resize(this->transport->numberOfShards());
+}
+
+
+/**
+ * @brief Get the number of shards.
+ * @return The number of shards.
+ */
+int ShardedNetwork::numberOfShards() const {
+    return transport->numberOfShards();
+}
+
+
+/**
+ * @brief Check that every shard can still be reached.
+ * @return true if no shard worker was lost, false otherwise.
+ */
+bool ShardedNetwork::isHealthy() const {
+    return transport->isHealthy();
+}
+
+
+/**
+ * @brief Get the shard that owns a user.
+ * @param user_id The ID of the user.
+ * @return The shard of the user, whether or not the user exists.
+ */
+int ShardedNetwork::shardOf(UserId user_id) const {
+    return ShardWorker::shardOf(user_id, numberOfShards());
+}
+
+
+/**
+ * @brief Add a user to its shard.
+ * @param user_id The ID of the user to be added.
+ * @return Ok, or UserExists.
+ */
+NetworkStatus ShardedNetwork::addUser(UserId user_id) {
+    NetworkStatus status = call(ShardCommand::AddUser, user_id).status;
+    if (status == NetworkStatus::Ok) {
+        num_users++;
+    }
+    return status;
+}
+
+
+/**
+ * @brief Remove a user, and its connections from the shards of its neighbors.
+ * @param user_id The ID of the user to be removed.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus ShardedNetwork::removeUser(UserId user_id) {
+    ShardReply removed = call(ShardCommand::RemoveUser, user_id);
+    if (removed.status != NetworkStatus::Ok) {
+        return removed.status;
+    }
+
+    // Each neighbor's shard drops its half of the connections, one batch per shard
+    for (ShardRequest& request : requests) {
+        request.command = ShardCommand::None;
+        request.user = user_id;
+        request.user_ids.clear();
+    }
+    for (UserId neighbor : removed.user_ids) {
+        ShardRequest& request = requests[shardOf(neighbor)];
+        request.command = ShardCommand::DropLinks;
+        request.user_ids.push_back(neighbor);
+    }
+    transport->broadcast(requests, replies);
+    for (ShardRequest& request : requests) {
+        request.user_ids.clear();
+    }
+    num_users--;
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Connect two users on both of their shards.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return Ok, SelfConnection, UserNotFound or ConnectionExists.
+ */
+NetworkStatus ShardedNetwork::addConnection(UserId user_id1, UserId user_id2) {
+    if (user_id1 == user_id2) {
+        return NetworkStatus::SelfConnection;
+    }
+    if (call(ShardCommand::HasUser, user_id2).status != NetworkStatus::Ok) {
+        return NetworkStatus::UserNotFound;
+    }
+    NetworkStatus status = call(ShardCommand::AddLink, user_id1, user_id2).status;
+    if (status == NetworkStatus::Ok) {
+        call(ShardCommand::AddLink, user_id2, user_id1);
+    }
+    return status;
+}
+
+
+/**
+ * @brief Disconnect two users on both of their shards.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return Ok, SelfConnection, UserNotFound or ConnectionNotFound.
+ */
+NetworkStatus ShardedNetwork::removeConnection(UserId user_id1, UserId user_id2) {
+    if (user_id1 == user_id2) {
+        return NetworkStatus::SelfConnection;
+    }
+    if (call(ShardCommand::HasUser, user_id2).status != NetworkStatus::Ok) {
+        return NetworkStatus::UserNotFound;
+    }
+    NetworkStatus status = call(ShardCommand::RemoveLink, user_id1, user_id2).status;
+    if (status == NetworkStatus::Ok) {
+        call(ShardCommand::RemoveLink, user_id2, user_id1);
+    }
+    return status;
+}
+
+
+/**
+ * @brief Add many connections at once, adding the users that do not exist yet.
+ * @param connections Pairs of user IDs to connect.
+ * @return The number of connections added.
+ */
+long long ShardedNetwork::loadConnections(const std::vector<std::pair<UserId, UserId>>& connections) {
+    // Route every connection in both directions to the shard of its first user
+    for (ShardRequest& request : requests) {
+        request.command = ShardCommand::Load;
+        request.links.clear();
+    }
+    for (const std::pair<UserId, UserId>& connection : connections) {
+        requests[shardOf(connection.first)].links.push_back(connection);
+        if (connection.first != connection.second) {
+            requests[shardOf(connection.second)].links.emplace_back(connection.second, connection.first);
+        }
+    }
+
+    // Every shard merges its share into its sorted rows
+    transport->broadcast(requests, replies);
+    long long added = 0;
+    for (const ShardReply& reply : replies) {
+        num_users += static_cast<int>(reply.users);
+        added += reply.links;
+    }
+    // Each connection was added on the shards of both of its users
+    return added / 2;
+}
+
+
+/**
+ * @brief Check if a user exists.
+ * @param user_id The ID of the user.
+ * @return true if the user exists, false otherwise.
+ */
+bool ShardedNetwork::hasUser(UserId user_id) const {
+    return call(ShardCommand::HasUser, user_id).status == NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Check if two users are connected.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return true if the two users are connected, false otherwise.
+ */
+bool ShardedNetwork::isConnected(UserId user_id1, UserId user_id2) const {
+    return call(ShardCommand::HasLink, user_id1, user_id2).status == NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Get the number of users.
+ * @return The number of users on all shards.
+ */
+int ShardedNetwork::numberOfUsers() const {
+    return num_users;
+}
+
+
+/**
+ * @brief Get the number of connections.
+ * @return The number of undirected connections.
+ */
+long long ShardedNetwork::numberOfConnections() const {
+    std::vector<ShardRequest> counts(numberOfShards());
+    std::vector<ShardReply> totals;
+    for (ShardRequest& request : counts) {
+        request.command = ShardCommand::Count;
+    }
+    transport->broadcast(counts, totals);
+
+    long long links = 0;
+    for (const ShardReply& total : totals) {
+        links += total.links;
+    }
+    return links / 2;
+}
+
+
+/**
+ * @brief List the users reachable from a user in breadth-first order.
+ * @param user_id The ID of the user to start from.
+ * @param order Receives the IDs of the visited users, starting with user_id.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus ShardedNetwork::BFS(UserId user_id, std::vector<UserId>& order) {
+    order.clear();
+    const UserId start[2] = { user_id, user_id };
+    if (!startTraversal(1, start)) {
+        return NetworkStatus::UserNotFound;
+    }
+
+    order.push_back(user_id);
+    for (int level = 1; expand(0, level, &order) > 0; level++) {
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Find the length of the shortest path between two users.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+ */
+int ShardedNetwork::findShortestPath(UserId user_id1, UserId user_id2) {
+    const UserId start[2] = { user_id1, user_id2 };
+    return search(start);
+}
+
+
+/**
+ * @brief Find a shortest path between two users.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+ * @return Ok, UserNotFound or NoPath.
+ */
+NetworkStatus ShardedNetwork::findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path) {
+    path.clear();
+    if (!hasUser(user_id1) || !hasUser(user_id2)) {
+        return NetworkStatus::UserNotFound;
+    }
+    const UserId start[2] = { user_id1, user_id2 };
+    if (search(start) == -1) {
+        return NetworkStatus::NoPath;
+    }
+
+    // Follow the parents of each side from the meeting user back to its start, asking the shard of each user
+    const UserId ends[2] = { user_id1, user_id2 };
+    for (int side = 0; side < 2; side++) {
+        UserId current = meeting;
+        while (current != ends[side]) {
+            current = call(ShardCommand::Parent, current, 0, side).user;
+            path.push_back(current);
+        }
+        if (side == 0) {
+            std::reverse(path.begin(), path.end());
+            path.push_back(meeting);
+        }
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Get the traffic between shards of the last BFS() or findShortestPath().
+ * @return The rounds, local visits and remote messages of the last traversal.
+ */
+const ExchangeStatistics& ShardedNetwork::lastExchange() const {
+    return exchange;
+}
+
+
+
+/**
+ * @brief Send a request about one user to the shard of that user.
+ * @param command The operation.
+ * @param user_id The ID of the user.
+ * @param neighbor The ID of the other user of a connection.
+ * @param side The traversal side.
+ * @return The reply of the shard.
+ */
+ShardReply ShardedNetwork::call(ShardCommand command, UserId user_id, UserId neighbor, int side) const {
+    ShardRequest request;
+    request.command = command;
+    request.user = user_id;
+    request.neighbor = neighbor;
+    request.side = side;
+    ShardReply reply;
+    transport->call(shardOf(user_id), request, reply);
+    return reply;
+}
+
+
+/**
+ * @brief Send the same request without payload to every shard.
+ * @param command The operation.
+ * @param side The traversal side, or the number of sides of Start.
+ * @param level The level of the frontier being formed.
+ */
+void ShardedNetwork::broadcast(ShardCommand command, int side, int level) {
+    for (ShardRequest& request : requests) {
+        request.command = command;
+        request.side = side;
+        request.level = level;
+    }
+    transport->broadcast(requests, replies);
+}
+
+
+/**
+ * @brief Start a traversal on every shard and seed each side with one user.
+ * @param sides The number of sides, 1 or 2.
+ * @param start The user each side starts from.
+ * @return true if the users exist, false otherwise.
+ */
+bool ShardedNetwork::startTraversal(int sides, const UserId start[2]) {
+    broadcast(ShardCommand::Start, sides);
+    exchange = ExchangeStatistics{ 0, 0, 0, 0 };
+    for (int side = 0; side < sides; side++) {
+        if (call(ShardCommand::Seed, start[side], 0, side).status != NetworkStatus::Ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Expand the frontier of one side by one level with a round of batched exchanges between shards.
+ * @param side The side to expand.
+ * @param level The level the new frontier is at.
+ * @param order If not nullptr, receives the IDs of the users of the new frontier.
+ * @return The number of users in the new frontier.
+ */
+long long ShardedNetwork::expand(int side, int level, std::vector<UserId>* order) {
+    const std::size_t count = requests.size();
+    exchange.rounds++;
+
+    // Every shard expands its frontier, visiting local neighbors and batching the rest per destination
+    broadcast(ShardCommand::Expand, side, level);
+    for (ShardRequest& request : requests) {
+        request.batches.resize(count);
+    }
+    for (std::size_t sender = 0; sender < count; sender++) {
+        ShardReply& reply = replies[sender];
+        exchange.local_visits += reply.traffic.local_visits;
+        exchange.remote_messages += reply.traffic.remote_messages;
+        exchange.remote_batches += reply.traffic.remote_batches;
+        reply.batches.resize(count);
+        for (std::size_t destination = 0; destination < count; destination++) {
+            requests[destination].batches[sender].swap(reply.batches[destination]);
+        }
+    }
+
+    // Every shard drains the batches sent to it and forms its next frontier
+    for (ShardRequest& request : requests) {
+        request.list_frontier = order != nullptr;
+    }
+    broadcast(ShardCommand::Deliver, side, level);
+    for (ShardRequest& request : requests) {
+        request.list_frontier = false;
+    }
+
+    long long reached = 0;
+    for (const ShardReply& reply : replies) {
+        reached += reply.frontier;
+        if (order != nullptr) {
+            order->insert(order->end(), reply.user_ids.begin(), reply.user_ids.end());
+        }
+    }
+    return reached;
+}
+
+
+/**
+ * @brief Run a bidirectional level-synchronous search between two users.
+ * @param start The two users.
+ * @return The length of the shortest path, or -1 if a user does not exist or there is no path. The sides met at
+ *         meeting.
+ */
+int ShardedNetwork::search(const UserId start[2]) {
+    meeting = start[0];
+    if (start[0] == start[1]) {
+        return hasUser(start[0]) ? 0 : -1;
+    }
+    if (!startTraversal(2, start)) {
+        return -1;
+    }
+
+    long long frontierSize[2] = { 1, 1 };
+    int level[2] = { 0, 0 };
+    while (frontierSize[0] > 0 && frontierSize[1] > 0) {
+        // Expanding the smaller frontier sends the fewest messages
+        const int side = frontierSize[0] <= frontierSize[1] ? 0 : 1;
+        frontierSize[side] = expand(side, ++level[side], nullptr);
+
+        // Once a whole level has met the other side, the shortest meeting is a shortest path
+        int best = -1;
+        for (const ShardReply& reply : replies) {
+            if (reply.meeting_length != -1 && (best == -1 || reply.meeting_length < best)) {
+                best = reply.meeting_length;
+                meeting = reply.user;
+            }
+        }
+        if (best != -1) {
+            return best;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,221 @@
+#ifndef SHARDEDNETWORK_H
+#define SHARDEDNETWORK_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "NetworkStatus.h"
+#include "ShardTransport.h"
+#include "ShardWorker.h"
+#include "UserId.h"
+
+
+/**
+ * @class ShardedNetwork
+ * @brief A social network whose users are hash-partitioned over shards that each own their connection lists.
+ *
+ * A user lives on the shard picked by the high bits of its hashed ID, together with the sorted IDs of its
+ * connections, so every connection is stored once on each of its users' shards. Every shard is owned by a
+ * ShardWorker, and the network only talks to the workers through a ShardTransport: as tasks on a thread pool of
+ * this process, or as worker processes behind Unix sockets. Changes are routed to the shards of the users they
+ * touch.
+ *
+ * BFS() and findShortestPath() run level-synchronously with the shards as the units of work. In each round every
+ * shard expands its part of the frontier on its own: neighbors on the same shard are visited directly, and
+ * neighbors on other shards are collected into one sorted, duplicate-free batch per destination shard. The
+ * destinations then drain their batches in parallel and form the next frontier. Shards only ever write their own
+ * state, so a round needs no locks, and all traffic between shards goes through the batches. findShortestPath()
+ * searches from both users at once, and each round expands the side with the smaller frontier.
+ *
+ * Like SocialNetwork, a ShardedNetwork is changed and queried from one thread at a time.
+ */
+class ShardedNetwork {
+public:
+    /**
+     * @brief Construct an empty Sharded Network object.
+     * @param num_shards The number of shards, at least 1.
+     * @param num_threads The number of threads that run the shards, 0 for the number of hardware threads.
+     */
+    explicit ShardedNetwork(int num_shards, unsigned num_threads = 0);
+
+    /**
+     * @brief Construct an empty Sharded Network object whose shards are reached through a transport.
+     * @param transport The transport to the workers of the shards, such as ShardTransport::processes().
+     */
+    explicit ShardedNetwork(std::unique_ptr<ShardTransport> transport);
+
+    ShardedNetwork(const ShardedNetwork&) = delete;
+    ShardedNetwork& operator=(const ShardedNetwork&) = delete;
+
+    /**
+     * @brief Get the number of shards.
+     * @return The number of shards.
+     */
+    int numberOfShards() const;
+
+    /**
+     * @brief Check that every shard can still be reached.
+     * @return true if no shard worker was lost, false otherwise. Without a worker, queries find no users.
+     */
+    bool isHealthy() const;
+
+    /**
+     * @brief Get the shard that owns a user.
+     * @param user_id The ID of the user.
+     * @return The shard of the user, whether or not the user exists.
+     */
+    int shardOf(UserId user_id) const;
+
+    /**
+     * @brief Add a user to its shard.
+     * @param user_id The ID of the user to be added.
+     * @return Ok, or UserExists.
+     */
+    NetworkStatus addUser(UserId user_id);
+
+    /**
+     * @brief Remove a user, and its connections from the shards of its neighbors.
+     * @param user_id The ID of the user to be removed.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus removeUser(UserId user_id);
+
+    /**
+     * @brief Connect two users on both of their shards.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return Ok, SelfConnection, UserNotFound or ConnectionExists.
+     */
+    NetworkStatus addConnection(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Disconnect two users on both of their shards.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return Ok, SelfConnection, UserNotFound or ConnectionNotFound.
+     */
+    NetworkStatus removeConnection(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Add many connections at once, adding the users that do not exist yet.
+     *
+     * The connections are routed to their shards in one pass, and every shard merges its share in parallel.
+     * Self-connections and connections that already exist are skipped.
+     * @param connections Pairs of user IDs to connect.
+     * @return The number of connections added.
+     */
+    long long loadConnections(const std::vector<std::pair<UserId, UserId>>& connections);
+
+    /**
+     * @brief Check if a user exists.
+     * @param user_id The ID of the user.
+     * @return true if the user exists, false otherwise.
+     */
+    bool hasUser(UserId user_id) const;
+
+    /**
+     * @brief Check if two users are connected.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return true if the two users are connected, false otherwise.
+     */
+    bool isConnected(UserId user_id1, UserId user_id2) const;
+
+    /**
+     * @brief Get the number of users.
+     * @return The number of users on all shards.
+     */
+    int numberOfUsers() const;
+
+    /**
+     * @brief Get the number of connections.
+     * @return The number of undirected connections.
+     */
+    long long numberOfConnections() const;
+
+    /**
+     * @brief List the users reachable from a user in breadth-first order.
+     *
+     * Users come level by level. Within a level they are grouped by shard, in ascending shard order.
+     * @param user_id The ID of the user to start from.
+     * @param order Receives the IDs of the visited users, starting with user_id.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus BFS(UserId user_id, std::vector<UserId>& order);
+
+    /**
+     * @brief Find the length of the shortest path between two users.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+     */
+    int findShortestPath(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Find a shortest path between two users.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+     * @return Ok, UserNotFound or NoPath.
+     */
+    NetworkStatus findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path);
+
+    /**
+     * @brief Get the traffic between shards of the last BFS() or findShortestPath().
+     * @return The rounds, local visits and remote messages of the last traversal.
+     */
+    const ExchangeStatistics& lastExchange() const;
+
+private:
+    std::unique_ptr<ShardTransport> transport;  // Carries requests to the workers of the shards.
+    std::vector<ShardRequest> requests;  // Reusable requests of a round, one per shard.
+    std::vector<ShardReply> replies;  // Reusable replies of a round, one per shard.
+    int num_users;  // The number of users on all shards.
+    UserId meeting;  // The user where the sides of the last findShortestPath() met.
+    ExchangeStatistics exchange;  // The traffic of the last traversal.
+
+    /**
+     * @brief Send a request about one user to the shard of that user.
+     * @param command The operation.
+     * @param user_id The ID of the user.
+     * @param neighbor The ID of the other user of a connection.
+     * @param side The traversal side.
+     * @return The reply of the shard.
+     */
+    ShardReply call(ShardCommand command, UserId user_id, UserId neighbor = 0, int side = 0) const;
+
+    /**
+     * @brief Send the same request without payload to every shard.
+     * @param command The operation.
+     * @param side The traversal side, or the number of sides of Start.
+     * @param level The level of the frontier being formed.
+     */
+    void broadcast(ShardCommand command, int side = 0, int level = 0);
+
+    /**
+     * @brief Start a traversal on every shard and seed each side with one user.
+     * @param sides The number of sides, 1 or 2.
+     * @param start The user each side starts from.
+     * @return true if the users exist, false otherwise.
+     */
+    bool startTraversal(int sides, const UserId start[2]);
+
+    /**
+     * @brief Expand the frontier of one side by one level with a round of batched exchanges between shards.
+     * @param side The side to expand.
+     * @param level The level the new frontier is at.
+     * @param order If not nullptr, receives the IDs of the users of the new frontier.
+     * @return The number of users in the new frontier.
+     */
+    long long expand(int side, int level, std::vector<UserId>* order);
+
+    /**
+     * @brief Run a bidirectional level-synchronous search between two users.
+     * @param start The two users.
+     * @return The length of the shortest path, or -1 if a user does not exist or there is no path. The sides met
+     *         at meeting.
+     */
+    int search(const UserId start[2]);
+};
+
+#endif // SHARDEDNETWORK_H
@@ -0,0 +1,139 @@
+#include "SnapshotPublisher.h"
+#include <algorithm>
+
+/**
+ * @brief Default constructor for SnapshotPublisher class.
+ * Publishes an empty network as version 0.
+ */
+SnapshotPublisher::SnapshotPublisher()
+    : current(nullptr), current_owner(std::make_shared<const NetworkSnapshot>()), global_epoch(1), published(0), num_blocks(0) {
+    current.store(current_owner.get());
+}
+
+
+/**
+ * @brief Destructor for SnapshotPublisher class.
+ * The versions and slot blocks are released with their owners.
+ */
+SnapshotPublisher::~SnapshotPublisher() {}
+
+
+/**
+ * @brief Take a reader slot for the calling thread.
+ * @return The reader slot, or -1 if kMaxReaders readers are registered already.
+ */
+int SnapshotPublisher::registerReader() {
+    std::lock_guard<std::mutex> lock(registration);
+    int blocksInUse = num_blocks.load();
+    for (int reader = 0; reader < blocksInUse * kBlockSlots; reader++) {
+        if (!slot(reader).in_use.load()) {
+            slot(reader).in_use.store(true);
+            return reader;
+        }
+    }
+
+    // All slots are taken, add a block; the writer only scans blocks counted in num_blocks
+    if (blocksInUse == kMaxBlocks) {
+        return -1;
+    }
+    SlotBlock* block = new SlotBlock();
+    for (ReaderSlot& fresh : block->slots) {
+        fresh.epoch.store(0);
+        fresh.in_use.store(false);
+    }
+    blocks[blocksInUse].reset(block);
+    block->slots[0].in_use.store(true);
+    num_blocks.store(blocksInUse + 1);
+    return blocksInUse * kBlockSlots;
+}
+
+
+/**
+ * @brief Give back a reader slot.
+ * @param reader The reader slot.
+ */
+void SnapshotPublisher::unregisterReader(int reader) {
+    std::lock_guard<std::mutex> lock(registration);
+    slot(reader).epoch.store(0);
+    slot(reader).in_use.store(false);
+}
+
+
+/**
+ * @brief Start reading the current version.
+ * @param reader The reader slot of the calling thread.
+ * @return The current version, valid until exit() is called.
+ */
+const NetworkSnapshot* SnapshotPublisher::enter(int reader) {
+    // Announce before loading, so a writer that retires the loaded version sees the announcement
+    slot(reader).epoch.store(global_epoch.load());
+    return current.load();
+}
+
+
+/**
+ * @brief Stop reading the version returned by enter().
+ * @param reader The reader slot of the calling thread.
+ */
+void SnapshotPublisher::exit(int reader) {
+    slot(reader).epoch.store(0, std::memory_order_release);
+}
+
+
+/**
+ * @brief Make a new version current.
+ * @param version The new version.
+ */
+void SnapshotPublisher::publish(std::shared_ptr<const NetworkSnapshot> version) {
+    current.store(version.get());
+    // Readers that announce a later epoch can only load the new version
+    std::uint64_t epoch = global_epoch.fetch_add(1);
+    retired.push_back(std::make_pair(epoch, std::move(current_owner)));
+    current_owner = std::move(version);
+    published.fetch_add(1, std::memory_order_relaxed);
+    reclaim();
+}
+
+
+/**
+ * @brief Release the retired versions that no reader can hold anymore.
+ * @return The number of retired versions that are still held by readers.
+ */
+std::size_t SnapshotPublisher::reclaim() {
+    // The oldest epoch any active reader announced
+    std::uint64_t oldest = UINT64_MAX;
+    int slots = num_blocks.load() * kBlockSlots;
+    for (int reader = 0; reader < slots; reader++) {
+        std::uint64_t epoch = slot(reader).epoch.load();
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+
+    // A version retired in epoch e can be held by readers that announced e or earlier
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [oldest](const std::pair<std::uint64_t, std::shared_ptr<const NetworkSnapshot>>& entry) {
+                                     return entry.first < oldest;
+                                 }),
+                  retired.end());
+    return retired.size();
+}
+
+
+/**
+ * @brief Get the number of versions published so far.
+ * @return The version number of the current version.
+ */
+std::uint64_t SnapshotPublisher::version() const {
+    return published.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief Get a reader slot by number.
+ * @param reader The reader slot.
+ * @return The slot.
+ */
+SnapshotPublisher::ReaderSlot& SnapshotPublisher::slot(int reader) {
+    return blocks[reader / kBlockSlots]->slots[reader % kBlockSlots];
+}
@@ -0,0 +1,131 @@
+#ifndef SNAPSHOTPUBLISHER_H
+#define SNAPSHOTPUBLISHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "NetworkSnapshot.h"
+
+
+/**
+ * @class SnapshotPublisher
+ * @brief Hands immutable snapshot versions from one writer to many concurrent readers without locks.
+ *
+ * Reads use epoch-based reclamation. A reader announces the current global epoch in its own slot before it
+ * loads the current version, and clears the slot when it is done. publish() swaps in a new version, retires the
+ * old one with the epoch it was replaced in, and advances the epoch. A retired version is released once every
+ * active reader has announced a later epoch, so a reader can never see a version being freed, and the read path
+ * is two atomic stores and two loads.
+ *
+ * Readers register once per thread to get a slot, and at most kMaxReaders can be registered at once. publish()
+ * and reclaim() must be called by one writer thread at a time.
+ */
+class SnapshotPublisher {
+public:
+    /**
+     * @brief Construct a Snapshot Publisher object that publishes an empty network.
+     */
+    SnapshotPublisher();
+
+    /**
+     * @brief Release all versions. No reader may be registered anymore.
+     */
+    ~SnapshotPublisher();
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    // Readers per slot block
+    static const int kBlockSlots = 64;
+    // Maximum number of slot blocks
+    static const int kMaxBlocks = 64;
+    // Maximum number of registered readers
+    static const int kMaxReaders = kBlockSlots * kMaxBlocks;
+
+    /**
+     * @brief Take a reader slot for the calling thread.
+     * @return The reader slot, to be passed to enter(), exit() and unregisterReader(), or -1 if kMaxReaders
+     *         readers are registered already.
+     */
+    int registerReader();
+
+    /**
+     * @brief Give back a reader slot. The reader must not be inside enter() / exit().
+     * @param reader The reader slot.
+     */
+    void unregisterReader(int reader);
+
+    /**
+     * @brief Start reading the current version.
+     * @param reader The reader slot of the calling thread.
+     * @return The current version, valid until exit() is called.
+     */
+    const NetworkSnapshot* enter(int reader);
+
+    /**
+     * @brief Stop reading the version returned by enter().
+     * @param reader The reader slot of the calling thread.
+     */
+    void exit(int reader);
+
+    /**
+     * @brief Make a new version current. Writer only.
+     *
+     * The replaced version is released by this or a later call once no reader can still hold it.
+     * @param version The new version.
+     */
+    void publish(std::shared_ptr<const NetworkSnapshot> version);
+
+    /**
+     * @brief Release the retired versions that no reader can hold anymore. Writer only.
+     * @return The number of retired versions that are still held by readers.
+     */
+    std::size_t reclaim();
+
+    /**
+     * @brief Get the number of versions published so far.
+     * @return The version number of the current version, 0 for the initial empty network.
+     */
+    std::uint64_t version() const;
+
+private:
+    /**
+     * @struct ReaderSlot
+     * @brief The announcement of one reader, padded to its own cache line.
+     */
+    struct ReaderSlot {
+        std::atomic<std::uint64_t> epoch;  // The epoch announced by the reader, 0 if it is not reading.
+        std::atomic<bool> in_use;  // true if a reader owns the slot.
+        char padding[64 - sizeof(std::atomic<std::uint64_t>) - sizeof(std::atomic<bool>)];  // Avoids false sharing.
+    };
+
+    /**
+     * @struct SlotBlock
+     * @brief A fixed block of reader slots, chained so that slots never move.
+     */
+    struct SlotBlock {
+        ReaderSlot slots[kBlockSlots];  // The slots of the block.
+    };
+
+    std::atomic<const NetworkSnapshot*> current;  // The version new readers see.
+    std::shared_ptr<const NetworkSnapshot> current_owner;  // Keeps the current version alive.
+    std::vector<std::pair<std::uint64_t, std::shared_ptr<const NetworkSnapshot>>> retired;  // Replaced versions and their epochs.
+    std::atomic<std::uint64_t> global_epoch;  // Advanced on every publish.
+    std::atomic<std::uint64_t> published;  // The number of versions published.
+
+    std::unique_ptr<SlotBlock> blocks[kMaxBlocks];  // Blocks of reader slots, allocated on demand.
+    std::atomic<int> num_blocks;  // The number of allocated blocks.
+    std::mutex registration;  // Serializes registerReader.
+
+    /**
+     * @brief Get a reader slot by number.
+     * @param reader The reader slot.
+     * @return The slot.
+     */
+    ReaderSlot& slot(int reader);
+};
+
+#endif // SNAPSHOTPUBLISHER_H
@@ -1,20 +1,30 @@
 #include "SocialNetwork.h"
+#include "ParallelSort.h"
+#include "SetIntersection.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
 #include <queue>
 #include <stack>
+#include <utility>
 #include <vector>
 
 /**
  * @brief Default constructor for SocialNetwork class.
- * Initializes adjacency_list to nullptr and num_of_users to 0.
+ * Initializes an empty user table and num_of_users to 0.
  */
-SocialNetwork::SocialNetwork() : adjacency_list(nullptr), num_of_users(0) {}
+SocialNetwork::SocialNetwork()
+    : statistics_stale(false), num_of_users(0), snapshot_stale(true), snapshot_backed(false), num_threads(0),
+      replaying(false) {}
 
 
 /**
  * @brief Destructor for SocialNetwork class.
- * Calls the clearNetwork function to delete all users and connections.
+ * Closes the journal, then calls the clearNetwork function to delete all users and connections.
  */
 SocialNetwork::~SocialNetwork() {
+    closeJournal();
     clearNetwork();
 }
 
@@ -23,33 +33,20 @@ SocialNetwork::~SocialNetwork() {
  * @brief Adds a user to the social network.
  * @param user_id The ID of the user to be added.
  */
-void SocialNetwork::addUser(int user_id) {
+NetworkStatus SocialNetwork::addUser(UserId user_id) {
+    materialize();
     // check if user already exists
     if (findUser(user_id)) {
-        std::cout << "User with ID " << user_id << " already exists." << std::endl;
-        return;
+        return NetworkStatus::UserExists;
     }
 
-    //Create new user node
-    UserNodePtr newUser = new UserNode(user_id);
-
-    //Check if list is empty
-    if (adjacency_list == nullptr) {
-        adjacency_list = newUser;
+    allocateSlot(user_id);
+    snapshot_stale = true;
 
-    }
-    else {
-        //Here, list is not empty, so traverse the list
-        UserNodePtr currentNode = adjacency_list;
-        while (currentNode->next != nullptr) {
-            currentNode = currentNode->next;
-        }
-        //Append new user to the end of the list
-        currentNode->next = newUser;
-    }
     //Increment number of users
     num_of_users++;
-    std::cout << "User " << user_id << " added successfully." << std::endl;
+    journalChange(JournalOperation::AddUser, user_id);
+    return NetworkStatus::Ok;
 }
 
 
@@ -57,80 +54,40 @@ void SocialNetwork::addUser(int user_id) {
  * @brief Removes a user from the social network.
  * @param user_id The ID of the user to be removed.
  */
-void SocialNetwork::removeUser(int user_id) {
+NetworkStatus SocialNetwork::removeUser(UserId user_id) {
+    materialize();
     // check if the network is empty
     if (isEmpty()) {
-        std::cout << "Network is empty." << std::endl;
-        return;
+        return NetworkStatus::EmptyNetwork;
     }
     // check if a user exists
-    UserNodePtr userToRemove = findUser(user_id);
+    UserRecord* userToRemove = findUser(user_id);
     if (userToRemove == nullptr) {
-        std::cout << "User with ID " << user_id << " not found." << std::endl;
-        return;
+        return NetworkStatus::UserNotFound;
     }
 
-    if (userToRemove == adjacency_list) {
-        adjacency_list = userToRemove->next;
-    }
-    else {
-        // Find the previous node of the user to remove
-        UserNodePtr prevNode = adjacency_list;
-        while (prevNode != nullptr && prevNode->next != userToRemove) {
-            prevNode = prevNode->next;
-        }
-
-        // check if previous node is found
-        if (prevNode != nullptr) {
-            // Bypass the user to remove
-            prevNode->next = userToRemove->next;
-        }
-        else {
-            std::cout << "User with ID " << user_id << " not found." << std::endl;
-            return;
-        }
-    }
-    // Remove connections of the user from other users
-    UserNodePtr currentNode = adjacency_list;
-    while (currentNode != nullptr) {
-        UserNodePtr prevConnection = nullptr;
-        UserNodePtr currentConnection = currentNode->connections;
-
-        while (currentConnection != nullptr) {
-            // Check if connection points to the user to remove
-            if (currentConnection->user_id == user_id) {
-                // If it's the first connection, update the head
-                if (prevConnection == nullptr) {
-                    currentNode->connections = currentConnection->next;
-                }
-                else {
-                    // Otherwise, bypass the connection to remove
-                    prevConnection->next = currentConnection->next;
-                }
-                // Delete the connection node
-                delete currentConnection;
-                // Update the current connection to point to the next connection
-                if (prevConnection != nullptr) {
-                    currentConnection = prevConnection->next;
-                }
-                else {
-                    // If prevConnection is null, it means the first connection was removed,
-                    // so we need to update currentConnection to the new head.
-                    currentConnection = currentNode->connections;
-                }
-            }
-            else {
-                // Move to the next connection
-                prevConnection = currentConnection;
-                currentConnection = currentConnection->next;
-            }
-        }
-        // Move to the next user in the adjacency list
-        currentNode = currentNode->next;
-    }
-    delete userToRemove;
+    // Remove connections of the user from its neighbors only
+    int slot = static_cast<int>(userToRemove - users.data());
+    int degree = userToRemove->connections.size();
+    userToRemove->connections.forEach([&](int neighborSlot) {
+        UserRecord& neighbor = users[neighborSlot];
+        network_statistics.removeConnection(neighbor.connections.size(), degree);
+        neighbor.connections.erase(slot);
+        components.removeConnection(neighborSlot, slot);
+        degree--;
+    });
+
+    // Release the slot for reuse
+    components.removeSlot(slot);
+    network_statistics.removeUser(degree);
+    userToRemove->connections.clear();
+    userToRemove->in_use = false;
+    user_index.erase(user_id);
+    free_slots.push_back(slot);
     num_of_users--;
-    std::cout << "User " << user_id << " removed successfully." << std::endl;
+    snapshot_stale = true;
+    journalChange(JournalOperation::RemoveUser, user_id);
+    return NetworkStatus::Ok;
 }
 
 
@@ -139,382 +96,926 @@ void SocialNetwork::removeUser(int user_id) {
  * @param user_id1 The ID of the first user.
  * @param user_id2 The ID of the second user.
  */
-void SocialNetwork::addConnection(int user_id1, int user_id2) {
+NetworkStatus SocialNetwork::addConnection(UserId user_id1, UserId user_id2) {
+    materialize();
     if (user_id1 == user_id2) {
-        std::cout << "A user cannot connect to itself." << std::endl;
-        return;
-    }
-    // check for an existing connection
-    if (isConnected(user_id1, user_id2)) {
-        std::cout << "Connection between User " << user_id1 << " and User " << user_id2 << " already exists." << std::endl;
-        return;
+        return NetworkStatus::SelfConnection;
     }
 
     // find user nodes
-    UserNodePtr user1 = findUser(user_id1);
-    UserNodePtr user2 = findUser(user_id2);
+    UserRecord* user1 = findUser(user_id1);
+    UserRecord* user2 = findUser(user_id2);
 
     // check if user nodes exist
     if (user1 == nullptr || user2 == nullptr) {
-        if (user1 == nullptr) {
-            std::cout << "User with ID " << user_id1 << " not found." << std::endl;
+        return NetworkStatus::UserNotFound;
+    }
+
+    // check for an existing connection
+    if (isConnected(user_id1, user_id2)) {
+        return NetworkStatus::ConnectionExists;
+    }
+
+    // Add the connection to both users
+    int slot1 = static_cast<int>(user1 - users.data());
+    int slot2 = static_cast<int>(user2 - users.data());
+    network_statistics.addConnection(user1->connections.size(), user2->connections.size());
+    user1->connections.insert(slot2);
+    user2->connections.insert(slot1);
+    components.addConnection(slot1, slot2);
+    snapshot_stale = true;
+    journalChange(JournalOperation::AddConnection, user_id1, user_id2);
+    return NetworkStatus::Ok;
+}
+
+/**
+ * @brief Add many connections at once with a parallel sort-based pass.
+ * @param connections Pairs of user IDs to connect.
+ * @return The number of connections added.
+ */
+long long SocialNetwork::loadConnections(const std::vector<std::pair<UserId, UserId>>& connections) {
+    materialize();
+    ThreadPool& pool = threadPool();
+    const std::size_t count = connections.size();
+    const std::uint64_t kSelfConnection = ~std::uint64_t(0);
+
+    // Add the users that are not in the network yet
+    std::vector<std::uint64_t> ids(count * 2);
+    pool.parallelFor(count, 1 << 14, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t position = begin; position < end; position++) {
+            ids[2 * position] = static_cast<std::uint64_t>(connections[position].first);
+            ids[2 * position + 1] = static_cast<std::uint64_t>(connections[position].second);
         }
-        if (user2 == nullptr) {
-            std::cout << "User with ID " << user_id2 << " not found." << std::endl;
+    });
+    parallelSort(ids, pool);
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    user_index.reserve(user_index.size() + ids.size());
+    for (std::uint64_t id : ids) {
+        UserId user_id = static_cast<UserId>(id);
+        if (user_index.find(user_id) == -1) {
+            allocateSlot(user_id);
+            num_of_users++;
+        }
+    }
+    std::vector<std::uint64_t>().swap(ids);
+
+    // Offsets of the existing connections of every slot
+    std::vector<std::size_t> existing(users.size() + 1, 0);
+    for (std::size_t slot = 0; slot < users.size(); slot++) {
+        existing[slot + 1] = existing[slot] + users[slot].connections.size();
+    }
+    const std::size_t existingCount = existing[users.size()];
+
+    // Every connection becomes two directed (slot, slot) keys, existing connections first
+    std::vector<std::uint64_t> keys(existingCount + count * 2);
+    pool.parallelFor(users.size(), 1 << 12, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t slot = begin; slot < end; slot++) {
+            std::size_t position = existing[slot];
+            users[slot].connections.forEach([&](int neighbor) {
+                keys[position++] = (std::uint64_t(slot) << 32) | static_cast<std::uint32_t>(neighbor);
+            });
+        }
+    });
+    pool.parallelFor(count, 1 << 14, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t position = begin; position < end; position++) {
+            std::uint64_t slot1 = static_cast<std::uint32_t>(user_index.find(connections[position].first));
+            std::uint64_t slot2 = static_cast<std::uint32_t>(user_index.find(connections[position].second));
+            std::uint64_t* key = &keys[existingCount + 2 * position];
+            if (slot1 == slot2) {
+                key[0] = kSelfConnection;
+                key[1] = kSelfConnection;
+            }
+            else {
+                key[0] = (slot1 << 32) | slot2;
+                key[1] = (slot2 << 32) | slot1;
+            }
+        }
+    });
+
+    // Sort, then drop duplicates and self-connections, which sort last
+    parallelSort(keys, pool);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    if (!keys.empty() && keys.back() == kSelfConnection) {
+        keys.pop_back();
+    }
+
+    // Rebuild every connection set from its run of sorted keys, in parallel since the runs are disjoint
+    for (UserRecord& user : users) {
+        if (user.in_use) {
+            network_statistics.removeUser(user.connections.size());
+        }
+    }
+    std::vector<std::size_t> runs(users.size() + 1, keys.size());
+    for (std::size_t position = keys.size(); position-- > 0; ) {
+        runs[keys[position] >> 32] = position;
+    }
+    for (std::size_t slot = users.size(); slot-- > 0; ) {
+        runs[slot] = std::min(runs[slot], runs[slot + 1]);
+    }
+    pool.parallelFor(users.size(), 1 << 10, [&](unsigned, std::size_t begin, std::size_t end) {
+        std::vector<int> neighbors;
+        for (std::size_t slot = begin; slot < end; slot++) {
+            neighbors.clear();
+            for (std::size_t position = runs[slot]; position < runs[slot + 1]; position++) {
+                neighbors.push_back(static_cast<int>(keys[position] & 0xFFFFFFFFu));
+            }
+            users[slot].connections.assign(neighbors.data(), neighbors.size());
+        }
+    });
+    for (std::uint64_t key : keys) {
+        int slot1 = static_cast<int>(key >> 32);
+        int slot2 = static_cast<int>(key & 0xFFFFFFFFu);
+        // Each connection appears in both directions, merge it once
+        if (slot1 < slot2) {
+            components.addConnection(slot1, slot2);
+        }
+    }
+    for (const UserRecord& user : users) {
+        if (user.in_use) {
+            network_statistics.addUser(user.connections.size());
         }
-        return;
     }
+    snapshot_stale = true;
 
-    // create new connection nodes
-    UserNodePtr newUser1Connection = new UserNode(user_id2);
-    UserNodePtr newUser2Connection = new UserNode(user_id1);
+    // Journal every pair, the ones that were already connected replay as no-ops
+    if (journal.isOpen() && !replaying) {
+        for (const std::pair<UserId, UserId>& connection : connections) {
+            journal.append(JournalOperation::LoadConnection, connection.first, connection.second);
+        }
+        if (journal.needsCompaction()) {
+            compactJournal();
+        }
+    }
 
-    // Add Connection to user1
-    newUser1Connection->next = user1->connections;
-    user1->connections = newUser1Connection;
+    return static_cast<long long>(keys.size() - existingCount) / 2;
+}
 
-    // Add Connection to user2
-    newUser2Connection->next = user2->connections;
-    user2->connections = newUser2Connection;
 
-    std::cout << "Connection added between " << user_id1 << " and " << user_id2 << "." << std::endl;
+/**
+ * @brief Add the connections of a text edge list file.
+ * @param path The path of the file.
+ * @return The number of connections added, or -1 if the file could not be read.
+ */
+long long SocialNetwork::loadEdgeListFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return -1;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Split the text at line breaks, one chunk per worker
+    ThreadPool& pool = threadPool();
+    const std::size_t chunks = pool.size();
+    std::vector<std::size_t> bounds(chunks + 1, text.size());
+    bounds[0] = 0;
+    for (std::size_t chunk = 1; chunk < chunks; chunk++) {
+        std::size_t position = std::max(bounds[chunk - 1], text.size() * chunk / chunks);
+        while (position > 0 && position < text.size() && text[position - 1] != '\n') {
+            position++;
+        }
+        bounds[chunk] = position;
+    }
+
+    std::vector<std::vector<std::pair<UserId, UserId>>> parsed(chunks);
+    pool.parallelFor(chunks, 1, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk < end; chunk++) {
+            const char* cursor = text.data() + bounds[chunk];
+            const char* last = text.data() + bounds[chunk + 1];
+
+            while (cursor < last) {
+                // Read up to two integers from the line
+                UserId values[2];
+                int found = 0;
+                bool comment = (*cursor == '#' || *cursor == '%');
+                while (!comment && found < 2 && cursor < last && *cursor != '\n') {
+                    // A minus sign only starts a number when a digit follows it
+                    bool negative = *cursor == '-' && cursor + 1 < last && cursor[1] >= '0' && cursor[1] <= '9';
+                    if (negative || (*cursor >= '0' && *cursor <= '9')) {
+                        if (negative) {
+                            cursor++;
+                        }
+                        // Accumulate unsigned so the full 64-bit range wraps instead of overflowing
+                        std::uint64_t value = 0;
+                        while (cursor < last && *cursor >= '0' && *cursor <= '9') {
+                            value = value * 10 + static_cast<std::uint64_t>(*cursor - '0');
+                            cursor++;
+                        }
+                        values[found++] = static_cast<UserId>(negative ? 0 - value : value);
+                    }
+                    else {
+                        cursor++;
+                    }
+                }
+                if (found == 2) {
+                    parsed[chunk].push_back(std::make_pair(values[0], values[1]));
+                }
+                // Skip the rest of the line
+                while (cursor < last && *cursor != '\n') {
+                    cursor++;
+                }
+                cursor++;
+            }
+        }
+    });
+    std::string().swap(text);
+
+    std::vector<std::pair<UserId, UserId>> connections;
+    for (const std::vector<std::pair<UserId, UserId>>& chunk : parsed) {
+        connections.insert(connections.end(), chunk.begin(), chunk.end());
+    }
+    return loadConnections(connections);
+}
+
+
+/**
+ * @brief Add the connections of a binary edge list file.
+ * @param path The path of the file.
+ * @return The number of connections added, or -1 if the file could not be read.
+ */
+long long SocialNetwork::loadBinaryEdgeFile(const std::string& path) {
+    static_assert(sizeof(std::pair<UserId, UserId>) == 2 * sizeof(std::int64_t), "pairs are read as two 64-bit IDs");
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return -1;
+    }
+    std::streamoff bytes = file.tellg();
+    if (bytes % sizeof(std::pair<UserId, UserId>) != 0) {
+        return -1;
+    }
 
+    std::vector<std::pair<UserId, UserId>> connections(static_cast<std::size_t>(bytes / sizeof(std::pair<UserId, UserId>)));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(connections.data()), bytes)) {
+        return -1;
+    }
+    return loadConnections(connections);
 }
 
+
 /**
  * @brief Removes a connection between two users in the social network.
  * @param user_id1 The ID of the first user.
  * @param user_id2 The ID of the second user.
  */
-void SocialNetwork::removeConnection(int user_id1, int user_id2) {
+NetworkStatus SocialNetwork::removeConnection(UserId user_id1, UserId user_id2) {
+    materialize();
     // check if the network is empty
     if (isEmpty()) {
-        std::cout << "Network is empty." << std::endl;
-        return;
+        return NetworkStatus::EmptyNetwork;
     }
     // check if a user exists
-    UserNodePtr user1 = findUser(user_id1);
-    UserNodePtr user2 = findUser(user_id2);
+    UserRecord* user1 = findUser(user_id1);
+    UserRecord* user2 = findUser(user_id2);
 
     if (user1 == nullptr || user2 == nullptr) {
-        if (user1 == nullptr) {
-            std::cout << "User with ID " << user_id1 << " not found." << std::endl;
-        }
-        if (user2 == nullptr) {
-            std::cout << "User with ID " << user_id2 << " not found." << std::endl;
-        }
-        return;
+        return NetworkStatus::UserNotFound;
     }
 
     // check if user is trying to disconnect themselves
     if (user_id1 == user_id2) {
-        std::cout << "A user cannot disconnect to itself." << std::endl;
-        return;
+        return NetworkStatus::SelfConnection;
     }
 
-    // check for an existing connection
-    if (!(isConnected(user_id1, user_id2))) {
-        std::cout << "Connection between User " << user_id1 << " and User " << user_id2 << " does not exist." << std::endl;
-        return;
+    // Remove connection from both users' connection sets
+    int slot1 = static_cast<int>(user1 - users.data());
+    int slot2 = static_cast<int>(user2 - users.data());
+    if (!user1->connections.contains(slot2)) {
+        return NetworkStatus::ConnectionNotFound;
     }
+    network_statistics.removeConnection(user1->connections.size(), user2->connections.size());
+    user1->connections.erase(slot2);
+    user2->connections.erase(slot1);
+    components.removeConnection(slot1, slot2);
+    snapshot_stale = true;
+    journalChange(JournalOperation::RemoveConnection, user_id1, user_id2);
+    return NetworkStatus::Ok;
+}
 
-    // Remove connection from user1
-    // Track previous connection in user1's list
-    UserNodePtr prevConnection1 = nullptr;
-    UserNodePtr currentConnection1 = user1->connections;
+/**
+ * @brief Find the length of the shortest path between two users in the social network.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return The length of the shortest path between the two users, or -1 if no path exists.
+ */
+int SocialNetwork::findShortestPath(UserId user_id1, UserId user_id2) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
 
-    while (currentConnection1 != nullptr) {
-        if (currentConnection1->user_id == user_id2) {
-            // If it's the first connection, update the head
-            if (prevConnection1 == nullptr) {
-                user1->connections = currentConnection1->next;
-            }
-            else {
-                // Otherwise, bypass the connection to remove
-                prevConnection1->next = currentConnection1->next;
+    int start = graph->indexOf(user_id1);
+    int end = graph->indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        return -1;
+    }
+    return path_search.run(*graph, start, end);
+}
+
+
+/**
+ * @brief Find the shortest path between two users in the social network.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+ * @return Ok, UserNotFound or NoPath.
+ */
+NetworkStatus SocialNetwork::findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    path.clear();
+
+    int start = graph->indexOf(user_id1);
+    int end = graph->indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        return NetworkStatus::UserNotFound;
+    }
+
+    // Search from both ends, the scratch arrays are reused between calls
+    if (path_search.run(*graph, start, end, &dense_scratch) == -1) {
+        return NetworkStatus::NoPath;
+    }
+
+    // Translate the path to user IDs
+    path.reserve(dense_scratch.size());
+    for (int user : dense_scratch) {
+        path.push_back(graph->userId(user));
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Find the shortest paths of a batch of user pairs in parallel.
+ * @param queries Pairs of (first user ID, second user ID).
+ * @param include_paths If false, only the path lengths are computed.
+ * @return One result per query, in query order, with the paths given as user IDs.
+ */
+std::vector<PathResult> SocialNetwork::findShortestPaths(const std::vector<std::pair<UserId, UserId>>& queries, bool include_paths) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+
+    // Unknown users map to -1 and get no path
+    std::vector<std::pair<int, int>> denseQueries(queries.size());
+    for (std::size_t position = 0; position < queries.size(); position++) {
+        denseQueries[position].first = graph->indexOf(queries[position].first);
+        denseQueries[position].second = graph->indexOf(queries[position].second);
+    }
+
+    std::vector<PathResult> results;
+    ThreadPool& pool = threadPool();
+    batch_paths.run(*graph, pool, denseQueries, include_paths, results);
+
+    // Translate the paths back to user IDs
+    if (include_paths) {
+        pool.parallelFor(results.size(), 256, [&results, &graph](unsigned, std::size_t begin, std::size_t end) {
+            for (std::size_t position = begin; position < end; position++) {
+                for (UserId& user : results[position].path) {
+                    user = graph->userId(static_cast<int>(user));
+                }
             }
-            // Delete the connection node
-            delete currentConnection1;
-            break;
-        }
-        else {
-            // Move to the next connection
-            prevConnection1 = currentConnection1;
-            currentConnection1 = currentConnection1->next;
+        });
+    }
+    return results;
+}
+
+
+/**
+ * @brief Build a landmark distance oracle for estimateDistance().
+ * @param landmarks The number of landmarks.
+ * @param selection How the landmarks are chosen.
+ * @param seed The seed of a random selection.
+ */
+void SocialNetwork::buildDistanceOracle(int landmarks, LandmarkSelection selection, std::uint64_t seed) {
+    dropDistanceOracle();
+    distance_oracle = DistanceOracle::build(snapshot(), landmarks, selection, seed, &threadPool());
+}
+
+
+/**
+ * @brief Drop the distance oracle, waiting for a background rebuild to finish.
+ */
+void SocialNetwork::dropDistanceOracle() {
+    if (oracle_rebuild.valid()) {
+        oracle_rebuild.wait();
+        oracle_rebuild = std::future<std::shared_ptr<const DistanceOracle>>();
+    }
+    distance_oracle.reset();
+}
+
+
+/**
+ * @brief Estimate the distance between two users from the oracle, or exactly if it is stale or its bounds are too loose.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @param estimate Receives the bounds on the distance.
+ * @param max_gap The largest accepted difference between the upper and lower bound.
+ * @return Ok, UserNotFound or NoPath.
+ */
+NetworkStatus SocialNetwork::estimateDistance(UserId user_id1, UserId user_id2, DistanceEstimate& estimate, int max_gap) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    int start = graph->indexOf(user_id1);
+    int end = graph->indexOf(user_id2);
+    if (start == -1 || end == -1) {
+        estimate = DistanceEstimate{ -1, -1, false };
+        return NetworkStatus::UserNotFound;
+    }
+
+    refreshDistanceOracle(graph);
+    if (distance_oracle && distance_oracle->snapshot().get() == graph.get()) {
+        estimate = distance_oracle->estimate(start, end);
+        if (estimate.exact || (estimate.upper != -1 && estimate.upper - estimate.lower <= max_gap)) {
+            return estimate.upper == -1 ? NetworkStatus::NoPath : NetworkStatus::Ok;
         }
     }
-    // Remove connection from user2's connections list
-    UserNodePtr prevConnection2 = nullptr;
-    UserNodePtr currentConnection2 = user2->connections;
 
-    while (currentConnection2 != nullptr) {
-        if (currentConnection2->user_id == user_id1) {
-            // If it's the first connection, update the head
-            if (prevConnection2 == nullptr) {
-                user2->connections = currentConnection2->next;
-            }
-            else {
-                // Otherwise, bypass the connection to remove
-                prevConnection2->next = currentConnection2->next;
-            }
-            // Delete the connection node
-            delete currentConnection2;
-            break;
+    // The oracle is stale or its bounds are too loose, search from both ends
+    int distance = path_search.run(*graph, start, end);
+    estimate = DistanceEstimate{ distance, distance, true };
+    return distance == -1 ? NetworkStatus::NoPath : NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Find the connections two users have in common.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @param mutual Receives the IDs of the mutual connections in ascending order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus SocialNetwork::mutualConnections(UserId user_id1, UserId user_id2, std::vector<UserId>& mutual) {
+    mutual.clear();
+
+    // A stale snapshot is not rebuilt for one query, the connection sets are intersected instead
+    if (snapshot_stale && !snapshot_backed) {
+        const UserRecord* user1 = findUser(user_id1);
+        const UserRecord* user2 = findUser(user_id2);
+        if (user1 == nullptr || user2 == nullptr) {
+            return NetworkStatus::UserNotFound;
         }
-        else {
-            // Move to the next connection
-            prevConnection2 = currentConnection2;
-            currentConnection2 = currentConnection2->next;
+        dense_scratch.resize(std::min(user1->connections.size(), user2->connections.size()));
+        std::size_t count = user1->connections.intersect(user2->connections, dense_scratch.data());
+        mutual.reserve(count);
+        for (std::size_t position = 0; position < count; position++) {
+            mutual.push_back(users[dense_scratch[position]].user_id);
         }
+        std::sort(mutual.begin(), mutual.end());
+        return NetworkStatus::Ok;
+    }
 
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+
+    int index1 = graph->indexOf(user_id1);
+    int index2 = graph->indexOf(user_id2);
+    if (index1 == -1 || index2 == -1) {
+        return NetworkStatus::UserNotFound;
     }
-    std::cout << "Connection removed between " << user_id1 << " and " << user_id2 << "." << std::endl;
 
+    dense_scratch.resize(std::min(graph->degree(index1), graph->degree(index2)));
+    std::size_t count = intersectSorted(graph->neighborsBegin(index1), graph->degree(index1),
+                                        graph->neighborsBegin(index2), graph->degree(index2), dense_scratch.data());
+
+    // Dense indices are in ID order, so the IDs stay sorted
+    mutual.reserve(count);
+    for (std::size_t position = 0; position < count; position++) {
+        mutual.push_back(graph->userId(dense_scratch[position]));
+    }
+    return NetworkStatus::Ok;
 }
 
+
 /**
- * @brief Find the shortest path between two users in the social network.
- * @param user_id1 The ID of the first user.
- * @param user_id2 The ID of the second user.
- * @return The length of the shortest path between the two users, or -1 if no path exists.
+ * @brief Count the mutual connections of a batch of user pairs in parallel.
+ * @param queries Pairs of (first user ID, second user ID).
+ * @return The number of mutual connections of every pair, in query order, -1 if a user does not exist.
  */
-int SocialNetwork::findShortestPath(int user_id1, int user_id2) {
-    int max_user_id_encountered = std::max(user_id1, user_id2);  // Update the maximum user ID encountered
+std::vector<int> SocialNetwork::mutualConnectionCounts(const std::vector<std::pair<UserId, UserId>>& queries) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+
+    // Unknown users map to -1 and get no count
+    std::vector<std::pair<int, int>> denseQueries(queries.size());
+    for (std::size_t position = 0; position < queries.size(); position++) {
+        denseQueries[position].first = graph->indexOf(queries[position].first);
+        denseQueries[position].second = graph->indexOf(queries[position].second);
+    }
+
+    std::vector<int> counts;
+    batch_mutual.run(*graph, threadPool(), denseQueries, counts);
+    return counts;
+}
 
-    std::vector<int> distance(max_user_id_encountered + 1, INT_MAX);
-    std::vector<int> parent(max_user_id_encountered + 1, -1);
-    std::queue<UserNodePtr> q;
 
-    UserNodePtr startNode = findUser(user_id1);
-    if (startNode == nullptr) {
-        std::cout << "User with ID " << user_id1 << " does not exist." << std::endl;
-        return -1;
+/**
+ * @brief Recommend the users a user is not connected to that share the most connections with them.
+ * @param user_id The ID of the user.
+ * @param k The maximum number of recommendations.
+ * @param recommendations Receives the recommended user IDs with their mutual counts and scores, best first.
+ * @param score How candidates are scored.
+ * @param max_fanout The fan-out cap, 0 for no limit.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus SocialNetwork::recommendConnections(UserId user_id, int k, std::vector<Recommendation>& recommendations,
+                                                  RecommendationScore score, int max_fanout) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    recommendations.clear();
+
+    int index = graph->indexOf(user_id);
+    if (index == -1) {
+        return NetworkStatus::UserNotFound;
     }
 
-    q.push(startNode);
-    distance[startNode->user_id] = 0;
+    recommender.recommend(*graph, index, k, score, max_fanout, recommendations);
+    for (Recommendation& recommendation : recommendations) {
+        recommendation.user = graph->userId(static_cast<int>(recommendation.user));
+    }
+    return NetworkStatus::Ok;
+}
 
-    while (!q.empty()) {
-        UserNodePtr currentUser = q.front();
-        q.pop();
 
-        if (currentUser->user_id == user_id2) {
-            break;
+/**
+ * @brief Recommend connections for many users in parallel.
+ * @param user_ids The IDs of the users.
+ * @param k The maximum number of recommendations per user.
+ * @param score How candidates are scored.
+ * @param max_fanout The fan-out cap, 0 for no limit.
+ * @return The recommendations of every user, in query order, as user IDs.
+ */
+std::vector<std::vector<Recommendation>> SocialNetwork::recommendConnections(const std::vector<UserId>& user_ids, int k,
+                                                                             RecommendationScore score, int max_fanout) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+
+    std::vector<int> denseUsers(user_ids.size());
+    for (std::size_t position = 0; position < user_ids.size(); position++) {
+        denseUsers[position] = graph->indexOf(user_ids[position]);
+    }
+
+    std::vector<std::vector<Recommendation>> recommendations;
+    recommender.recommendBatch(*graph, threadPool(), denseUsers, k, score, max_fanout, recommendations);
+    for (std::vector<Recommendation>& list : recommendations) {
+        for (Recommendation& recommendation : list) {
+            recommendation.user = graph->userId(static_cast<int>(recommendation.user));
         }
+    }
+    return recommendations;
+}
 
-        UserNodePtr neighbor = currentUser->connections;
 
-        while (neighbor != nullptr) {
-            int neighborId = neighbor->user_id;
+/**
+ * @brief Count the triangles of the network and its clustering coefficients in parallel.
+ * @return The per-user counts and coefficients, indexed by the dense indices of snapshot(), and the global summaries.
+ */
+TriangleStatistics SocialNetwork::countTriangles() {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    TriangleStatistics statistics;
+    ::countTriangles(*graph, threadPool(), statistics);
+    return statistics;
+}
+
+
+/**
+ * @brief Rank the users by influence with PageRank, in parallel.
+ * @param options The damping, tolerance, iteration limit and warm start.
+ * @return The scores, indexed by the dense indices of snapshot().
+ */
+PageRankResult SocialNetwork::pageRank(const PageRankOptions& options) {
+    PageRankResult result;
+    pageRank(std::vector<UserId>(), result, options);
+    return result;
+}
 
-            if (distance[neighborId] == INT_MAX) {
-                distance[neighborId] = distance[currentUser->user_id] + 1;
-                parent[neighborId] = currentUser->user_id;
-                q.push(findUser(neighborId));
-            }
 
-            neighbor = neighbor->next;
+/**
+ * @brief Rank the users by their influence on a seed set with personalized PageRank, in parallel.
+ * @param seed_ids The IDs of the seed users, or empty to jump to every user.
+ * @param result Receives the scores, indexed by the dense indices of snapshot().
+ * @param options The damping, tolerance, iteration limit and warm start.
+ * @return Ok, or UserNotFound if a seed does not exist.
+ */
+NetworkStatus SocialNetwork::pageRank(const std::vector<UserId>& seed_ids, PageRankResult& result,
+                                      const PageRankOptions& options) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+
+    std::vector<UserId> sortedSeeds(seed_ids);
+    std::sort(sortedSeeds.begin(), sortedSeeds.end());
+    sortedSeeds.erase(std::unique(sortedSeeds.begin(), sortedSeeds.end()), sortedSeeds.end());
+    std::vector<int> seeds;
+    seeds.reserve(sortedSeeds.size());
+    for (UserId seedId : sortedSeeds) {
+        int seed = graph->indexOf(seedId);
+        if (seed == -1) {
+            result = PageRankResult{ std::vector<double>(), 0, 0.0, false };
+            return NetworkStatus::UserNotFound;
         }
+        seeds.push_back(seed);
     }
 
-    if (parent[user_id2] == -1) {
-        std::cout << "There is no path from user " << user_id1 << " to user " << user_id2 << "." << std::endl;
-        return -1;
+    // Scores for other seeds are a poor start, so only the same seed set is warm-started
+    std::vector<double> initial;
+    if (options.warm_start && page_rank_graph && sortedSeeds == page_rank_seeds) {
+        if (page_rank_graph == graph) {
+            initial = page_rank_scores;
+        }
+        else {
+            carryScores(*page_rank_graph, page_rank_scores, *graph, initial);
+        }
     }
 
-    // Retrieve the shortest path
-    std::vector<int> shortestPath;
-    int currentNode = user_id2;
-    while (currentNode != -1) {
-        shortestPath.push_back(currentNode);
-        currentNode = parent[currentNode];
-    }
+    computePageRank(*graph, threadPool(), options, seeds, initial, result);
+    page_rank_graph = graph;
+    page_rank_seeds.swap(sortedSeeds);
+    page_rank_scores = result.scores;
+    return NetworkStatus::Ok;
+}
 
-    // Reverse the path to obtain the correct order
-    reverse(shortestPath.begin(), shortestPath.end());
 
-    std::cout << "Shortest path from user " << user_id1 << " to user " << user_id2 << ": ";
-    for (int node : shortestPath) {
-        std::cout << node << " ";
+/**
+ * @brief Measure the betweenness centrality of every user, in parallel.
+ * @param options The error bound, its probability and the seed of the samples.
+ * @return The centrality, indexed by the dense indices of snapshot(), and its error bound.
+ */
+BetweennessResult SocialNetwork::betweenness(const BetweennessOptions& options) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    BetweennessResult result;
+    if (options.epsilon > 0) {
+        estimateBetweenness(*graph, threadPool(), options, result);
+    }
+    else {
+        computeBetweenness(*graph, threadPool(), result);
     }
-    std::cout << std::endl;
+    return result;
+}
 
-    return distance[user_id2];
+
+/**
+ * @brief Estimate how many users are within every number of hops of every user, in parallel.
+ * @param options The counter size, the hops to keep and the seed.
+ * @return The estimated reach, indexed by the dense indices of snapshot(), the neighborhood function and the
+ *         effective diameter.
+ */
+NeighborhoodResult SocialNetwork::neighborhoodFunction(const NeighborhoodOptions& options) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    NeighborhoodResult result;
+    approximateNeighborhoodFunction(*graph, threadPool(), options, result);
+    return result;
 }
 
 
 /**
  * @brief Perform a breadth-first search (BFS) starting from a given user in the social network.
  * @param user_id The ID of the user to start the search from.
+ * @return The levels, parents and visiting order, indexed by the dense indices of snapshot().
  */
-void SocialNetwork::BFS(int user_id) {
-    UserNodePtr startNode = findUser(user_id);
-    if (startNode == nullptr) {
-        std::cout << "User with ID " << user_id << " does not exist." << std::endl;
-        return;
+BfsResult SocialNetwork::BFS(UserId user_id) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
+    BfsResult result;
+    result.source = -1;
+
+    int start = graph->indexOf(user_id);
+    if (start != -1) {
+        // Callers get the levels and a tree, so skip the pass that fixes the order within each level
+        bfs_engine.run(*graph, start, false, result);
     }
+    return result;
+}
 
-    std::vector<bool> visited(numberOfUsers() + 1, false); // Initialize all users as not visited
-    std::queue<UserNodePtr> bfsQueue;
-    bfsQueue.push(startNode);
-    visited[user_id] = true; // Mark the first user as visited
-    std::cout << "BFS starting from vertex " << user_id << ": ";
 
-    while (!bfsQueue.empty()) {
-        UserNodePtr currentNode = bfsQueue.front();
-        std::cout << currentNode->user_id;
-        bfsQueue.pop();
+/**
+ * @brief Perform a breadth-first search (BFS) starting from a given user in the social network.
+ * @param user_id The ID of the user to start the search from.
+ * @param order Receives the IDs of the reached users in visiting order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus SocialNetwork::BFS(UserId user_id, std::vector<UserId>& order) {
+    order.clear();
+    return BFS(user_id, [&order](UserId visited, int) {
+        order.push_back(visited);
+    });
+}
 
-        // Collect neighbors' IDs in a vector
-        std::vector<int> neighbor_ids;
-        UserNodePtr neighbor = currentNode->connections;
-        while (neighbor != nullptr) {
-            neighbor_ids.push_back(neighbor->user_id);
-            neighbor = neighbor->next;
-        }
 
-        // Sort the neighbor IDs
-        std::sort(neighbor_ids.begin(), neighbor_ids.end());
+/**
+ * @brief Perform a breadth-first search (BFS) starting from a given user in the social network.
+ * @param user_id The ID of the user to start the search from.
+ * @param visitor Called with the ID and level of every reached user, in visiting order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus SocialNetwork::BFS(UserId user_id, const std::function<void(UserId user_id, int level)>& visitor) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
 
-        // Enqueue neighbors in sorted order
-        for (int id : neighbor_ids) {
-            if (!visited[id]) {
-                bfsQueue.push(findUser(id));
-                visited[id] = true; // Mark the neighbor as visited
-            }
-        }
+    int start = graph->indexOf(user_id);
+    if (start == -1) {
+        return NetworkStatus::UserNotFound;
+    }
 
-        if (!bfsQueue.empty()) {
-            std::cout << ", ";
-        }
+    BfsResult result;
+    bfs_engine.run(*graph, start, true, result);
+    for (int index : result.order) {
+        visitor(graph->userId(index), result.level[index]);
     }
+    return NetworkStatus::Ok;
+}
 
-    std::cout << std::endl;
+
+/**
+ * @brief Perform a depth-first search (DFS) starting from a given user in the social network.
+ * @param user_id The ID of the user to start the search from.
+ * @param order Receives the IDs of the reached users in visiting order.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus SocialNetwork::DFS(UserId user_id, std::vector<UserId>& order) {
+    order.clear();
+    return DFS(user_id, [&order](UserId visited) {
+        order.push_back(visited);
+    });
 }
 
+
 /**
  * @brief Perform a depth-first search (DFS) starting from a given user in the social network.
  * @param user_id The ID of the user to start the search from.
+ * @param visitor Called with the ID of every reached user, in visiting order.
+ * @return Ok, or UserNotFound.
  */
-void SocialNetwork::DFS(int userId) {
-    std::vector<bool> visited(num_of_users + 1, false);
-    std::stack<UserNodePtr> dfsStack;
+NetworkStatus SocialNetwork::DFS(UserId userId, const std::function<void(UserId user_id)>& visitor) {
+    std::shared_ptr<const NetworkSnapshot> graph = snapshot();
 
-    UserNodePtr startNode = findUser(userId);
-    if (startNode == nullptr) {
-        std::cout << "User with ID " << userId << " does not exist." << std::endl;
-        return;
+    int start = graph->indexOf(userId);
+    if (start == -1) {
+        return NetworkStatus::UserNotFound;
     }
 
-    std::cout << "DFS starting from vertex " << userId << ": ";
+    std::vector<bool> visited(graph->numberOfUsers(), false);
+    std::stack<int> dfsStack;
 
-    dfsStack.push(startNode);
-    visited[startNode->user_id] = true;
-
-    bool firstNode = true; // Flag to handle the first node
+    dfsStack.push(start);
+    visited[start] = true;
 
     while (!dfsStack.empty()) {
-        UserNodePtr currentNode = dfsStack.top();
+        int current = dfsStack.top();
         dfsStack.pop();
 
-        if (!firstNode) {
-            std::cout << ", ";
-        }
-        else {
-            firstNode = false;
-        }
+        visitor(graph->userId(current));
 
-        std::cout << currentNode->user_id;
-
-        UserNodePtr neighbor = currentNode->connections;
-        while (neighbor != nullptr) {
-            if (!visited[neighbor->user_id]) {
-                dfsStack.push(findUser(neighbor->user_id));
-                visited[neighbor->user_id] = true;
+        // Push in descending order so the neighbor with the smallest ID is explored first
+        for (const int* neighbor = graph->neighborsEnd(current); neighbor != graph->neighborsBegin(current); ) {
+            --neighbor;
+            if (!visited[*neighbor]) {
+                dfsStack.push(*neighbor);
+                visited[*neighbor] = true;
             }
-            neighbor = neighbor->next;
         }
     }
+    return NetworkStatus::Ok;
+}
 
-    std::cout << std::endl;
+
+/**
+ * @brief Check if two users are in the same connected component.
+ * @param user_id1 The ID of the first user.
+ * @param user_id2 The ID of the second user.
+ * @return true if a path joins the two users, false otherwise (including when a user does not exist).
+ */
+bool SocialNetwork::sameComponent(UserId user_id1, UserId user_id2) {
+    materialize();
+    int slot1 = user_index.find(user_id1);
+    int slot2 = user_index.find(user_id2);
+    if (slot1 == -1 || slot2 == -1) {
+        return false;
+    }
+    flushComponents();
+    return components.find(slot1) == components.find(slot2);
 }
 
 
 /**
- * @brief Find a user in the network.
- * @param user_id The ID of the user to find.
- * @return A pointer to the user if found, nullptr otherwise.
+ * @brief Get the number of users in the connected component of a user.
+ * @param user_id The ID of the user.
+ * @return The size of the user's component, including the user, or 0 if the user does not exist.
  */
-SocialNetwork::UserNodePtr SocialNetwork::findUser(int userId) const {
-    auto findUser = [this](int userId) -> UserNodePtr {
-        UserNodePtr current = adjacency_list;
-        while (current != nullptr) {
-            if (current->user_id == userId) {
-                // Return the user node pointer if found
-                return current;
-            }
-            current = current->next;
-        }
-        // Return nullptr if user not found
-        return nullptr;
-    };
+int SocialNetwork::componentSize(UserId user_id) {
+    materialize();
+    int slot = user_index.find(user_id);
+    if (slot == -1) {
+        return 0;
+    }
+    flushComponents();
+    return components.componentSize(slot);
+}
 
-    // Call the lambda function and return its result
-    return findUser(userId);
+
+/**
+ * @brief Get the number of connected components.
+ * @return The number of components, counting users without connections.
+ */
+int SocialNetwork::numberOfComponents() {
+    materialize();
+    flushComponents();
+    return components.numberOfComponents();
 }
 
+
 /**
- * @brief Prints the network.
+ * @brief Get the sizes of all connected components.
+ * @return The size of every component, largest first.
  */
-void SocialNetwork::printNetwork() const {
-    // Check if the network is empty
-    if (isEmpty()) {
-        std::cout << "Network is empty." << std::endl;
-        return;
+std::vector<int> SocialNetwork::componentSizes() {
+    materialize();
+    flushComponents();
+    return components.componentSizes();
+}
+
+
+/**
+ * @brief Check if a user is in the network.
+ * @param user_id The ID of the user.
+ * @return true if the user is in the network, false otherwise.
+ */
+bool SocialNetwork::hasUser(UserId user_id) const {
+    if (snapshot_backed) {
+        return current_snapshot->indexOf(user_id) != -1;
     }
+    return user_index.find(user_id) != -1;
+}
 
-    UserNodePtr currentNode = adjacency_list;
-    while (currentNode != nullptr) {
-        std::cout << "\n--------------------------" << std::endl;
-        std::cout << "User ID: " << currentNode->user_id << std::endl;
 
-        // Count the number of connections
-        int numConnections = 0;
-        UserNodePtr currentConnection = currentNode->connections;
-        while (currentConnection != nullptr) {
-            numConnections++;
-            currentConnection = currentConnection->next;
+/**
+ * @brief Get the IDs of all users, in storage order.
+ * @return The IDs of all users.
+ */
+std::vector<UserId> SocialNetwork::userIds() const {
+    std::vector<UserId> ids;
+    ids.reserve(num_of_users);
+    if (snapshot_backed) {
+        for (int index = 0; index < current_snapshot->numberOfUsers(); index++) {
+            ids.push_back(current_snapshot->userId(index));
+        }
+        return ids;
+    }
+    for (const UserRecord& user : users) {
+        // Skip free slots
+        if (user.in_use) {
+            ids.push_back(user.user_id);
         }
+    }
+    return ids;
+}
 
-        std::cout << "Number of connections: " << numConnections << std::endl;
 
-        std::cout << "Connected to: ";
-        currentConnection = currentNode->connections;
-        if (currentConnection == nullptr) {
-            std::cout << "None";
+/**
+ * @brief Get the connections of a user, in ascending ID order.
+ * @param user_id The ID of the user.
+ * @param connections Receives the IDs of the connected users.
+ * @return Ok, or UserNotFound.
+ */
+NetworkStatus SocialNetwork::connectionsOf(UserId user_id, std::vector<UserId>& connections) const {
+    connections.clear();
+    if (snapshot_backed) {
+        int index = current_snapshot->indexOf(user_id);
+        if (index == -1) {
+            return NetworkStatus::UserNotFound;
         }
-        else {
-            while (currentConnection != nullptr) {
-                std::cout << currentConnection->user_id;
-                if (currentConnection->next != nullptr) {
-                    std::cout << ", ";
-                }
-                currentConnection = currentConnection->next;
-            }
-
+        for (const int* neighbor = current_snapshot->neighborsBegin(index); neighbor != current_snapshot->neighborsEnd(index); ++neighbor) {
+            connections.push_back(current_snapshot->userId(*neighbor));
         }
-
-        std::cout << std::endl;
-        // Move to the next user
-        currentNode = currentNode->next;
+        return NetworkStatus::Ok;
+    }
+    const UserRecord* user = findUser(user_id);
+    if (user == nullptr) {
+        return NetworkStatus::UserNotFound;
     }
+    connections.reserve(user->connections.size());
+    user->connections.forEach([&](int slot) {
+        connections.push_back(users[slot].user_id);
+    });
+    // Slots are in insertion order of the users, not in ID order
+    std::sort(connections.begin(), connections.end());
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Find a user in the network.
+ * @param user_id The ID of the user to find.
+ * @return A pointer to the user if found, nullptr otherwise.
+ */
+SocialNetwork::UserRecord* SocialNetwork::findUser(UserId userId) {
+    int slot = user_index.find(userId);
+    return slot == -1 ? nullptr : &users[slot];
 }
+
+
+/**
+ * @brief Find a user in the network.
+ * @param user_id The ID of the user to find.
+ * @return A pointer to the user if found, nullptr otherwise.
+ */
+const SocialNetwork::UserRecord* SocialNetwork::findUser(UserId userId) const {
+    int slot = user_index.find(userId);
+    return slot == -1 ? nullptr : &users[slot];
+}
+
+
 /**
  * @brief Check if the network is empty.
  * @return True if the network is empty, false otherwise.
  */
 bool SocialNetwork::isEmpty() const {
-    return adjacency_list == nullptr;
+    return num_of_users == 0;
 }
 
 
@@ -532,21 +1033,42 @@ int SocialNetwork::numberOfUsers() const {
  * @return The number of connections in the network.
  */
 int SocialNetwork::numberOfConnections() const {
-    int totalConnections = 0;
-    UserNodePtr currentNode = adjacency_list;
+    if (snapshot_backed) {
+        return static_cast<int>(current_snapshot->numberOfConnections());
+    }
+    return static_cast<int>(network_statistics.numberOfConnections());
+}
+
 
-    while (currentNode != nullptr) {
-        UserNodePtr currentConnection = currentNode->connections;
-        while (currentConnection != nullptr) {
-            // count each connection
-            totalConnections++;
-            currentConnection = currentConnection->next;
+/**
+ * @brief Get the number of connections of a user.
+ * @param user_id The ID of the user.
+ * @return The number of connections of the user, or -1 if the user does not exist.
+ */
+int SocialNetwork::numberOfConnections(UserId user_id) const {
+    if (snapshot_backed) {
+        int index = current_snapshot->indexOf(user_id);
+        return index == -1 ? -1 : current_snapshot->degree(index);
+    }
+    const UserRecord* user = findUser(user_id);
+    return user == nullptr ? -1 : user->connections.size();
+}
+
+
+/**
+ * @brief Get the degree statistics of the network.
+ * @return The number of users and connections, maximum and average degree, and the degree histogram.
+ */
+const NetworkStatistics& SocialNetwork::statistics() {
+    // A loaded snapshot only pays for its statistics when they are asked for
+    if (statistics_stale) {
+        network_statistics.clear();
+        for (int index = 0; index < current_snapshot->numberOfUsers(); index++) {
+            network_statistics.addUser(current_snapshot->degree(index));
         }
-        // Move to the next user
-        currentNode = currentNode->next;
+        statistics_stale = false;
     }
-    // Each connection is counted twice (in an undirected graph), so divide by 2
-    return (totalConnections / 2);
+    return network_statistics;
 }
 
 
@@ -556,10 +1078,9 @@ int SocialNetwork::numberOfConnections() const {
  * @param user_id2 The ID of the second user.
  * @return True if the two users are connected, false otherwise.
  */
-bool SocialNetwork::isConnected(int user_id1, int user_id2) const {
+bool SocialNetwork::isConnected(UserId user_id1, UserId user_id2) const {
     // Check if the network is empty
     if (isEmpty()) {
-        std::cout << "Network is empty." << std::endl;
         return false;
     }
     // A user is always connected to itself
@@ -567,27 +1088,28 @@ bool SocialNetwork::isConnected(int user_id1, int user_id2) const {
         return true;
     }
 
+    // A loaded snapshot answers with a binary search in the sorted row
+    if (snapshot_backed) {
+        int index1 = current_snapshot->indexOf(user_id1);
+        int index2 = current_snapshot->indexOf(user_id2);
+        return index1 != -1 && index2 != -1
+            && std::binary_search(current_snapshot->neighborsBegin(index1), current_snapshot->neighborsEnd(index1), index2);
+    }
+
     // Find the user nodes
-    UserNodePtr user1 = findUser(user_id1);
-    UserNodePtr user2 = findUser(user_id2);
+    const UserRecord* user1 = findUser(user_id1);
+    const UserRecord* user2 = findUser(user_id2);
 
     // find if at least one user is not in the network
     if (user1 == nullptr || user2 == nullptr) {
-        std::cout << "One of the users does not exist." << std::endl;
         return false;
     }
 
-    //if user nodes exist, traverse connections of user1 to find user2
-    UserNodePtr currentUser = user1->connections;
-    while (currentUser != nullptr) {
-        if (currentUser->user_id == user_id2) {
-            // connection found
-            return true;
-        }
-        currentUser = currentUser->next;
+    // Look the slot of the user with fewer connections up in the set of the other, which for hubs is a bitmap
+    if (user2->connections.size() < user1->connections.size()) {
+        std::swap(user1, user2);
     }
-    // connection not found
-    return false;
+    return user2->connections.contains(static_cast<int>(user1 - users.data()));
 }
 
 
@@ -595,32 +1117,397 @@ bool SocialNetwork::isConnected(int user_id1, int user_id2) const {
  * @brief clear the network of all users and connections.
  */
 void SocialNetwork::clearNetwork() {
-    // Check if network is empty
-    if (isEmpty()) {
+    // Drop a loaded snapshot file
+    if (snapshot_backed) {
+        snapshot_backed = false;
+        statistics_stale = false;
+        current_snapshot.reset();
+    }
+    // Reset the user table, the index and the number of users, which may hold removed users even when empty
+    const bool was_empty = isEmpty();
+    std::vector<UserRecord>().swap(users);
+    std::vector<int>().swap(free_slots);
+    user_index.clear();
+    components.clear();
+    network_statistics.clear();
+    num_of_users = 0;
+    if (was_empty) {
         return;
     }
-    // Iterate through the adjacency list and delete each user node
-    UserNodePtr currentNode = adjacency_list;
+    snapshot_stale = true;
+    journalChange(JournalOperation::Clear, 0);
+};
+
+
+/**
+ * @brief Get an immutable CSR snapshot of the current network, rebuilding it if the network changed.
+ * @return The snapshot of the current network.
+ */
+std::shared_ptr<const NetworkSnapshot> SocialNetwork::snapshot() {
+    if (snapshot_stale || !current_snapshot) {
+        refreshSnapshot();
+    }
+    return current_snapshot;
+}
 
-    while (currentNode != nullptr) {
-        // Store Next Node before deleting the current node
-        UserNodePtr nextNode = currentNode->next;
 
-        // Delete connection of the current user
-        UserNodePtr currentConnection = currentNode->connections;
-        while (currentConnection != nullptr) {
-            // Store Next Connection before deleting the current connection
-            UserNodePtr nextConnection = currentConnection->next;
-            delete currentConnection;
-            currentConnection = nextConnection;
+/**
+ * @brief Rebuild the snapshot from the current network.
+ */
+void SocialNetwork::refreshSnapshot() {
+    // A loaded snapshot is the current network
+    if (snapshot_backed) {
+        return;
+    }
+
+    // Dense indices follow the ascending order of the user IDs
+    std::vector<int> order;
+    order.reserve(num_of_users);
+    for (int slot = 0; slot < static_cast<int>(users.size()); slot++) {
+        if (users[slot].in_use) {
+            order.push_back(slot);
         }
-        // Delete the current user node
-        delete currentNode;
-        // Move to the next user node
-        currentNode = nextNode;
     }
-    // Reset the adjacency list and number of users
-    adjacency_list = nullptr;
-    num_of_users = 0;
-    std::cout << "Network cleared." << std::endl;
-};
\ No newline at end of file
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return users[a].user_id < users[b].user_id;
+    });
+
+    std::vector<int> slot_to_index(users.size(), -1);
+    std::vector<UserId> user_ids(order.size());
+    for (int index = 0; index < static_cast<int>(order.size()); index++) {
+        slot_to_index[order[index]] = index;
+        user_ids[index] = users[order[index]].user_id;
+    }
+
+    // Copy each connection set into its row and sort the row
+    std::vector<std::int64_t> offsets(order.size() + 1, 0);
+    std::vector<int> neighbors;
+    for (int index = 0; index < static_cast<int>(order.size()); index++) {
+        std::size_t rowStart = neighbors.size();
+        users[order[index]].connections.forEach([&](int slot) {
+            neighbors.push_back(slot_to_index[slot]);
+        });
+        std::sort(neighbors.begin() + rowStart, neighbors.end());
+        offsets[index + 1] = static_cast<std::int64_t>(neighbors.size());
+    }
+
+    current_snapshot = std::make_shared<const NetworkSnapshot>(std::move(user_ids), std::move(offsets), std::move(neighbors));
+    snapshot_stale = false;
+}
+
+
+/**
+ * @brief Save the current network to a snapshot file.
+ * @param path The path of the file.
+ * @return Ok, or FileError.
+ */
+NetworkStatus SocialNetwork::saveSnapshot(const std::string& path) {
+    return snapshot()->save(path) ? NetworkStatus::Ok : NetworkStatus::FileError;
+}
+
+
+/**
+ * @brief Replace the network with the contents of a snapshot file, mapped in place.
+ * @param path The path of the file.
+ * @param verify_checksum If true, the whole file is read to check its payload checksum.
+ * @return Ok, or FileError.
+ */
+NetworkStatus SocialNetwork::loadSnapshot(const std::string& path, bool verify_checksum) {
+    std::shared_ptr<const NetworkSnapshot> loaded = NetworkSnapshot::open(path, verify_checksum);
+    if (!loaded) {
+        return NetworkStatus::FileError;
+    }
+
+    clearNetwork();
+    current_snapshot = loaded;
+    snapshot_stale = false;
+    snapshot_backed = true;
+    statistics_stale = true;
+    num_of_users = loaded->numberOfUsers();
+
+    // The journal restarts from the loaded network
+    if (journal.isOpen() && !replaying) {
+        if (path == journal_snapshot_path) {
+            return journal.reset() ? NetworkStatus::Ok : NetworkStatus::FileError;
+        }
+        return compactJournal();
+    }
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Restore the network from a snapshot file and a journal, and record every later change in the journal.
+ * @param journal_path The path of the journal file, created if missing.
+ * @param snapshot_path The path of the snapshot file the journal is compacted into.
+ * @param options When the journal writes, flushes and compacts.
+ * @return Ok, or FileError if the snapshot exists but is invalid, or the journal cannot be opened.
+ */
+NetworkStatus SocialNetwork::openJournal(const std::string& journal_path, const std::string& snapshot_path,
+                                         const JournalOptions& options) {
+    closeJournal();
+
+    // Check the snapshot before anything is changed, a missing one means the journal starts from nothing
+    bool has_snapshot = static_cast<bool>(std::ifstream(snapshot_path, std::ios::binary));
+    if (has_snapshot && !NetworkSnapshot::open(snapshot_path)) {
+        return NetworkStatus::FileError;
+    }
+    std::vector<JournalRecord> records;
+    if (!journal.open(journal_path, options, threadPool(), records)) {
+        return NetworkStatus::FileError;
+    }
+
+    replaying = true;
+    if (has_snapshot) {
+        loadSnapshot(snapshot_path);
+    }
+    else {
+        clearNetwork();
+    }
+    replayJournal(records);
+    replaying = false;
+    journal_snapshot_path = snapshot_path;
+    return NetworkStatus::Ok;
+}
+
+
+/**
+ * @brief Make every change recorded so far durable.
+ * @return Ok, or FileError if no journal is open or it could not be written.
+ */
+NetworkStatus SocialNetwork::syncJournal() {
+    return journal.isOpen() && journal.sync() ? NetworkStatus::Ok : NetworkStatus::FileError;
+}
+
+
+/**
+ * @brief Save the network to the journal's snapshot file and empty the journal.
+ * @return Ok, or FileError if no journal is open or a file could not be written.
+ */
+NetworkStatus SocialNetwork::compactJournal() {
+    if (!journal.isOpen()) {
+        return NetworkStatus::FileError;
+    }
+    // The snapshot must be on disk before the records it replaces are dropped, save() flushes it
+    if (saveSnapshot(journal_snapshot_path) != NetworkStatus::Ok) {
+        return NetworkStatus::FileError;
+    }
+    return journal.reset() ? NetworkStatus::Ok : NetworkStatus::FileError;
+}
+
+
+/**
+ * @brief Flush and close the journal. Later changes are not recorded.
+ */
+void SocialNetwork::closeJournal() {
+    journal.close();
+    journal_snapshot_path.clear();
+}
+
+
+/**
+ * @brief Publish the current network to the readers of snapshotPublisher().
+ * Writer thread only.
+ */
+void SocialNetwork::publish() {
+    publisher.publish(snapshot());
+}
+
+
+/**
+ * @brief Get the publisher that hands published versions of the network to concurrent readers.
+ * @return The publisher of the network.
+ */
+SnapshotPublisher& SocialNetwork::snapshotPublisher() {
+    return publisher;
+}
+
+
+/**
+ * @brief Set the number of threads used by parallel operations.
+ * @param num_threads The number of threads, 0 for the number of hardware threads.
+ */
+void SocialNetwork::setNumberOfThreads(unsigned num_threads) {
+    this->num_threads = num_threads;
+    // The pool is restarted with the new size on next use
+    thread_pool.reset();
+}
+
+
+/**
+ * @brief Relabel the components that lost connections or users since the last component query.
+ */
+void SocialNetwork::flushComponents() {
+    components.flush([this](int slot, const auto& visit) {
+        users[slot].connections.forEach(visit);
+    });
+}
+
+
+/**
+ * @brief Take a slot for a new user, reusing the slot of a removed user if there is one.
+ * @param user_id The ID of the new user.
+ * @return The slot of the new user.
+ */
+int SocialNetwork::allocateSlot(UserId user_id) {
+    int slot;
+    if (!free_slots.empty()) {
+        // The components may still route through a freed slot until they are relabeled
+        flushComponents();
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    else {
+        slot = static_cast<int>(users.size());
+        users.push_back(UserRecord());
+    }
+    users[slot].user_id = user_id;
+    users[slot].connections.clear();
+    users[slot].in_use = true;
+    user_index.insert(user_id, slot);
+    components.addSlot(slot);
+    network_statistics.addUser();
+    return slot;
+}
+
+
+/**
+ * @brief Adopt a finished background rebuild of the distance oracle, and start one if the oracle is stale.
+ * @param graph The snapshot of the current network.
+ */
+void SocialNetwork::refreshDistanceOracle(const std::shared_ptr<const NetworkSnapshot>& graph) {
+    if (oracle_rebuild.valid() && oracle_rebuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        distance_oracle = oracle_rebuild.get();
+    }
+
+    // The rebuild only holds the snapshots, so it never touches the network while it changes
+    if (distance_oracle && distance_oracle->snapshot() != graph && !oracle_rebuild.valid()) {
+        std::shared_ptr<const DistanceOracle> stale = distance_oracle;
+        oracle_rebuild = std::async(std::launch::async, [stale, graph]() {
+            return stale->rebuild(graph, nullptr);
+        });
+    }
+}
+
+
+/**
+ * @brief Append a change to the journal if one is open, and compact it once it is large enough.
+ * @param operation The change.
+ * @param user_id1 The user, or the first user of a connection.
+ * @param user_id2 The second user of a connection, 0 otherwise.
+ */
+void SocialNetwork::journalChange(JournalOperation operation, UserId user_id1, UserId user_id2) {
+    if (!journal.isOpen() || replaying) {
+        return;
+    }
+    journal.append(operation, user_id1, user_id2);
+    if (journal.needsCompaction()) {
+        compactJournal();
+    }
+}
+
+
+/**
+ * @brief Apply the records of a journal to the network.
+ * @param records The records, in order.
+ */
+void SocialNetwork::replayJournal(const std::vector<JournalRecord>& records) {
+    // Below this many connections a run is cheaper to add one by one than to merge into all connection lists
+    const std::size_t kBulkConnections = 4096;
+    std::vector<std::pair<UserId, UserId>> connections;
+
+    std::size_t position = 0;
+    while (position < records.size()) {
+        // Additions commute, so the connections of a run of additions can be loaded in one parallel pass
+        std::size_t end = position;
+        connections.clear();
+        while (end < records.size() && (records[end].operation == JournalOperation::AddUser
+                                        || records[end].operation == JournalOperation::AddConnection
+                                        || records[end].operation == JournalOperation::LoadConnection)) {
+            if (records[end].operation == JournalOperation::AddUser) {
+                addUser(records[end].user_id1);
+            }
+            else {
+                connections.emplace_back(records[end].user_id1, records[end].user_id2);
+            }
+            end++;
+        }
+        if (connections.size() >= kBulkConnections
+            && static_cast<long long>(connections.size()) * 4 >= numberOfConnections()) {
+            loadConnections(connections);
+        }
+        else {
+            for (std::size_t record = position; record < end; record++) {
+                if (records[record].operation == JournalOperation::LoadConnection) {
+                    addUser(records[record].user_id1);
+                    addUser(records[record].user_id2);
+                }
+                if (records[record].operation != JournalOperation::AddUser) {
+                    addConnection(records[record].user_id1, records[record].user_id2);
+                }
+            }
+        }
+        if (end < records.size() && end == position) {
+            // Removals and clears are applied one at a time
+            const JournalRecord& record = records[end++];
+            if (record.operation == JournalOperation::RemoveUser) {
+                removeUser(record.user_id1);
+            }
+            else if (record.operation == JournalOperation::RemoveConnection) {
+                removeConnection(record.user_id1, record.user_id2);
+            }
+            else {
+                clearNetwork();
+            }
+        }
+        position = end;
+    }
+}
+
+
+/**
+ * @brief Build the user table, the index and the connection lists from a loaded snapshot.
+ */
+void SocialNetwork::materialize() {
+    if (!snapshot_backed) {
+        return;
+    }
+    const NetworkSnapshot& graph = *current_snapshot;
+
+    // Slots follow the dense indices of the snapshot
+    users.resize(graph.numberOfUsers());
+    user_index.reserve(graph.numberOfUsers());
+    for (int index = 0; index < graph.numberOfUsers(); index++) {
+        components.addSlot(index);
+    }
+    for (int index = 0; index < graph.numberOfUsers(); index++) {
+        users[index].user_id = graph.userId(index);
+        users[index].in_use = true;
+        user_index.insert(graph.userId(index), index);
+
+        // The sorted rows are the connection sets, since slots are the dense indices
+        users[index].connections.assign(graph.neighborsBegin(index), graph.degree(index));
+        for (const int* neighbor = graph.neighborsBegin(index); neighbor != graph.neighborsEnd(index); ++neighbor) {
+            if (index < *neighbor) {
+                components.addConnection(index, *neighbor);
+            }
+        }
+    }
+
+    statistics();
+
+    // The snapshot still describes the network, it is replaced on the first change
+    snapshot_backed = false;
+}
+
+
+/**
+ * @brief Get the thread pool, starting it if needed.
+ * @return The thread pool.
+ */
+ThreadPool& SocialNetwork::threadPool() {
+    if (!thread_pool) {
+        thread_pool.reset(new ThreadPool(num_threads));
+    }
+    return *thread_pool;
+}
@@ -1,8 +1,33 @@
 #ifndef SOCIALNETWORK_H
 #define SOCIALNETWORK_H
 
-#include <iostream>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
+#include "AdjacencySet.h"
+#include "BatchMutualConnections.h"
+#include "BatchShortestPaths.h"
+#include "Betweenness.h"
+#include "BidirectionalSearch.h"
+#include "BreadthFirstSearch.h"
+#include "ConnectedComponents.h"
+#include "ConnectionRecommender.h"
+#include "DistanceOracle.h"
+#include "MutationJournal.h"
+#include "NeighborhoodFunction.h"
+#include "NetworkSnapshot.h"
+#include "NetworkStatistics.h"
+#include "NetworkStatus.h"
+#include "PageRank.h"
+#include "SnapshotPublisher.h"
+#include "ThreadPool.h"
+#include "TriangleCount.h"
+#include "UserId.h"
+#include "UserIndex.h"
 
 
 /**
@@ -10,7 +35,8 @@
  * @brief A class to represent a social network.
  *
  * This class provides the necessary functions to manage a social network, including user and connection management,
- * graph traversal and pathfinding, utility functions, and network insights.
+ * graph traversal and pathfinding, utility functions, and network insights. No operation writes to a stream; results
+ * are returned through status codes, output vectors and visitor callbacks (see NetworkPrinter for console output).
  */
 class SocialNetwork {
 public:
@@ -27,53 +53,322 @@ public:
     /**
      * @brief Add a user to the social network.
      * @param user_id The ID of the user to be added.
+     * @return Ok, or UserExists.
      */
-    void addUser(int user_id);
+    NetworkStatus addUser(UserId user_id);
 
     /**
      * @brief Remove a user from the social network.
      * @param user_id The ID of the user to be removed.
+     * @return Ok, EmptyNetwork or UserNotFound.
      */
-    void removeUser(int user_id);
+    NetworkStatus removeUser(UserId user_id);
 
     /**
      * @brief Add a connection between two users.
      * @param user_id1 The ID of the first user.
      * @param user_id2 The ID of the second user.
+     * @return Ok, SelfConnection, UserNotFound or ConnectionExists.
      */
-    void addConnection(int user_id1, int user_id2);
+    NetworkStatus addConnection(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Add many connections at once.
+     *
+     * Users that are not in the network yet are added. Self-connections, duplicates and connections that
+     * already exist are skipped, and the connection sets of the whole network are rebuilt in one pass.
+     * @param connections Pairs of user IDs to connect.
+     * @return The number of connections added.
+     */
+    long long loadConnections(const std::vector<std::pair<UserId, UserId>>& connections);
+
+    /**
+     * @brief Add the connections of a text edge list file.
+     *
+     * Every line holds two user IDs separated by whitespace; anything after them is ignored, and lines starting
+     * with '#' or '%' are comments.
+     * @param path The path of the file.
+     * @return The number of connections added, or -1 if the file could not be read.
+     */
+    long long loadEdgeListFile(const std::string& path);
+
+    /**
+     * @brief Add the connections of a binary edge list file.
+     *
+     * The file is a flat array of pairs of 64-bit user IDs in the byte order of the machine.
+     * @param path The path of the file.
+     * @return The number of connections added, or -1 if the file could not be read.
+     */
+    long long loadBinaryEdgeFile(const std::string& path);
 
     /**
      * @brief Remove a connection between two users.
      * @param user_id1 The ID of the first user.
      * @param user_id2 The ID of the second user.
+     * @return Ok, EmptyNetwork, UserNotFound, SelfConnection or ConnectionNotFound.
      */
-    void removeConnection(int user_id1, int user_id2);
+    NetworkStatus removeConnection(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Find the length of the shortest path between two users.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return The length of the shortest path, or -1 if a user does not exist or there is no path.
+     */
+    int findShortestPath(UserId user_id1, UserId user_id2);
 
     /**
      * @brief Find the shortest path between two users.
      * @param user_id1 The ID of the first user.
      * @param user_id2 The ID of the second user.
-     * @return The shortest path between the two users.
+     * @param path Receives the IDs of the users on the path, from user_id1 to user_id2.
+     * @return Ok, UserNotFound or NoPath.
+     */
+    NetworkStatus findShortestPath(UserId user_id1, UserId user_id2, std::vector<UserId>& path);
+
+    /**
+     * @brief Find the shortest paths of a batch of user pairs in parallel.
+     *
+     * Queries with the same first user share one search.
+     * @param queries Pairs of (first user ID, second user ID).
+     * @param include_paths If false, only the path lengths are computed.
+     * @return One result per query, in query order, with the paths given as user IDs.
+     */
+    std::vector<PathResult> findShortestPaths(const std::vector<std::pair<UserId, UserId>>& queries, bool include_paths = true);
+
+    /**
+     * @brief Build a landmark distance oracle for estimateDistance().
+     *
+     * The landmark searches run in parallel. Afterwards, whenever estimateDistance() finds that the network
+     * changed since the oracle was built, the oracle is rebuilt with the same settings on a background thread,
+     * and estimates are searched for exactly until the new one is ready.
+     * @param landmarks The number of landmarks.
+     * @param selection How the landmarks are chosen.
+     * @param seed The seed of a random selection.
+     */
+    void buildDistanceOracle(int landmarks = 16, LandmarkSelection selection = LandmarkSelection::HighestDegree,
+                             std::uint64_t seed = 0);
+
+    /**
+     * @brief Drop the distance oracle, waiting for a background rebuild to finish.
+     */
+    void dropDistanceOracle();
+
+    /**
+     * @brief Estimate the distance between two users.
+     *
+     * The oracle's bounds are returned when they are at most max_gap apart. Otherwise, or without an oracle,
+     * the distance is found with a bidirectional search and the estimate is exact. While the oracle describes an
+     * older version of the network, its bounds may be wrong, so the distance is searched for until the background
+     * rebuild completes.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @param estimate Receives the bounds on the distance.
+     * @param max_gap The largest accepted difference between the upper and lower bound.
+     * @return Ok, UserNotFound or NoPath.
      */
-    int findShortestPath(int user_id1, int user_id2);
+    NetworkStatus estimateDistance(UserId user_id1, UserId user_id2, DistanceEstimate& estimate, int max_gap = 0);
+
+    /**
+     * @brief Find the connections two users have in common.
+     *
+     * The sorted neighbor rows of the snapshot are intersected with a block-wise SIMD merge, or by galloping
+     * through the longer row when one user has far more connections than the other. If the network changed since the
+     * last snapshot, the connection sets of the two users are intersected instead of rebuilding it.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @param mutual Receives the IDs of the mutual connections in ascending order.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus mutualConnections(UserId user_id1, UserId user_id2, std::vector<UserId>& mutual);
+
+    /**
+     * @brief Count the mutual connections of a batch of user pairs in parallel.
+     *
+     * Pairs that share a hub user probe a bitmap of the hub's connections instead of intersecting rows.
+     * @param queries Pairs of (first user ID, second user ID).
+     * @return The number of mutual connections of every pair, in query order, -1 if a user does not exist.
+     */
+    std::vector<int> mutualConnectionCounts(const std::vector<std::pair<UserId, UserId>>& queries);
+
+    /**
+     * @brief Recommend the users a user is not connected to that share the most connections with them.
+     *
+     * Only users two hops away are candidates. With a fan-out cap, connections with more than max_fanout
+     * connections of their own are not walked through, so hubs do not dominate the cost and the mutual counts
+     * leave them out.
+     * @param user_id The ID of the user.
+     * @param k The maximum number of recommendations.
+     * @param recommendations Receives the recommended user IDs with their mutual counts and scores, best first.
+     * @param score How candidates are scored.
+     * @param max_fanout The fan-out cap, 0 for no limit.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus recommendConnections(UserId user_id, int k, std::vector<Recommendation>& recommendations,
+                                       RecommendationScore score = RecommendationScore::CommonNeighbors,
+                                       int max_fanout = 0);
+
+    /**
+     * @brief Recommend connections for many users in parallel.
+     * @param user_ids The IDs of the users.
+     * @param k The maximum number of recommendations per user.
+     * @param score How candidates are scored.
+     * @param max_fanout The fan-out cap, 0 for no limit.
+     * @return The recommendations of every user, in query order, as user IDs. A user that does not exist gets none.
+     */
+    std::vector<std::vector<Recommendation>> recommendConnections(const std::vector<UserId>& user_ids, int k,
+                                                                  RecommendationScore score = RecommendationScore::CommonNeighbors,
+                                                                  int max_fanout = 0);
+
+    /**
+     * @brief Count the triangles of the network and its clustering coefficients in parallel.
+     * @return The number of triangles and the local clustering coefficient of every user, indexed by the dense
+     *         indices of snapshot(), and the total number of triangles, average clustering and transitivity.
+     */
+    TriangleStatistics countTriangles();
+
+    /**
+     * @brief Rank the users by influence with PageRank, in parallel.
+     *
+     * With options.warm_start, the iterations start from the scores of the previous pageRank() call with the same
+     * seeds, carried over to the current network by user ID. After a batch of addConnection() and
+     * removeConnection() calls, a refresh then only runs the iterations needed to absorb the changes.
+     * @param options The damping, tolerance, iteration limit and warm start.
+     * @return The scores, indexed by the dense indices of snapshot().
+     */
+    PageRankResult pageRank(const PageRankOptions& options = PageRankOptions());
+
+    /**
+     * @brief Rank the users by their influence on a seed set with personalized PageRank, in parallel.
+     *
+     * Random jumps only land on the seeds, so the scores measure how close every user is to them.
+     * @param seed_ids The IDs of the seed users, or empty to jump to every user as pageRank() does.
+     * @param result Receives the scores, indexed by the dense indices of snapshot().
+     * @param options The damping, tolerance, iteration limit and warm start.
+     * @return Ok, or UserNotFound if a seed does not exist.
+     */
+    NetworkStatus pageRank(const std::vector<UserId>& seed_ids, PageRankResult& result,
+                           const PageRankOptions& options = PageRankOptions());
+
+    /**
+     * @brief Measure the betweenness centrality of every user, in parallel.
+     *
+     * Users with a high centrality lie on many of the shortest paths between other users, like the users that
+     * bridge two communities. With options.epsilon at 0 the centrality is exact, which costs one breadth-first
+     * search from every user. A positive epsilon estimates it from sampled shortest paths instead, and the number
+     * of samples depends on epsilon and on the longest shortest path, not on the size of the network.
+     * @param options The error bound, its probability and the seed of the samples.
+     * @return The centrality, indexed by the dense indices of snapshot(), and its error bound.
+     */
+    BetweennessResult betweenness(const BetweennessOptions& options = BetweennessOptions());
+
+    /**
+     * @brief Estimate how many users are within every number of hops of every user, in parallel.
+     *
+     * Every user keeps a HyperLogLog counter of the users it reaches, and each pass over the connections extends
+     * all counters by one hop, so the reach of all users costs about as much as a few breadth-first searches.
+     * The passes continue until no counter changes, which also gives the effective diameter of the network.
+     * @param options The counter size, the hops to keep and the seed.
+     * @return The estimated reach, indexed by the dense indices of snapshot(), the neighborhood function and the
+     *         effective diameter.
+     */
+    NeighborhoodResult neighborhoodFunction(const NeighborhoodOptions& options = NeighborhoodOptions());
+
+    /**
+     * @brief Perform a breadth-first search from a given user.
+     *
+     * Levels are exact and parents form a shortest-path tree, but the order lists users level by level in no
+     * particular order within a level. The order and visitor overloads visit neighbors in ascending ID order.
+     * @param user_id The ID of the user to start the search from.
+     * @return The levels, parents and visiting order, indexed by the dense indices of snapshot(). The result is
+     *         empty if the user does not exist.
+     */
+    BfsResult BFS(UserId user_id);
+
+    /**
+     * @brief Perform a breadth-first search from a given user.
+     * @param user_id The ID of the user to start the search from.
+     * @param order Receives the IDs of the reached users in visiting order.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus BFS(UserId user_id, std::vector<UserId>& order);
 
     /**
      * @brief Perform a breadth-first search from a given user.
      * @param user_id The ID of the user to start the search from.
+     * @param visitor Called with the ID and level of every reached user, in visiting order.
+     * @return Ok, or UserNotFound.
      */
-    void BFS(int user_id);
+    NetworkStatus BFS(UserId user_id, const std::function<void(UserId user_id, int level)>& visitor);
 
     /**
      * @brief Perform a depth-first search from a given user.
+     *
+     * Neighbors are explored in ascending order of their IDs.
      * @param user_id The ID of the user to start the search from.
+     * @param order Receives the IDs of the reached users in visiting order.
+     * @return Ok, or UserNotFound.
      */
-    void DFS(int user_id);
+    NetworkStatus DFS(UserId user_id, std::vector<UserId>& order);
 
     /**
-     * @brief Print the current state of the network.
+     * @brief Perform a depth-first search from a given user.
+     * @param user_id The ID of the user to start the search from.
+     * @param visitor Called with the ID of every reached user, in visiting order.
+     * @return Ok, or UserNotFound.
      */
-    void printNetwork() const;
+    NetworkStatus DFS(UserId user_id, const std::function<void(UserId user_id)>& visitor);
+
+    /**
+     * @brief Check if two users are in the same connected component.
+     *
+     * Components are maintained as the network changes, so this costs near-constant time unless connections or
+     * users were removed since the last component query; the components that lost them are then relabeled first.
+     * @param user_id1 The ID of the first user.
+     * @param user_id2 The ID of the second user.
+     * @return true if a path joins the two users, false otherwise (including when a user does not exist).
+     */
+    bool sameComponent(UserId user_id1, UserId user_id2);
+
+    /**
+     * @brief Get the number of users in the connected component of a user.
+     * @param user_id The ID of the user.
+     * @return The size of the user's component, including the user, or 0 if the user does not exist.
+     */
+    int componentSize(UserId user_id);
+
+    /**
+     * @brief Get the number of connected components.
+     * @return The number of components, counting users without connections.
+     */
+    int numberOfComponents();
+
+    /**
+     * @brief Get the sizes of all connected components.
+     * @return The size of every component, largest first.
+     */
+    std::vector<int> componentSizes();
+
+    /**
+     * @brief Check if a user is in the network.
+     * @param user_id The ID of the user.
+     * @return true if the user is in the network, false otherwise.
+     */
+    bool hasUser(UserId user_id) const;
+
+    /**
+     * @brief Get the IDs of all users, in storage order.
+     * @return The IDs of all users.
+     */
+    std::vector<UserId> userIds() const;
+
+    /**
+     * @brief Get the connections of a user, in ascending ID order.
+     * @param user_id The ID of the user.
+     * @param connections Receives the IDs of the connected users.
+     * @return Ok, or UserNotFound.
+     */
+    NetworkStatus connectionsOf(UserId user_id, std::vector<UserId>& connections) const;
 
     /**
      * @brief Check if the network is empty.
@@ -93,50 +388,227 @@ public:
      */
     int numberOfConnections() const;
 
+    /**
+     * @brief Get the number of connections of a user.
+     * @param user_id The ID of the user.
+     * @return The number of connections of the user, or -1 if the user does not exist.
+     */
+    int numberOfConnections(UserId user_id) const;
+
+    /**
+     * @brief Get the degree statistics of the network.
+     *
+     * The statistics are kept up to date by every change, so reading them never walks the network. After
+     * loadSnapshot() they are built once from the snapshot's offsets on first use.
+     * @return The number of users and connections, maximum and average degree, and the degree histogram.
+     */
+    const NetworkStatistics& statistics();
+
     /**
      * @brief Check if two users are connected.
      * @param user_id1 The ID of the first user.
      * @param user_id2 The ID of the second user.
-     * @return true if the two users are connected, false otherwise.
+     * @return true if the two users are connected or are the same user, false otherwise (including when a user
+     *         does not exist).
      */
-    bool isConnected(int user_id1, int user_id2) const;
+    bool isConnected(UserId user_id1, UserId user_id2) const;
 
     /**
      * @brief Clear the network of all users and connections.
      */
     void clearNetwork();
 
-private:
     /**
-     * @class UserNode
-     * @brief A class to represent a user in the social network.
+     * @brief Get an immutable CSR snapshot of the current network.
+     *
+     * The snapshot is rebuilt on demand if the network changed since it was last taken. Holders of the returned
+     * pointer keep their version alive and unchanged by later mutations.
+     * @return The snapshot of the current network.
+     */
+    std::shared_ptr<const NetworkSnapshot> snapshot();
+
+    /**
+     * @brief Rebuild the snapshot from the current network.
+     */
+    void refreshSnapshot();
+
+    /**
+     * @brief Save the current network to a snapshot file.
+     *
+     * The file can be mapped by loadSnapshot() or NetworkSnapshot::open() without deserializing it.
+     * @param path The path of the file.
+     * @return Ok, or FileError.
+     */
+    NetworkStatus saveSnapshot(const std::string& path);
+
+    /**
+     * @brief Replace the network with the contents of a snapshot file.
+     *
+     * The file is memory-mapped and queries read it in place, so processes loading the same file share its pages.
+     * Loading makes one pass over the arrays to check their structure, which is linear in the size of the network
+     * but copies and allocates nothing. The user table and connection sets are only built from the mapping when the
+     * network is first changed.
+     * @param path The path of the file.
+     * @param verify_checksum If true, the whole file is read to check its payload checksum.
+     * @return Ok, or FileError if the file is missing or not a valid snapshot. The network is unchanged on error.
+     */
+    NetworkStatus loadSnapshot(const std::string& path, bool verify_checksum = false);
+
+    /**
+     * @brief Restore the network from a snapshot file and a journal, and record every later change in the journal.
+     *
+     * The network is replaced by the snapshot at snapshot_path, or emptied if there is none, and the changes in
+     * the journal at journal_path are replayed on top of it. From then on every successful change is appended to
+     * the journal, and once the journal grows past options.compaction_bytes the network is saved to
+     * snapshot_path and the journal is emptied. Replaying a journal over a snapshot that already holds its
+     * changes leaves the same network, so a crash during a compaction loses nothing.
+     * @param journal_path The path of the journal file, created if missing.
+     * @param snapshot_path The path of the snapshot file the journal is compacted into.
+     * @param options When the journal writes, flushes and compacts.
+     * @return Ok, or FileError if the snapshot exists but is invalid, or the journal cannot be opened.
+     */
+    NetworkStatus openJournal(const std::string& journal_path, const std::string& snapshot_path,
+                              const JournalOptions& options = JournalOptions());
+
+    /**
+     * @brief Make every change recorded so far durable.
+     * @return Ok, or FileError if no journal is open or it could not be written.
+     */
+    NetworkStatus syncJournal();
+
+    /**
+     * @brief Save the network to the journal's snapshot file and empty the journal.
+     * @return Ok, or FileError if no journal is open or a file could not be written.
+     */
+    NetworkStatus compactJournal();
+
+    /**
+     * @brief Flush and close the journal. Later changes are not recorded.
+     */
+    void closeJournal();
+
+    /**
+     * @brief Publish the current network to the readers of snapshotPublisher().
      *
-     * This class holds the user's ID and pointers to the next user in the adjacency list and the user's connections.
+     * The network itself is not thread-safe: one writer thread changes it and calls publish() after each batch of
+     * changes, while any number of NetworkReader objects on other threads query the last published version without
+     * locks.
+     */
+    void publish();
+
+    /**
+     * @brief Get the publisher that hands published versions of the network to concurrent readers.
+     * @return The publisher of the network.
      */
-    struct UserNode {
-    public:
-        int user_id;  // The user's ID.
-        UserNode* next;  // Pointer to the next user in the adjacency list.
-        UserNode* connections;  // Pointer to the user's connections.
+    SnapshotPublisher& snapshotPublisher();
 
-        /**
-         * @brief Construct a new User Node object.
-         * @param id The ID of the user.
-         */
-        UserNode(int id) : user_id(id), next(nullptr), connections(nullptr) {}
+    /**
+     * @brief Set the number of threads used by parallel operations.
+     * @param num_threads The number of threads, 0 for the number of hardware threads.
+     */
+    void setNumberOfThreads(unsigned num_threads);
+
+private:
+    /**
+     * @struct UserRecord
+     * @brief A user stored in the contiguous user table.
+     *
+     * Slots of removed users are kept as free records and reused by later insertions, so the slot of a user
+     * never changes while the user is in the network. Connections are stored as the slots of the connected users,
+     * which are dense enough for the bitmaps of hub users.
+     */
+    struct UserRecord {
+        UserId user_id;  // The user's ID.
+        AdjacencySet connections;  // The slots of the user's connections.
+        bool in_use;  // false if the slot is free.
     };
 
-    typedef UserNode* UserNodePtr;  // Typedef for a pointer to a UserNode.
-    UserNodePtr adjacency_list;  // Pointer to the adjacency list of the network.
+    std::vector<UserRecord> users;  // Contiguous storage of the users, indexed by slot.
+    std::vector<int> free_slots;  // Slots of removed users available for reuse.
+    UserIndex user_index;  // Hash index from user ID to slot.
+    ConnectedComponents components;  // Connected components over the slots of the user table.
+    NetworkStatistics network_statistics;  // Degree statistics, updated by every change.
+    bool statistics_stale;  // true if network_statistics must be rebuilt from a loaded snapshot.
     int num_of_users;  // The number of users in the network.
+    std::shared_ptr<const NetworkSnapshot> current_snapshot;  // The last snapshot taken of the network.
+    bool snapshot_stale;  // true if the network changed since current_snapshot was taken.
+    bool snapshot_backed;  // true if the network is a loaded snapshot and the user table is not built yet.
+    SnapshotPublisher publisher;  // Publishes snapshots to concurrent readers.
+    BidirectionalSearch path_search;  // Reusable scratch state for findShortestPath.
+    std::vector<int> dense_scratch;  // Reusable dense indices of a path, or slots or dense indices of mutual connections.
+    BreadthFirstSearch bfs_engine;  // Reusable scratch state for BFS.
+    BatchShortestPaths batch_paths;  // Reusable per-thread scratch state for findShortestPaths.
+    BatchMutualConnections batch_mutual;  // Reusable per-thread scratch state for mutualConnectionCounts.
+    ConnectionRecommender recommender;  // Reusable per-thread scratch state for recommendConnections.
+    std::shared_ptr<const NetworkSnapshot> page_rank_graph;  // The snapshot the last pageRank() ranked.
+    std::vector<UserId> page_rank_seeds;  // The sorted IDs of the seeds of the last pageRank().
+    std::vector<double> page_rank_scores;  // The scores of the last pageRank(), the start of the next one.
+    std::unique_ptr<ThreadPool> thread_pool;  // Workers for parallel operations, started on first use.
+    std::shared_ptr<const DistanceOracle> distance_oracle;  // The landmark oracle, if one was built.
+    std::future<std::shared_ptr<const DistanceOracle>> oracle_rebuild;  // The background rebuild in progress.
+    unsigned num_threads;  // Requested number of workers, 0 for the number of hardware threads.
+    MutationJournal journal;  // Records the changes since the last compaction, if open.
+    std::string journal_snapshot_path;  // The snapshot file the journal is compacted into.
+    bool replaying;  // true while the journal is replayed, so the replayed changes are not recorded again.
 
     /**
      * @brief Find a user in the network.
      * @param user_id The ID of the user to find.
      * @return A pointer to the user if found, nullptr otherwise.
      */
+    UserRecord* findUser(UserId user_id);
 
-    UserNodePtr findUser(int user_id) const;
+    /**
+     * @brief Find a user in the network.
+     * @param user_id The ID of the user to find.
+     * @return A pointer to the user if found, nullptr otherwise.
+     */
+    const UserRecord* findUser(UserId user_id) const;
+
+    /**
+     * @brief Relabel the components that lost connections or users since the last component query.
+     */
+    void flushComponents();
+
+    /**
+     * @brief Take a slot for a new user, reusing the slot of a removed user if there is one.
+     * @param user_id The ID of the new user.
+     * @return The slot of the new user.
+     */
+    int allocateSlot(UserId user_id);
+
+    /**
+     * @brief Adopt a finished background rebuild of the distance oracle, and start one if the oracle is stale.
+     * @param graph The snapshot of the current network.
+     */
+    void refreshDistanceOracle(const std::shared_ptr<const NetworkSnapshot>& graph);
+
+    /**
+     * @brief Append a change to the journal if one is open, and compact it once it is large enough.
+     * @param operation The change.
+     * @param user_id1 The user, or the first user of a connection.
+     * @param user_id2 The second user of a connection, 0 otherwise.
+     */
+    void journalChange(JournalOperation operation, UserId user_id1, UserId user_id2 = 0);
+
+    /**
+     * @brief Apply the records of a journal to the network.
+     * @param records The records, in order.
+     */
+    void replayJournal(const std::vector<JournalRecord>& records);
+
+    /**
+     * @brief Build the user table, the index and the connection sets from a loaded snapshot.
+     *
+     * Called before every change to the network; does nothing unless the network is snapshot-backed.
+     */
+    void materialize();
+
+    /**
+     * @brief Get the thread pool, starting it if needed.
+     * @return The thread pool.
+     */
+    ThreadPool& threadPool();
 
 };
 
@@ -0,0 +1,120 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+/**
+ * @brief Construct a new ThreadPool object and start its threads.
+ * @param num_threads The total number of workers including the caller, 0 for the number of hardware threads.
+ */
+ThreadPool::ThreadPool(unsigned num_threads)
+    : job(nullptr), job_count(0), job_grain(1), next_index(0), busy_threads(0), generation(0), stopping(false) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // The caller is worker 0, so one thread fewer is started
+    for (unsigned worker = 1; worker < num_threads; worker++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+
+/**
+ * @brief Stop and join the worker threads.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+
+/**
+ * @brief Get the number of workers, including the calling thread.
+ * @return The number of workers.
+ */
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(threads.size()) + 1;
+}
+
+
+/**
+ * @brief Run a loop over [0, count) on all workers and wait for it to finish.
+ * @param count The number of loop indices.
+ * @param grain The number of indices handed to a worker at a time.
+ * @param body The loop body.
+ */
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, const LoopBody& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+
+    // Small loops are not worth waking the pool
+    if (threads.empty() || count <= grain) {
+        body(0, 0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(call_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        job_count = count;
+        job_grain = grain;
+        next_index.store(0);
+        busy_threads = static_cast<unsigned>(threads.size());
+        generation++;
+    }
+    job_ready.notify_all();
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this] { return busy_threads == 0; });
+    job = nullptr;
+}
+
+
+/**
+ * @brief Wait for jobs and run them until the pool stops.
+ * @param worker The worker number of the thread.
+ */
+void ThreadPool::workerLoop(unsigned worker) {
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        runChunks(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy_threads == 0) {
+            job_done.notify_one();
+        }
+    }
+}
+
+
+/**
+ * @brief Claim and run chunks of the current job until none are left.
+ * @param worker The worker number of the calling thread.
+ */
+void ThreadPool::runChunks(unsigned worker) {
+    for (;;) {
+        std::size_t begin = next_index.fetch_add(job_grain);
+        if (begin >= job_count) {
+            return;
+        }
+        (*job)(worker, begin, std::min(begin + job_grain, job_count));
+    }
+}
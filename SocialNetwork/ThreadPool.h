@@ -0,0 +1,119 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads that run parallel loops.
+ *
+ * The calling thread takes part in every loop as worker 0, and the pool threads are workers 1..size()-1, so
+ * worker numbers can index per-thread scratch state. Loop bodies must not throw or start another loop on the
+ * same pool; concurrent calls from different threads are run one after the other.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief The body of a parallel loop.
+     *
+     * Called with the worker number and a half-open range [begin, end) of loop indices.
+     */
+    typedef std::function<void(unsigned worker, std::size_t begin, std::size_t end)> LoopBody;
+
+    /**
+     * @brief Construct a new Thread Pool object.
+     * @param num_threads The total number of workers including the caller, 0 for the number of hardware threads.
+     */
+    explicit ThreadPool(unsigned num_threads = 0);
+
+    /**
+     * @brief Stop and join the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the number of workers, including the calling thread.
+     * @return The number of workers.
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Run a loop over [0, count) on all workers and wait for it to finish.
+     *
+     * Indices are handed out dynamically in chunks of grain indices.
+     * @param count The number of loop indices.
+     * @param grain The number of indices handed to a worker at a time.
+     * @param body The loop body.
+     */
+    void parallelFor(std::size_t count, std::size_t grain, const LoopBody& body);
+
+    /**
+     * @brief Run a loop over fixed chunks of [0, count) on all workers and wait for it to finish.
+     *
+     * Chunk c always covers [c * chunk_size, min((c + 1) * chunk_size, count)), whichever worker runs it, so a
+     * result summed per chunk and then over the chunks in order does not depend on the number of workers.
+     * @param count The number of loop indices.
+     * @param chunk_size The number of indices of a chunk.
+     * @param body Called as body(chunk, begin, end) for every chunk.
+     */
+    template <typename ChunkBody>
+    void parallelForChunks(std::size_t count, std::size_t chunk_size, ChunkBody body);
+
+private:
+    std::vector<std::thread> threads;  // The pool threads, workers 1..size()-1.
+    std::mutex call_mutex;  // Serializes parallelFor calls.
+    std::mutex mutex;  // Protects the job state below.
+    std::condition_variable job_ready;  // Signaled when a job is posted or the pool stops.
+    std::condition_variable job_done;  // Signaled when the last pool thread finishes a job.
+    const LoopBody* job;  // The loop being run.
+    std::size_t job_count;  // The number of indices of the loop.
+    std::size_t job_grain;  // The chunk size of the loop.
+    std::atomic<std::size_t> next_index;  // The next unclaimed loop index.
+    unsigned busy_threads;  // Pool threads that have not finished the current job.
+    unsigned long long generation;  // Incremented for every posted job.
+    bool stopping;  // true once the pool is being destroyed.
+
+    /**
+     * @brief Wait for jobs and run them until the pool stops.
+     * @param worker The worker number of the thread.
+     */
+    void workerLoop(unsigned worker);
+
+    /**
+     * @brief Claim and run chunks of the current job until none are left.
+     * @param worker The worker number of the calling thread.
+     */
+    void runChunks(unsigned worker);
+};
+
+
+
+/**
+ * @brief Run a loop over fixed chunks of [0, count) on all workers and wait for it to finish.
+ * @param count The number of loop indices.
+ * @param chunk_size The number of indices of a chunk.
+ * @param body Called as body(chunk, begin, end) for every chunk.
+ */
+template <typename ChunkBody>
+void ThreadPool::parallelForChunks(std::size_t count, std::size_t chunk_size, ChunkBody body) {
+    chunk_size = chunk_size > 0 ? chunk_size : 1;
+    // The pool hands out ranges of whole chunks, split them back into chunks
+    parallelFor(count, chunk_size, [&body, count, chunk_size](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunk_size) {
+            std::size_t chunkEnd = chunkBegin + chunk_size < count ? chunkBegin + chunk_size : count;
+            body(chunkBegin / chunk_size, chunkBegin, chunkEnd);
+        }
+    });
+}
+
+#endif // THREADPOOL_H
@@ -0,0 +1,107 @@
+#include "TriangleCount.h"
+#include <atomic>
+
+/**
+ * @brief Count the triangles of a snapshot in parallel.
+ * @param graph The snapshot to count.
+ * @param pool The thread pool to count on.
+ * @param statistics Receives the counts and coefficients.
+ */
+void countTriangles(const NetworkSnapshot& graph, ThreadPool& pool, TriangleStatistics& statistics) {
+    const int users = graph.numberOfUsers();
+
+    // u -> v if u ranks below v by (degree, index)
+    auto ranksBelow = [&graph](int u, int v) {
+        int degreeU = graph.degree(u);
+        int degreeV = graph.degree(v);
+        return degreeU < degreeV || (degreeU == degreeV && u < v);
+    };
+
+    // Build the oriented rows, which stay sorted by index
+    std::vector<std::int64_t> offsets(users + 1, 0);
+    pool.parallelFor(users, 1 << 10, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t user = begin; user < end; user++) {
+            int u = static_cast<int>(user);
+            for (const int* v = graph.neighborsBegin(u); v != graph.neighborsEnd(u); ++v) {
+                offsets[u + 1] += ranksBelow(u, *v);
+            }
+        }
+    });
+    for (int u = 0; u < users; u++) {
+        offsets[u + 1] += offsets[u];
+    }
+    std::vector<int> oriented(static_cast<std::size_t>(offsets[users]));
+    pool.parallelFor(users, 1 << 10, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t user = begin; user < end; user++) {
+            int u = static_cast<int>(user);
+            int* out = oriented.data() + offsets[u];
+            for (const int* v = graph.neighborsBegin(u); v != graph.neighborsEnd(u); ++v) {
+                if (ranksBelow(u, *v)) {
+                    *out++ = *v;
+                }
+            }
+        }
+    });
+
+    // Each triangle u -> v -> w, u -> w is found from the connection u -> v, by probing the marked row of u
+    std::vector<std::atomic<std::int64_t>> counts(users);
+    std::vector<std::vector<char>> marks(pool.size());
+    std::vector<std::int64_t> totals(pool.size(), 0);
+    pool.parallelFor(users, 64, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        std::vector<char>& marked = marks[worker];
+        if (marked.empty()) {
+            marked.assign(users, 0);
+        }
+        for (std::size_t user = begin; user < end; user++) {
+            int u = static_cast<int>(user);
+            const int* rowU = oriented.data() + offsets[u];
+            const int* rowEnd = oriented.data() + offsets[u + 1];
+            for (const int* v = rowU; v != rowEnd; ++v) {
+                marked[*v] = 1;
+            }
+
+            std::int64_t trianglesOfU = 0;
+            for (const int* v = rowU; v != rowEnd; ++v) {
+                std::int64_t trianglesOfUV = 0;
+                for (const int* w = oriented.data() + offsets[*v]; w != oriented.data() + offsets[*v + 1]; ++w) {
+                    if (marked[*w]) {
+                        trianglesOfUV++;
+                        counts[*w].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                if (trianglesOfUV > 0) {
+                    trianglesOfU += trianglesOfUV;
+                    counts[*v].fetch_add(trianglesOfUV, std::memory_order_relaxed);
+                }
+            }
+
+            for (const int* v = rowU; v != rowEnd; ++v) {
+                marked[*v] = 0;
+            }
+            if (trianglesOfU > 0) {
+                counts[u].fetch_add(trianglesOfU, std::memory_order_relaxed);
+                totals[worker] += trianglesOfU;
+            }
+        }
+    });
+
+    // Local coefficients and the global summaries
+    statistics.triangles.resize(users);
+    statistics.clustering.resize(users);
+    statistics.total = 0;
+    for (std::int64_t total : totals) {
+        statistics.total += total;
+    }
+    double clusteringSum = 0;
+    double triples = 0;
+    for (int u = 0; u < users; u++) {
+        std::int64_t triangles = counts[u].load(std::memory_order_relaxed);
+        double pairs = static_cast<double>(graph.degree(u)) * (graph.degree(u) - 1) / 2;
+        statistics.triangles[u] = triangles;
+        statistics.clustering[u] = pairs > 0 ? triangles / pairs : 0.0;
+        clusteringSum += statistics.clustering[u];
+        triples += pairs;
+    }
+    statistics.average_clustering = users > 0 ? clusteringSum / users : 0.0;
+    statistics.transitivity = triples > 0 ? 3.0 * statistics.total / triples : 0.0;
+}
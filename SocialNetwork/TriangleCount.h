@@ -0,0 +1,38 @@
+#ifndef TRIANGLECOUNT_H
+#define TRIANGLECOUNT_H
+
+#include <cstdint>
+#include <vector>
+#include "NetworkSnapshot.h"
+#include "ThreadPool.h"
+
+
+/**
+ * @struct TriangleStatistics
+ * @brief Triangle counts and clustering coefficients of a snapshot.
+ *
+ * Per-user arrays use the dense indices of the snapshot that was counted.
+ */
+struct TriangleStatistics {
+    std::vector<std::int64_t> triangles;  // Number of triangles each user is part of.
+    std::vector<double> clustering;  // Local clustering coefficient of each user, 0 with fewer than two connections.
+    std::int64_t total;  // Number of distinct triangles in the network.
+    double average_clustering;  // Mean of the local clustering coefficients over all users.
+    double transitivity;  // Global clustering coefficient: 3 * total / number of connected triples.
+};
+
+
+/**
+ * @brief Count the triangles of a snapshot in parallel.
+ *
+ * Every connection is oriented from the user with fewer connections to the one with more (ties broken by index),
+ * which leaves every user with at most O(sqrt(connections)) outgoing connections. Each triangle is then found
+ * exactly once from its lowest-ranked user u: the outgoing row of u is marked in a per-worker byte array, and the
+ * outgoing rows of u's targets are probed against the marks.
+ * @param graph The snapshot to count.
+ * @param pool The thread pool to count on.
+ * @param statistics Receives the counts and coefficients.
+ */
+void countTriangles(const NetworkSnapshot& graph, ThreadPool& pool, TriangleStatistics& statistics);
+
+#endif // TRIANGLECOUNT_H
@@ -0,0 +1,16 @@
+#ifndef USERID_H
+#define USERID_H
+
+#include <cstdint>
+
+
+/**
+ * @brief The external ID of a user.
+ *
+ * IDs are arbitrary, possibly sparse 64-bit values and are only used at the API edge. Inside the network users
+ * are addressed by dense slots of the user table or dense indices of a snapshot, so scratch arrays are sized by
+ * the number of users and never by the value of an ID.
+ */
+typedef std::int64_t UserId;
+
+#endif // USERID_H
@@ -0,0 +1,162 @@
+#include "UserIndex.h"
+#include <cstdint>
+
+namespace {
+    // Keep the table at most 70% full
+    const std::size_t kMaxLoadNumerator = 7;
+    const std::size_t kMaxLoadDenominator = 10;
+    const std::size_t kMinCapacity = 16;
+}
+
+/**
+ * @brief Default constructor for UserIndex class.
+ * The table is allocated lazily on the first insertion.
+ */
+UserIndex::UserIndex() : count(0) {}
+
+
+/**
+ * @brief Find the storage slot of a user.
+ * @param user_id The ID of the user to find.
+ * @return The slot of the user if found, -1 otherwise.
+ */
+int UserIndex::find(UserId user_id) const {
+    if (buckets.empty()) {
+        return -1;
+    }
+    const std::size_t mask = buckets.size() - 1;
+    std::size_t position = hash(user_id) & mask;
+
+    // Probe until the user or an empty bucket is found
+    while (buckets[position].slot != -1) {
+        if (buckets[position].user_id == user_id) {
+            return buckets[position].slot;
+        }
+        position = (position + 1) & mask;
+    }
+    return -1;
+}
+
+
+/**
+ * @brief Insert a user that is not yet in the index.
+ * @param user_id The ID of the user to insert.
+ * @param slot The storage slot of the user.
+ */
+void UserIndex::insert(UserId user_id, int slot) {
+    if ((count + 1) * kMaxLoadDenominator > buckets.size() * kMaxLoadNumerator) {
+        rehash(buckets.empty() ? kMinCapacity : buckets.size() * 2);
+    }
+    const std::size_t mask = buckets.size() - 1;
+    std::size_t position = hash(user_id) & mask;
+
+    while (buckets[position].slot != -1) {
+        position = (position + 1) & mask;
+    }
+    buckets[position].user_id = user_id;
+    buckets[position].slot = slot;
+    count++;
+}
+
+
+/**
+ * @brief Remove a user from the index.
+ * @param user_id The ID of the user to remove.
+ * @return true if the user was found and removed, false otherwise.
+ */
+bool UserIndex::erase(UserId user_id) {
+    if (buckets.empty()) {
+        return false;
+    }
+    const std::size_t mask = buckets.size() - 1;
+    std::size_t position = hash(user_id) & mask;
+
+    while (buckets[position].slot != -1 && buckets[position].user_id != user_id) {
+        position = (position + 1) & mask;
+    }
+    if (buckets[position].slot == -1) {
+        return false;
+    }
+
+    // Backward-shift the following entries of the probe run into the hole
+    std::size_t hole = position;
+    std::size_t next = (hole + 1) & mask;
+    while (buckets[next].slot != -1) {
+        std::size_t home = hash(buckets[next].user_id) & mask;
+        // Move the entry only if its home bucket is not between the hole and its current bucket
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            buckets[hole] = buckets[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    buckets[hole].slot = -1;
+    count--;
+    return true;
+}
+
+
+/**
+ * @brief Make room for at least the given number of users without rehashing.
+ * @param users The number of users to make room for.
+ */
+void UserIndex::reserve(std::size_t users) {
+    std::size_t capacity = buckets.empty() ? kMinCapacity : buckets.size();
+    while (users * kMaxLoadDenominator > capacity * kMaxLoadNumerator) {
+        capacity *= 2;
+    }
+    if (capacity != buckets.size()) {
+        rehash(capacity);
+    }
+}
+
+
+/**
+ * @brief Remove all users from the index and release the table.
+ */
+void UserIndex::clear() {
+    std::vector<Bucket>().swap(buckets);
+    count = 0;
+}
+
+
+/**
+ * @brief Get the number of users in the index.
+ * @return The number of users in the index.
+ */
+std::size_t UserIndex::size() const {
+    return count;
+}
+
+
+/**
+ * @brief Hash a user ID with the 64-bit finalizer from MurmurHash3.
+ * @param user_id The ID of the user to hash.
+ * @return The mixed hash value of the ID.
+ */
+std::size_t UserIndex::hash(UserId user_id) {
+    std::uint64_t h = static_cast<std::uint64_t>(user_id);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
+}
+
+
+/**
+ * @brief Rebuild the table with the given number of buckets.
+ * @param capacity The new number of buckets, must be a power of two.
+ */
+void UserIndex::rehash(std::size_t capacity) {
+    std::vector<Bucket> old_buckets(capacity, Bucket{ 0, -1 });
+    old_buckets.swap(buckets);
+    count = 0;
+
+    for (const Bucket& bucket : old_buckets) {
+        if (bucket.slot != -1) {
+            insert(bucket.user_id, bucket.slot);
+        }
+    }
+}
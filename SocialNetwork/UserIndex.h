@@ -0,0 +1,88 @@
+#ifndef USERINDEX_H
+#define USERINDEX_H
+
+#include <cstddef>
+#include <vector>
+#include "UserId.h"
+
+
+/**
+ * @class UserIndex
+ * @brief An open-addressing hash index from user IDs to user storage slots.
+ *
+ * The index uses linear probing over a power-of-two table and backward-shift deletion, so lookups,
+ * insertions and removals run in expected constant time without tombstones.
+ */
+class UserIndex {
+public:
+    /**
+     * @brief Construct an empty User Index object.
+     */
+    UserIndex();
+
+    /**
+     * @brief Find the storage slot of a user.
+     * @param user_id The ID of the user to find.
+     * @return The slot of the user if found, -1 otherwise.
+     */
+    int find(UserId user_id) const;
+
+    /**
+     * @brief Insert a user that is not yet in the index.
+     * @param user_id The ID of the user to insert.
+     * @param slot The storage slot of the user.
+     */
+    void insert(UserId user_id, int slot);
+
+    /**
+     * @brief Remove a user from the index.
+     * @param user_id The ID of the user to remove.
+     * @return true if the user was found and removed, false otherwise.
+     */
+    bool erase(UserId user_id);
+
+    /**
+     * @brief Make room for at least the given number of users without rehashing.
+     * @param users The number of users to make room for.
+     */
+    void reserve(std::size_t users);
+
+    /**
+     * @brief Remove all users from the index.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of users in the index.
+     * @return The number of users in the index.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Hash a user ID.
+     * @param user_id The ID of the user to hash.
+     * @return The mixed hash value of the ID.
+     */
+    static std::size_t hash(UserId user_id);
+
+private:
+    /**
+     * @struct Bucket
+     * @brief A single table entry. An empty bucket has a slot of -1.
+     */
+    struct Bucket {
+        UserId user_id;  // The user's ID.
+        int slot;  // The user's storage slot, or -1 if the bucket is empty.
+    };
+
+    std::vector<Bucket> buckets;  // The hash table, its size is always zero or a power of two.
+    std::size_t count;  // The number of occupied buckets.
+
+    /**
+     * @brief Rebuild the table with the given number of buckets.
+     * @param capacity The new number of buckets, must be a power of two.
+     */
+    void rehash(std::size_t capacity);
+};
+
+#endif // USERINDEX_H
@@ -0,0 +1,126 @@
+#include "GraphGenerators.h"
+#include <algorithm>
+
+/**
+ * @brief Generate an R-MAT graph with the Graph500 parameters (a = 0.57, b = c = 0.19).
+ * @param scale The graph has 2^scale users, numbered 0..2^scale-1.
+ * @param num_edges The number of edges to draw.
+ * @param seed The random seed.
+ * @return The edges as pairs of user IDs.
+ */
+std::vector<std::pair<int, int>> generateRmat(int scale, std::int64_t num_edges, std::uint64_t seed) {
+    const double a = 0.57;
+    const double b = 0.19;
+    const double c = 0.19;
+    const std::uint64_t mask = (std::uint64_t(1) << scale) - 1;
+    SplitMix64 random(seed);
+
+    // An odd multiplier permutes the IDs modulo 2^scale
+    const std::uint64_t scramble = (random.next() | 1) & mask;
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(static_cast<std::size_t>(num_edges));
+    for (std::int64_t edge = 0; edge < num_edges; edge++) {
+        std::uint64_t row = 0;
+        std::uint64_t column = 0;
+        for (int level = 0; level < scale; level++) {
+            double draw = random.uniform();
+            row <<= 1;
+            column <<= 1;
+            if (draw >= a + b + c) {
+                row |= 1;
+                column |= 1;
+            }
+            else if (draw >= a + b) {
+                row |= 1;
+            }
+            else if (draw >= a) {
+                column |= 1;
+            }
+        }
+        edges.push_back(std::make_pair(static_cast<int>((row * scramble) & mask),
+                                       static_cast<int>((column * scramble) & mask)));
+    }
+    return edges;
+}
+
+
+/**
+ * @brief Generate a Barabasi-Albert preferential attachment graph.
+ * @param num_users The number of users, numbered 0..num_users-1.
+ * @param edges_per_user The number of connections of every joining user.
+ * @param seed The random seed.
+ * @return The edges as pairs of user IDs.
+ */
+std::vector<std::pair<int, int>> generateBarabasiAlbert(int num_users, int edges_per_user, std::uint64_t seed) {
+    SplitMix64 random(seed);
+    std::vector<std::pair<int, int>> edges;
+    if (num_users < 2 || edges_per_user < 1) {
+        return edges;
+    }
+    edges_per_user = std::min(edges_per_user, num_users - 1);
+    edges.reserve(static_cast<std::size_t>(num_users) * edges_per_user);
+
+    // Every endpoint of every edge, so a uniform pick is proportional to degree
+    std::vector<int> endpoints;
+    endpoints.reserve(edges.capacity() * 2);
+
+    // Start from a clique of edges_per_user + 1 users
+    for (int user = 0; user <= edges_per_user; user++) {
+        for (int other = 0; other < user; other++) {
+            edges.push_back(std::make_pair(user, other));
+            endpoints.push_back(user);
+            endpoints.push_back(other);
+        }
+    }
+
+    std::vector<int> targets;
+    for (int user = edges_per_user + 1; user < num_users; user++) {
+        targets.clear();
+        while (static_cast<int>(targets.size()) < edges_per_user) {
+            int target = endpoints[random.below(endpoints.size())];
+            if (std::find(targets.begin(), targets.end(), target) == targets.end()) {
+                targets.push_back(target);
+            }
+        }
+        for (int target : targets) {
+            edges.push_back(std::make_pair(user, target));
+            endpoints.push_back(user);
+            endpoints.push_back(target);
+        }
+    }
+    return edges;
+}
+
+
+/**
+ * @brief Generate a Watts-Strogatz small-world graph.
+ * @param num_users The number of users, numbered 0..num_users-1.
+ * @param neighbors_per_side The number of ring neighbors on each side of a user.
+ * @param rewire_probability The probability of rewiring each edge.
+ * @param seed The random seed.
+ * @return The edges as pairs of user IDs.
+ */
+std::vector<std::pair<int, int>> generateWattsStrogatz(int num_users, int neighbors_per_side, double rewire_probability,
+                                                       std::uint64_t seed) {
+    SplitMix64 random(seed);
+    std::vector<std::pair<int, int>> edges;
+    if (num_users < 2) {
+        return edges;
+    }
+    edges.reserve(static_cast<std::size_t>(num_users) * neighbors_per_side);
+
+    for (int user = 0; user < num_users; user++) {
+        for (int step = 1; step <= neighbors_per_side; step++) {
+            int target = (user + step) % num_users;
+            // Rewire the far end, avoiding self-connections
+            if (random.uniform() < rewire_probability) {
+                do {
+                    target = static_cast<int>(random.below(num_users));
+                } while (target == user);
+            }
+            edges.push_back(std::make_pair(user, target));
+        }
+    }
+    return edges;
+}
@@ -0,0 +1,96 @@
+#ifndef GRAPHGENERATORS_H
+#define GRAPHGENERATORS_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @class SplitMix64
+ * @brief A small, fast pseudo-random number generator.
+ *
+ * Unlike the distributions of <random>, whose output differs between standard libraries, the numbers drawn here
+ * only depend on the seed, so a generated graph is the same on every platform.
+ */
+class SplitMix64 {
+public:
+    /**
+     * @brief Construct a generator from a seed.
+     * @param seed The seed.
+     */
+    explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+    /**
+     * @brief Draw the next 64 random bits.
+     * @return The random bits.
+     */
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Draw a uniform integer below a bound.
+     * @param bound The exclusive upper bound, greater than 0.
+     * @return A number in [0, bound).
+     */
+    std::uint64_t below(std::uint64_t bound) {
+        return next() % bound;
+    }
+
+    /**
+     * @brief Draw a uniform real number.
+     * @return A number in [0, 1).
+     */
+    double uniform() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    std::uint64_t state;  // The generator state.
+};
+
+
+/**
+ * @brief Generate an R-MAT graph with the Graph500 parameters (a = 0.57, b = c = 0.19).
+ *
+ * Every edge picks a quadrant of the adjacency matrix recursively, which gives the skewed degrees and community
+ * structure of social graphs. User IDs are scrambled so that hubs are not clustered at small IDs. The edges may
+ * contain duplicates and self-connections.
+ * @param scale The graph has 2^scale users, numbered 0..2^scale-1.
+ * @param num_edges The number of edges to draw.
+ * @param seed The random seed.
+ * @return The edges as pairs of user IDs.
+ */
+std::vector<std::pair<int, int>> generateRmat(int scale, std::int64_t num_edges, std::uint64_t seed);
+
+/**
+ * @brief Generate a Barabasi-Albert preferential attachment graph.
+ *
+ * Users join one at a time and connect to edges_per_user distinct earlier users, chosen with probability
+ * proportional to their degree, which gives a power-law degree distribution.
+ * @param num_users The number of users, numbered 0..num_users-1.
+ * @param edges_per_user The number of connections of every joining user.
+ * @param seed The random seed.
+ * @return The edges as pairs of user IDs.
+ */
+std::vector<std::pair<int, int>> generateBarabasiAlbert(int num_users, int edges_per_user, std::uint64_t seed);
+
+/**
+ * @brief Generate a Watts-Strogatz small-world graph.
+ *
+ * Users start on a ring connected to their neighbors_per_side nearest users on each side, and every edge is
+ * rewired to a random user with the given probability, which gives high clustering and short paths.
+ * @param num_users The number of users, numbered 0..num_users-1.
+ * @param neighbors_per_side The number of ring neighbors on each side of a user.
+ * @param rewire_probability The probability of rewiring each edge.
+ * @param seed The random seed.
+ * @return The edges as pairs of user IDs.
+ */
+std::vector<std::pair<int, int>> generateWattsStrogatz(int num_users, int neighbors_per_side, double rewire_probability,
+                                                       std::uint64_t seed);
+
+#endif // GRAPHGENERATORS_H
@@ -0,0 +1,55 @@
+#include "LatencyRecorder.h"
+#include <algorithm>
+
+/**
+ * @brief Construct a Latency Recorder object.
+ * @param name The name of the measured operation, as reported.
+ */
+LatencyRecorder::LatencyRecorder(const std::string& name) : operation_name(name) {}
+
+
+/**
+ * @brief Record the latency of one operation.
+ * @param nanoseconds The latency in nanoseconds.
+ */
+void LatencyRecorder::record(std::int64_t nanoseconds) {
+    samples.push_back(nanoseconds);
+}
+
+
+/**
+ * @brief Write the operation count, total time, throughput and latency percentiles as a JSON object.
+ * @param out The stream to write to.
+ */
+void LatencyRecorder::writeJson(std::ostream& out) const {
+    std::vector<std::int64_t> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+
+    std::int64_t total = 0;
+    for (std::int64_t sample : sorted) {
+        total += sample;
+    }
+    double seconds = total / 1e9;
+
+    // Nearest-rank percentile of the sorted samples
+    auto percentile = [&sorted](double fraction) -> std::int64_t {
+        if (sorted.empty()) {
+            return 0;
+        }
+        std::size_t rank = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[rank];
+    };
+
+    out << "{\"name\": \"" << operation_name << "\""
+        << ", \"count\": " << sorted.size()
+        << ", \"seconds\": " << seconds
+        << ", \"ops_per_second\": " << (seconds > 0 ? sorted.size() / seconds : 0.0)
+        << ", \"latency_ns\": {"
+        << "\"min\": " << percentile(0.0)
+        << ", \"p50\": " << percentile(0.5)
+        << ", \"p90\": " << percentile(0.9)
+        << ", \"p99\": " << percentile(0.99)
+        << ", \"p999\": " << percentile(0.999)
+        << ", \"max\": " << percentile(1.0)
+        << "}}";
+}
@@ -0,0 +1,52 @@
+#ifndef LATENCYRECORDER_H
+#define LATENCYRECORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @class LatencyRecorder
+ * @brief Collects the latencies of one kind of operation and summarizes them.
+ */
+class LatencyRecorder {
+public:
+    /**
+     * @brief Construct a Latency Recorder object.
+     * @param name The name of the measured operation, as reported.
+     */
+    explicit LatencyRecorder(const std::string& name);
+
+    /**
+     * @brief Run an operation once and record how long it took.
+     * @param operation The operation to run.
+     */
+    template <typename Operation>
+    void measure(Operation operation) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        operation();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    /**
+     * @brief Record the latency of one operation.
+     * @param nanoseconds The latency in nanoseconds.
+     */
+    void record(std::int64_t nanoseconds);
+
+    /**
+     * @brief Write the operation count, total time, throughput and latency percentiles as a JSON object.
+     * @param out The stream to write to.
+     */
+    void writeJson(std::ostream& out) const;
+
+private:
+    std::string operation_name;  // The name of the measured operation.
+    std::vector<std::int64_t> samples;  // The latency of every recorded operation, in nanoseconds.
+};
+
+#endif // LATENCYRECORDER_H
@@ -0,0 +1,367 @@
+#include "CompressedNetwork.h"
+#include "GraphGenerators.h"
+#include "LatencyRecorder.h"
+#include "PeakMemory.h"
+#include "ShardedNetwork.h"
+#include "SocialNetwork.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    /**
+     * @struct BenchmarkOptions
+     * @brief The settings of a benchmark run, read from the command line.
+     */
+    struct BenchmarkOptions {
+        std::string graph = "rmat";  // The generator: rmat, ba or ws.
+        int users = 1 << 16;  // The number of users (rounded up to a power of two for rmat).
+        int degree = 16;  // The average number of connections per user.
+        double rewire = 0.1;  // The rewiring probability of ws.
+        std::uint64_t seed = 42;  // The seed of the generator and of the query workload.
+        int queries = 1000;  // The number of point queries and removeUser calls.
+        int traversals = 20;  // The number of recommendConnections, BFS, DFS and numberOfConnections calls.
+        unsigned threads = 0;  // The number of threads of the network, 0 for the number of hardware threads.
+        int shards = 0;  // The number of shards of the sharded network, 0 to skip it.
+        std::string shard_transport = "threads";  // How the shards run: threads, or processes.
+        std::string output;  // The file to write the report to, standard output if empty.
+        std::string journal;  // The journal file changes are recorded in, none if empty.
+    };
+
+    /**
+     * @brief Print the command line usage.
+     */
+    void printUsage() {
+        std::cerr << "Usage: SocialNetworkBenchmark [options]\n"
+                  << "  --graph rmat|ba|ws   graph generator (default rmat)\n"
+                  << "  --users N            number of users (default 65536)\n"
+                  << "  --degree D           average connections per user (default 16)\n"
+                  << "  --rewire P           Watts-Strogatz rewiring probability (default 0.1)\n"
+                  << "  --seed S             random seed (default 42)\n"
+                  << "  --queries Q          point queries and removals per operation (default 1000)\n"
+                  << "  --traversals T       recommendation, BFS, DFS and count calls per operation (default 20)\n"
+                  << "  --threads N          worker threads, 0 for all hardware threads (default 0)\n"
+                  << "  --shards N           also time a network sharded N ways, 0 to skip (default 0)\n"
+                  << "  --shard-transport threads|processes\n"
+                  << "                       run the shards on threads or in worker processes (default threads)\n"
+                  << "  --output FILE        write the JSON report to FILE instead of standard output\n"
+                  << "  --journal FILE       record every change in the journal FILE and time its replay\n";
+    }
+
+    /**
+     * @brief Read the options from the command line.
+     * @param argc The number of arguments.
+     * @param argv The arguments.
+     * @param options Receives the options.
+     * @return true if the command line is valid, false otherwise.
+     */
+    bool parseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+        for (int position = 1; position < argc; position++) {
+            const char* name = argv[position];
+            if (position + 1 >= argc) {
+                return false;
+            }
+            const char* value = argv[++position];
+            if (std::strcmp(name, "--graph") == 0) {
+                options.graph = value;
+            }
+            else if (std::strcmp(name, "--users") == 0) {
+                options.users = std::atoi(value);
+            }
+            else if (std::strcmp(name, "--degree") == 0) {
+                options.degree = std::atoi(value);
+            }
+            else if (std::strcmp(name, "--rewire") == 0) {
+                options.rewire = std::atof(value);
+            }
+            else if (std::strcmp(name, "--seed") == 0) {
+                options.seed = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(name, "--queries") == 0) {
+                options.queries = std::atoi(value);
+            }
+            else if (std::strcmp(name, "--traversals") == 0) {
+                options.traversals = std::atoi(value);
+            }
+            else if (std::strcmp(name, "--threads") == 0) {
+                options.threads = static_cast<unsigned>(std::atoi(value));
+            }
+            else if (std::strcmp(name, "--shards") == 0) {
+                options.shards = std::atoi(value);
+            }
+            else if (std::strcmp(name, "--shard-transport") == 0) {
+                options.shard_transport = value;
+            }
+            else if (std::strcmp(name, "--output") == 0) {
+                options.output = value;
+            }
+            else if (std::strcmp(name, "--journal") == 0) {
+                options.journal = value;
+            }
+            else {
+                return false;
+            }
+        }
+        return options.users > 1 && options.degree > 0 && options.queries >= 0 && options.traversals >= 0 && options.shards >= 0
+            && (options.graph == "rmat" || options.graph == "ba" || options.graph == "ws")
+            && (options.shard_transport == "threads" || options.shard_transport == "processes");
+    }
+
+    /**
+     * @brief Generate the connections of the benchmark graph.
+     * @param options The benchmark options.
+     * @param users Receives the number of users of the graph.
+     * @return The generated connections.
+     */
+    std::vector<std::pair<int, int>> generateGraph(const BenchmarkOptions& options, int& users) {
+        if (options.graph == "rmat") {
+            int scale = 1;
+            while ((1 << scale) < options.users) {
+                scale++;
+            }
+            users = 1 << scale;
+            return generateRmat(scale, static_cast<std::int64_t>(users) * options.degree / 2, options.seed);
+        }
+        users = options.users;
+        if (options.graph == "ba") {
+            return generateBarabasiAlbert(users, (options.degree + 1) / 2, options.seed);
+        }
+        return generateWattsStrogatz(users, (options.degree + 1) / 2, options.rewire, options.seed);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    // Worker processes are forked first, before the graph is generated or the journal starts the thread pool
+    std::unique_ptr<ShardedNetwork> sharded;
+    if (options.shards > 0 && options.shard_transport == "processes") {
+        std::unique_ptr<ShardTransport> transport = ShardTransport::processes(options.shards);
+        if (!transport) {
+            std::cerr << "Cannot start the shard worker processes" << std::endl;
+            return 1;
+        }
+        sharded.reset(new ShardedNetwork(std::move(transport)));
+    }
+    else if (options.shards > 0) {
+        sharded.reset(new ShardedNetwork(options.shards, options.threads));
+    }
+
+    int users = 0;
+    std::vector<std::pair<int, int>> connections = generateGraph(options, users);
+
+    SocialNetwork network;
+    network.setNumberOfThreads(options.threads);
+    SplitMix64 random(options.seed ^ 0x5DEECE66DULL);
+    std::vector<LatencyRecorder> recorders;
+
+    // Start from an empty journal, so the changes below are all it holds
+    const std::string journalSnapshot = options.journal + ".snapshot";
+    if (!options.journal.empty()) {
+        std::remove(options.journal.c_str());
+        std::remove(journalSnapshot.c_str());
+        if (network.openJournal(options.journal, journalSnapshot) != NetworkStatus::Ok) {
+            std::cerr << "Cannot write " << options.journal << std::endl;
+            return 1;
+        }
+    }
+
+    // Build the network one call at a time
+    recorders.push_back(LatencyRecorder("addUser"));
+    for (int user = 0; user < users; user++) {
+        recorders.back().measure([&network, user]() { network.addUser(user); });
+    }
+    recorders.push_back(LatencyRecorder("addConnection"));
+    for (const std::pair<int, int>& connection : connections) {
+        recorders.back().measure([&network, &connection]() { network.addConnection(connection.first, connection.second); });
+    }
+
+    // The sharded network gets the same connections in one bulk load
+    if (sharded) {
+        std::vector<std::pair<UserId, UserId>> pairs(connections.begin(), connections.end());
+        recorders.push_back(LatencyRecorder("shardedLoadConnections"));
+        recorders.back().measure([&sharded, &pairs]() { sharded->loadConnections(pairs); });
+    }
+    std::vector<std::pair<int, int>>().swap(connections);
+    long long numConnections = network.numberOfConnections();
+
+    // The first query after a change rebuilds the snapshot, time that on its own
+    recorders.push_back(LatencyRecorder("refreshSnapshot"));
+    recorders.back().measure([&network]() { network.refreshSnapshot(); });
+
+    recorders.push_back(LatencyRecorder("isConnected"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, user1, user2]() { network.isConnected(user1, user2); });
+    }
+    recorders.push_back(LatencyRecorder("sameComponent"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, user1, user2]() { network.sameComponent(user1, user2); });
+    }
+    std::vector<UserId> mutual;
+    recorders.push_back(LatencyRecorder("mutualConnections"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, &mutual, user1, user2]() { network.mutualConnections(user1, user2, mutual); });
+    }
+    std::vector<Recommendation> recommendations;
+    recorders.push_back(LatencyRecorder("recommendConnections"));
+    for (int query = 0; query < options.traversals; query++) {
+        int user = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, &recommendations, user]() { network.recommendConnections(user, 10, recommendations); });
+    }
+    recorders.push_back(LatencyRecorder("findShortestPath"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, user1, user2]() { network.findShortestPath(user1, user2); });
+    }
+
+    recorders.push_back(LatencyRecorder("buildDistanceOracle"));
+    recorders.back().measure([&network]() { network.buildDistanceOracle(); });
+    // Accept any bounds, so only pairs the landmarks do not cover fall back to a search
+    DistanceEstimate estimate;
+    recorders.push_back(LatencyRecorder("estimateDistance"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, &estimate, user1, user2]() { network.estimateDistance(user1, user2, estimate, std::numeric_limits<int>::max()); });
+    }
+
+    std::vector<UserId> order;
+    recorders.push_back(LatencyRecorder("BFS"));
+    for (int traversal = 0; traversal < options.traversals; traversal++) {
+        int user = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, &order, user]() { network.BFS(user, order); });
+    }
+    recorders.push_back(LatencyRecorder("DFS"));
+    for (int traversal = 0; traversal < options.traversals; traversal++) {
+        int user = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, &order, user]() { network.DFS(user, order); });
+    }
+    recorders.push_back(LatencyRecorder("numberOfConnections"));
+    for (int traversal = 0; traversal < options.traversals; traversal++) {
+        recorders.back().measure([&network]() { network.numberOfConnections(); });
+    }
+
+    if (sharded) {
+        recorders.push_back(LatencyRecorder("shardedFindShortestPath"));
+        for (int query = 0; query < options.queries; query++) {
+            int user1 = static_cast<int>(random.below(users));
+            int user2 = static_cast<int>(random.below(users));
+            recorders.back().measure([&sharded, user1, user2]() { sharded->findShortestPath(user1, user2); });
+        }
+        recorders.push_back(LatencyRecorder("shardedBFS"));
+        for (int traversal = 0; traversal < options.traversals; traversal++) {
+            int user = static_cast<int>(random.below(users));
+            recorders.back().measure([&sharded, &order, user]() { sharded->BFS(user, order); });
+        }
+    }
+
+    // The same queries on a compressed copy of the snapshot
+    std::unique_ptr<CompressedNetwork> compressed;
+    recorders.push_back(LatencyRecorder("compressNetwork"));
+    recorders.back().measure([&network, &compressed]() { compressed.reset(new CompressedNetwork(*network.snapshot())); });
+    const std::size_t compressedBytes = compressed->memoryUsage();
+    const std::size_t snapshotBytes = users * (sizeof(UserId) + sizeof(std::int64_t)) + numConnections * 2 * sizeof(int);
+    recorders.push_back(LatencyRecorder("compressedIsConnected"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&compressed, user1, user2]() { compressed->isConnected(user1, user2); });
+    }
+    recorders.push_back(LatencyRecorder("compressedFindShortestPath"));
+    for (int query = 0; query < options.queries; query++) {
+        int user1 = static_cast<int>(random.below(users));
+        int user2 = static_cast<int>(random.below(users));
+        recorders.back().measure([&compressed, user1, user2]() { compressed->findShortestPath(user1, user2); });
+    }
+    recorders.push_back(LatencyRecorder("compressedBFS"));
+    for (int traversal = 0; traversal < options.traversals; traversal++) {
+        int user = static_cast<int>(random.below(users));
+        recorders.back().measure([&compressed, &order, user]() { compressed->BFS(user, order); });
+    }
+    recorders.push_back(LatencyRecorder("compressedDFS"));
+    for (int traversal = 0; traversal < options.traversals; traversal++) {
+        int user = static_cast<int>(random.below(users));
+        recorders.back().measure([&compressed, &order, user]() { compressed->DFS(user, order); });
+    }
+    compressed.reset();
+
+    // Exact betweenness is quadratic, so only the sampled estimate is timed
+    BetweennessOptions sampled;
+    sampled.epsilon = 0.02;
+    recorders.push_back(LatencyRecorder("betweenness"));
+    recorders.back().measure([&network, &sampled]() { network.betweenness(sampled); });
+
+    recorders.push_back(LatencyRecorder("neighborhoodFunction"));
+    recorders.back().measure([&network]() { network.neighborhoodFunction(); });
+
+    // A full PageRank, then a warm refresh after a batch of new connections
+    PageRankOptions coldStart;
+    coldStart.warm_start = false;
+    recorders.push_back(LatencyRecorder("pageRank"));
+    recorders.back().measure([&network, &coldStart]() { network.pageRank(coldStart); });
+    for (int query = 0; query < options.queries; query++) {
+        network.addConnection(static_cast<int>(random.below(users)), static_cast<int>(random.below(users)));
+    }
+    network.refreshSnapshot();
+    recorders.push_back(LatencyRecorder("pageRankRefresh"));
+    recorders.back().measure([&network]() { network.pageRank(); });
+
+    // Removals last, they change the network the other operations measure
+    recorders.push_back(LatencyRecorder("removeUser"));
+    for (int query = 0; query < options.queries; query++) {
+        int user = static_cast<int>(random.below(users));
+        recorders.back().measure([&network, user]() { network.removeUser(user); });
+    }
+
+    // Restore a second network from the snapshot and journal the first one left behind
+    if (!options.journal.empty()) {
+        network.closeJournal();
+        SocialNetwork restored;
+        restored.setNumberOfThreads(options.threads);
+        recorders.push_back(LatencyRecorder("openJournal"));
+        recorders.back().measure([&restored, &options, &journalSnapshot]() { restored.openJournal(options.journal, journalSnapshot); });
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    out << "{\n  \"graph\": {\"generator\": \"" << options.graph << "\", \"users\": " << users
+        << ", \"degree\": " << options.degree << ", \"seed\": " << options.seed
+        << ", \"connections\": " << numConnections << "},\n"
+        << "  \"snapshot_bytes\": " << snapshotBytes << ",\n"
+        << "  \"compressed_bytes\": " << compressedBytes << ",\n"
+        << "  \"threads\": " << options.threads << ",\n"
+        << "  \"operations\": [\n";
+    for (std::size_t position = 0; position < recorders.size(); position++) {
+        out << "    ";
+        recorders[position].writeJson(out);
+        out << (position + 1 < recorders.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"peak_rss_bytes\": " << peakResidentSetBytes() << "\n}" << std::endl;
+    return 0;
+}
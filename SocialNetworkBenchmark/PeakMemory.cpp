@@ -0,0 +1,35 @@
+#include "PeakMemory.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/**
+ * @brief Get the peak resident set size of the process so far.
+ * @return The largest amount of physical memory the process has used, in bytes, or 0 if it is unknown.
+ */
+std::size_t peakResidentSetBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    // macOS reports bytes
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
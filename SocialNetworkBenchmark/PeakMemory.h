@@ -0,0 +1,13 @@
+#ifndef PEAKMEMORY_H
+#define PEAKMEMORY_H
+
+#include <cstddef>
+
+
+/**
+ * @brief Get the peak resident set size of the process so far.
+ * @return The largest amount of physical memory the process has used, in bytes, or 0 if it is unknown.
+ */
+std::size_t peakResidentSetBytes();
+
+#endif // PEAKMEMORY_H